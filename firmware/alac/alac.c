@@ -0,0 +1,399 @@
+/*
+Integer Apple Lossless (ALAC) decoder for openHiFi
+
+Copyright (C) 2011 teho Labs/B. A. Bryce
+
+Adaptive Golomb residues, the adaptive FIR predictor and stereo
+decorrelation. Channel layouts other than mono and stereo are rejected.
+
+Please see project readme for more details on licenses
+*/
+
+#include <string.h>
+#include "alac.h"
+
+/* Element types of a frame */
+#define ALAC_ELEMENT_SCE 0
+#define ALAC_ELEMENT_CPE 1
+#define ALAC_ELEMENT_END 7
+
+/* Unary prefixes longer than this are followed by the value in full */
+#define ALAC_RICE_THRESHOLD 8
+
+typedef struct ALACBits {
+    const uint8_t *buffer;
+    unsigned long length;           /* bytes */
+    unsigned long position;         /* bits */
+} ALACBits;
+
+static inline int32_t sign_extend(uint32_t x, int bits)
+{
+    return (int32_t)(x << (32 - bits)) >> (32 - bits);
+}
+
+/* Bit reader, ALAC packs MSB first */
+
+static inline uint32_t bits_peek(const ALACBits *b)
+{
+    unsigned long byte = b->position >> 3;
+    int shift = b->position & 7;
+    const uint8_t *p = b->buffer + byte;
+    uint32_t word;
+    uint64_t wide;
+    int i;
+
+    if (byte + 5 <= b->length) {
+        word = ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+        if (shift)
+            word = (word << shift) | (p[4] >> (8 - shift));
+        return word;
+    }
+
+    /* Near the end of the frame, missing bits read as zero */
+    wide = 0;
+    for (i = 0; i < 5 && byte + i < b->length; i++)
+        wide |= (uint64_t)p[i] << (32 - 8 * i);
+    return (uint32_t)(wide >> (8 - shift));
+}
+
+static inline uint32_t bits_read(ALACBits *b, int count)
+{
+    uint32_t value;
+
+    if (count == 0)
+        return 0;
+    value = bits_peek(b) >> (32 - count);
+    b->position += count;
+    return value;
+}
+
+static inline int32_t bits_read_signed(ALACBits *b, int count)
+{
+    return sign_extend(bits_read(b, count), count);
+}
+
+static inline int bits_overrun(const ALACBits *b)
+{
+    return b->position > b->length * 8;
+}
+
+static inline int sign_only(int32_t x)
+{
+    return (x > 0) - (x < 0);
+}
+
+static inline int log2_floor(uint32_t x)
+{
+    return x ? 31 - __builtin_clz(x) : 0;
+}
+
+/* Adaptive Golomb codes */
+
+static inline uint32_t decode_scalar(ALACBits *b, int k, int bps)
+{
+    uint32_t word = bits_peek(b);
+    uint32_t x, extra;
+
+    /* Leading ones, at most ALAC_RICE_THRESHOLD + 1 */
+    x = (~word) ? __builtin_clz(~word) : 32;
+    if (x > ALAC_RICE_THRESHOLD) {
+        b->position += ALAC_RICE_THRESHOLD + 1;
+        return bits_read(b, bps);
+    }
+    b->position += x + 1;
+
+    if (k != 1) {
+        /* x * (2^k - 1) plus k bits, where 0 and 1 both mean the k-1 bit value 0 */
+        extra = bits_peek(b) >> (32 - k);
+        x = (x << k) - x;
+        if (extra > 1) {
+            x += extra - 1;
+            b->position += k;
+        } else
+            b->position += k - 1;
+    }
+    return x;
+}
+
+static int decode_residues(ALACContext *a, ALACBits *b, int32_t *output, int frames,
+                           int bps, int history_mult)
+{
+    uint32_t history = a->mb;
+    uint32_t x;
+    int sign_modifier = 0;
+    int i, k, block;
+
+    for (i = 0; i < frames; i++) {
+        k = log2_floor((history >> 9) + 3);
+        if (k > a->kb)
+            k = a->kb;
+        x = decode_scalar(b, k, bps) + sign_modifier;
+        sign_modifier = 0;
+        output[i] = (x >> 1) ^ -(int32_t)(x & 1);
+
+        if (x > 0xffff)
+            history = 0xffff;
+        else
+            history += x * history_mult - ((history * history_mult) >> 9);
+
+        /* Low history starts a run of zeros */
+        if (history < 128 && i + 1 < frames) {
+            k = 7 - log2_floor(history) + ((history + 16) >> 6);
+            if (k > a->kb)
+                k = a->kb;
+            block = decode_scalar(b, k, 16);
+
+            if (block > 0) {
+                if (block >= frames - i)
+                    return -1;
+                memset(&output[i + 1], 0, block * sizeof(int32_t));
+                i += block;
+            }
+            if (block <= 0xffff)
+                sign_modifier = 1;
+            history = 0;
+        }
+    }
+
+    return bits_overrun(b) ? -1 : 0;
+}
+
+/* Adaptive FIR predictor, in place on the residues. Order 31 is a plain
+   first order difference, used by prediction type 15 before the real filter */
+static void predict(int32_t *buffer, int frames, int bps, int16_t *coefs, int order, int quant)
+{
+    int32_t *history;
+    int32_t d, value, error;
+    uint32_t sum;
+    int i, j, sign;
+
+    if (frames <= 1 || order == 0)
+        return;
+
+    if (order == 31) {
+        for (i = 1; i < frames; i++)
+            buffer[i] = sign_extend((uint32_t)buffer[i - 1] + buffer[i], bps);
+        return;
+    }
+
+    for (i = 1; i <= order && i < frames; i++)
+        buffer[i] = sign_extend((uint32_t)buffer[i - 1] + buffer[i], bps);
+
+    /* coefs[order - 1] goes with the newest sample, sums wrap at 32 bits like the reference */
+    for (; i < frames; i++) {
+        history = &buffer[i - order];
+        d = history[-1];
+        error = buffer[i];
+
+        sum = 0;
+        for (j = 0; j < order; j++)
+            sum += ((uint32_t)history[j] - d) * (uint32_t)coefs[j];
+        value = (int32_t)(sum + (1u << (quant - 1))) >> quant;
+        buffer[i] = sign_extend((uint32_t)value + d + error, bps);
+
+        /* Step the coefficients towards a smaller error, oldest sample first */
+        sign = sign_only(error);
+        if (sign > 0) {
+            for (j = 0; j < order && error > 0; j++) {
+                value = d - history[j];
+                sign = sign_only(value);
+                coefs[j] -= sign;
+                error -= ((value * sign) >> quant) * (j + 1);
+            }
+        } else if (sign < 0) {
+            for (j = 0; j < order && error < 0; j++) {
+                value = d - history[j];
+                sign = -sign_only(value);
+                coefs[j] -= sign;
+                error -= ((value * sign) >> quant) * (j + 1);
+            }
+        }
+    }
+}
+
+/* Frame */
+
+int alac_init(ALACContext *a, const uint8_t *cookie, unsigned long length, void *memory, unsigned long size)
+{
+    int ch;
+
+    if (length < ALAC_COOKIE_SIZE)
+        return -1;
+
+    a->frame_length = ((uint32_t)cookie[0] << 24) | (cookie[1] << 16) | (cookie[2] << 8) | cookie[3];
+    /* cookie[4] is the compatible version, 0 */
+    a->bit_depth = cookie[5];
+    a->pb = cookie[6];
+    a->mb = cookie[7];
+    a->kb = cookie[8];
+    a->channels = cookie[9];
+    /* cookie[10..11] is the maximum run, unused */
+    a->max_frame_bytes = ((uint32_t)cookie[12] << 24) | (cookie[13] << 16) | (cookie[14] << 8) | cookie[15];
+    a->avg_bitrate = ((uint32_t)cookie[16] << 24) | (cookie[17] << 16) | (cookie[18] << 8) | cookie[19];
+    a->samplerate = ((uint32_t)cookie[20] << 24) | (cookie[21] << 16) | (cookie[22] << 8) | cookie[23];
+
+    if (cookie[4] != 0 || a->frame_length == 0 || a->frame_length > ALAC_MAX_FRAME_LENGTH
+        || a->channels < 1 || a->channels > ALAC_MAX_CHANNELS
+        || a->bit_depth < 16 || a->bit_depth > 32 || a->kb < 1 || a->kb > 31)
+        return -1;
+
+    if (size < ALAC_SCRATCH_SIZE(a->frame_length))
+        return -1;
+
+    for (ch = 0; ch < ALAC_MAX_CHANNELS; ch++)
+        a->output[ch] = (int32_t *)memory + ch * a->frame_length;
+    a->shift_buffer = (uint16_t *)(a->output[0] + ALAC_MAX_CHANNELS * a->frame_length);
+
+    a->output_frames = 0;
+    a->output_index = 0;
+    return 0;
+}
+
+static int decode_element(ALACContext *a, ALACBits *b, int first, int channels, int *frames)
+{
+    int16_t coefs[ALAC_MAX_CHANNELS][32];
+    int type[ALAC_MAX_CHANNELS], quant[ALAC_MAX_CHANNELS];
+    int history_mult[ALAC_MAX_CHANNELS], order[ALAC_MAX_CHANNELS];
+    int has_size, shift_bits, compressed, bps;
+    int mix_shift, mix_weight;
+    int32_t *left, *right, l, r;
+    int i, ch, count;
+
+    /* Element instance tag and 12 unused bits */
+    b->position += 16;
+    has_size = bits_read(b, 1);
+    shift_bits = bits_read(b, 2) * 8;
+    compressed = !bits_read(b, 1);
+
+    count = a->frame_length;
+    if (has_size)
+        count = bits_read(b, 32);
+    if (count <= 0 || count > (int)a->frame_length || (*frames && count != *frames))
+        return -1;
+    *frames = count;
+
+    if (!compressed) {
+        for (i = 0; i < count; i++)
+            for (ch = 0; ch < channels; ch++)
+                a->output[first + ch][i] = bits_read_signed(b, a->bit_depth);
+        return bits_overrun(b) ? -1 : 0;
+    }
+
+    /* Wider samples send their low bytes uncompressed, stereo differences need one bit more */
+    bps = a->bit_depth - shift_bits + channels - 1;
+    if (bps < 1 || bps > 32)
+        return -1;
+
+    mix_shift = bits_read(b, 8);
+    mix_weight = bits_read(b, 8);
+
+    for (ch = 0; ch < channels; ch++) {
+        type[ch] = bits_read(b, 4);
+        quant[ch] = bits_read(b, 4);
+        history_mult[ch] = bits_read(b, 3) * a->pb / 4;
+        order[ch] = bits_read(b, 5);
+
+        if ((type[ch] != 0 && type[ch] != 15) || quant[ch] == 0)
+            return -1;
+
+        for (i = order[ch] - 1; i >= 0; i--)
+            coefs[ch][i] = bits_read_signed(b, 16);
+    }
+
+    if (shift_bits) {
+        for (i = 0; i < count; i++)
+            for (ch = 0; ch < channels; ch++)
+                a->shift_buffer[i * ALAC_MAX_CHANNELS + first + ch] = bits_read(b, shift_bits);
+    }
+
+    for (ch = 0; ch < channels; ch++) {
+        if (decode_residues(a, b, a->output[first + ch], count, bps, history_mult[ch]) < 0)
+            return -1;
+        if (type[ch] == 15)
+            predict(a->output[first + ch], count, bps, NULL, 31, 0);
+        predict(a->output[first + ch], count, bps, coefs[ch], order[ch], quant[ch]);
+    }
+
+    if (channels == 2 && mix_weight) {
+        left = a->output[first];
+        right = a->output[first + 1];
+        for (i = 0; i < count; i++) {
+            r = left[i] - ((right[i] * mix_weight) >> mix_shift);
+            l = right[i] + r;
+            left[i] = l;
+            right[i] = r;
+        }
+    }
+
+    if (shift_bits) {
+        for (ch = 0; ch < channels; ch++)
+            for (i = 0; i < count; i++)
+                a->output[first + ch][i] = ((uint32_t)a->output[first + ch][i] << shift_bits)
+                                           | a->shift_buffer[i * ALAC_MAX_CHANNELS + first + ch];
+    }
+
+    return 0;
+}
+
+/* Decodes one frame, returns its number of frames (samples per channel) or -1 */
+int alac_decode_frame(ALACContext *a, const uint8_t *frame, unsigned long length)
+{
+    ALACBits b;
+    int element, channels;
+    int channel = 0;
+    int frames = 0;
+
+    b.buffer = frame;
+    b.length = length;
+    b.position = 0;
+
+    a->output_frames = 0;
+    a->output_index = 0;
+
+    while (!bits_overrun(&b)) {
+        element = bits_read(&b, 3);
+        if (element == ALAC_ELEMENT_END)
+            break;
+        if (element != ALAC_ELEMENT_SCE && element != ALAC_ELEMENT_CPE)
+            return -1;
+
+        channels = (element == ALAC_ELEMENT_CPE) ? 2 : 1;
+        if (channel + channels > a->channels)
+            return -1;
+        if (decode_element(a, &b, channel, channels, &frames) < 0)
+            return -1;
+        channel += channels;
+    }
+
+    if (channel != a->channels)
+        return -1;
+
+    a->output_frames = frames;
+    return frames;
+}
+
+static inline uint16_t to_sample(int32_t x, int bit_depth)
+{
+    return (uint16_t)(x >> (bit_depth - 16));
+}
+
+/* Copies up to frames of the last frame into 16-bit stereo pairs,
+   returns the number written, 0 when the frame is used up */
+int alac_read_pcm(ALACContext *a, uint16_t *destination, int frames)
+{
+    int count = a->output_frames - a->output_index;
+    int32_t *left = a->output[0] + a->output_index;
+    int32_t *right = a->output[a->channels - 1] + a->output_index;
+    int i;
+
+    if (frames > count)
+        frames = count;
+
+    for (i = 0; i < frames; i++) {
+        destination[2 * i] = to_sample(left[i], a->bit_depth);
+        destination[2 * i + 1] = to_sample(right[i], a->bit_depth);
+    }
+
+    a->output_index += frames;
+    return frames;
+}
@@ -0,0 +1,49 @@
+/*
+Integer Apple Lossless (ALAC) decoder for openHiFi
+
+Copyright (C) 2011 teho Labs/B. A. Bryce
+
+Decodes the frames of one ALAC track, the MP4 container is read by openhifi.c.
+Written from the Apple ALAC reference decoder (Apache License 2.0).
+
+Please see project readme for more details on licenses
+*/
+
+#ifndef _ALAC_DECODER_H
+#define _ALAC_DECODER_H
+
+#include <inttypes.h>
+
+#define ALAC_MAX_CHANNELS 2		/* Maximum supported channels */
+#define ALAC_MAX_FRAME_LENGTH 4096	/* Largest frame length (samples per channel), iTunes uses 4096 */
+#define ALAC_MAX_PACKET 65536		/* Maxsize in bytes of one frame */
+#define ALAC_COOKIE_SIZE 24		/* ALACSpecificConfig in the 'alac' atom of the sample description */
+
+/* Scratch memory alac_init needs for a frame length */
+#define ALAC_SCRATCH_SIZE(n) ((n) * ALAC_MAX_CHANNELS * (sizeof(int32_t) + sizeof(uint16_t)))
+
+typedef struct ALACContext {
+    /* ALACSpecificConfig */
+    unsigned long frame_length;
+    int bit_depth;
+    int pb;                         /* Rice history multiplier */
+    int mb;                         /* Initial rice history */
+    int kb;                         /* Rice parameter limit */
+    int channels;
+    unsigned long max_frame_bytes;
+    unsigned long avg_bitrate;
+    unsigned long samplerate;
+
+    /* Decode state */
+    int32_t *output[ALAC_MAX_CHANNELS];     /* Samples of the last frame, bit_depth bits */
+    uint16_t *shift_buffer;                 /* Low bits sent uncompressed after the predictor headers */
+    int output_frames;
+    int output_index;
+} ALACContext;
+
+/* cookie is the ALACSpecificConfig, memory holds ALAC_SCRATCH_SIZE(frame_length) bytes (SRAM) */
+int alac_init(ALACContext *a, const uint8_t *cookie, unsigned long length, void *memory, unsigned long size);
+int alac_decode_frame(ALACContext *a, const uint8_t *frame, unsigned long length);
+int alac_read_pcm(ALACContext *a, uint16_t *destination, int frames);
+
+#endif
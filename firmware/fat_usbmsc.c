@@ -16,12 +16,273 @@
 #include "usblib/host/usbhmsc.h"
 #include "fatfs/src/diskio.h"
 #include "fatfs/src/ff.h"
+#include "fat_usbmsc.h"
+#include <string.h>
 
 extern unsigned long g_MSCdriverInstance;
 
 static volatile
 DSTATUS USBStat = STA_NOINIT;    /* Disk status */
 
+
+
+/*-----------------------------------------------------------------------*/
+/* SDRAM sector cache                                                    */
+/*-----------------------------------------------------------------------*/
+/* Sectors going through disk_read/disk_write are kept in the block      */
+/* given to disk_cache_init, so directory walks, FAT lookups and index   */
+/* reads stop going out on the USB bus. Sectors read into a buffer       */
+/* registered as DISK_CACHE_PIN (the FatFs window) live on their own LRU */
+/* list that data reads can not evict. Writes go through to the drive so */
+/* the cache never holds anything the drive does not.                    */
+
+#define CACHE_NIL   0xFFFF      /* End of a list or hash chain */
+#define CACHE_FREE  2           /* List of unused entries (after DISK_CACHE_DATA/PIN) */
+
+typedef struct {
+    DWORD sector;
+    WORD prev, next;            /* LRU list links, prev is the more recently used */
+    WORD chain;                 /* Next entry in the same hash bucket */
+    BYTE list;                  /* DISK_CACHE_DATA, DISK_CACHE_PIN or CACHE_FREE */
+    BYTE pad;
+} CACHE_ENTRY;
+
+typedef struct {
+    WORD head, tail;            /* Most and least recently used entry */
+    WORD count;
+} CACHE_LIST;
+
+static BYTE* CacheData;         /* CacheSectors * _MAX_SS bytes of sector data */
+static CACHE_ENTRY* CacheEntry;
+static WORD* CacheHash;         /* First entry of each hash bucket */
+static WORD CacheHashMask;
+static WORD CacheSectors;       /* 0 when the cache is not set up */
+static WORD CachePinMax;
+static CACHE_LIST CacheList[3];
+
+static const BYTE* CacheBuffer[DISK_CACHE_BUFFERS];
+static DWORD CacheBufferSize[DISK_CACHE_BUFFERS];
+static BYTE CachePolicy[DISK_CACHE_BUFFERS];
+
+static DISK_CACHE_STATS CacheStats;
+
+
+static
+BYTE cache_policy (         /* Policy of the registered buffer that buff points into */
+    const BYTE* buff)
+{
+    BYTE i;
+
+    for (i = 0; i < DISK_CACHE_BUFFERS; i++) {
+        if (CacheBuffer[i] && buff >= CacheBuffer[i] && buff < CacheBuffer[i] + CacheBufferSize[i]) {
+            if (CachePolicy[i] == DISK_CACHE_PIN && !CachePinMax) break;
+            return CachePolicy[i];
+        }
+    }
+    return DISK_CACHE_DATA;
+}
+
+
+static
+void cache_unlink (
+    WORD e)
+{
+    CACHE_ENTRY* entry = &CacheEntry[e];
+    CACHE_LIST* list = &CacheList[entry->list];
+
+    if (entry->prev != CACHE_NIL) CacheEntry[entry->prev].next = entry->next;
+    else list->head = entry->next;
+    if (entry->next != CACHE_NIL) CacheEntry[entry->next].prev = entry->prev;
+    else list->tail = entry->prev;
+    list->count--;
+}
+
+
+static
+void cache_push (           /* Link an entry as the most recently used of a list */
+    WORD e,
+    BYTE l)
+{
+    CACHE_ENTRY* entry = &CacheEntry[e];
+    CACHE_LIST* list = &CacheList[l];
+
+    entry->list = l;
+    entry->prev = CACHE_NIL;
+    entry->next = list->head;
+    if (list->head != CACHE_NIL) CacheEntry[list->head].prev = e;
+    else list->tail = e;
+    list->head = e;
+    list->count++;
+}
+
+
+static
+WORD cache_find (
+    DWORD sector)
+{
+    WORD e = CacheHash[sector & CacheHashMask];
+
+    while (e != CACHE_NIL && CacheEntry[e].sector != sector)
+        e = CacheEntry[e].chain;
+    return e;
+}
+
+
+static
+void cache_drop (           /* Remove an entry from its hash chain and free it */
+    WORD e)
+{
+    WORD* link = &CacheHash[CacheEntry[e].sector & CacheHashMask];
+
+    while (*link != e) link = &CacheEntry[*link].chain;
+    *link = CacheEntry[e].chain;
+    cache_unlink(e);
+    cache_push(e, CACHE_FREE);
+}
+
+
+static
+void cache_touch (          /* Make an entry the most recently used, pinning it if asked */
+    WORD e,
+    BYTE l)
+{
+    if (CacheEntry[e].list == DISK_CACHE_PIN) l = DISK_CACHE_PIN;
+    cache_unlink(e);
+
+    /* A full pinned list hands its oldest sector back to the data list */
+    if (l == DISK_CACHE_PIN && CacheEntry[e].list != DISK_CACHE_PIN
+        && CacheList[DISK_CACHE_PIN].count >= CachePinMax) {
+        WORD old = CacheList[DISK_CACHE_PIN].tail;
+        cache_unlink(old);
+        cache_push(old, DISK_CACHE_DATA);
+    }
+    cache_push(e, l);
+}
+
+
+static
+void cache_store (          /* Copy a sector into the cache */
+    DWORD sector,
+    const BYTE* buff,
+    BYTE l)
+{
+    WORD e = cache_find(sector);
+    BYTE victim;
+
+    if (e != CACHE_NIL) {
+        cache_touch(e, l);
+    } else {
+        /* Pinned sectors evict each other once they fill their share, */
+        /* data sectors only ever evict data sectors */
+        victim = CACHE_FREE;
+        if (l == DISK_CACHE_PIN && CacheList[DISK_CACHE_PIN].count >= CachePinMax)
+            victim = DISK_CACHE_PIN;
+        else if (!CacheList[CACHE_FREE].count)
+            victim = CacheList[DISK_CACHE_DATA].count ? DISK_CACHE_DATA : DISK_CACHE_PIN;
+
+        if (victim == CACHE_FREE) {
+            e = CacheList[CACHE_FREE].head;
+        } else {
+            e = CacheList[victim].tail;
+            cache_drop(e);
+            CacheStats.evictions++;
+        }
+        cache_unlink(e);
+        CacheEntry[e].sector = sector;
+        CacheEntry[e].chain = CacheHash[sector & CacheHashMask];
+        CacheHash[sector & CacheHashMask] = e;
+        cache_push(e, l);
+    }
+    memcpy(CacheData + (DWORD)e * _MAX_SS, buff, _MAX_SS);
+}
+
+
+static
+void cache_reset (void)
+{
+    WORD e;
+
+    CacheList[DISK_CACHE_DATA].head = CacheList[DISK_CACHE_DATA].tail = CACHE_NIL;
+    CacheList[DISK_CACHE_DATA].count = 0;
+    CacheList[DISK_CACHE_PIN] = CacheList[CACHE_FREE] = CacheList[DISK_CACHE_DATA];
+    for (e = 0; e < CacheSectors; e++) cache_push(e, CACHE_FREE);
+    for (e = 0; e <= CacheHashMask; e++) CacheHash[e] = CACHE_NIL;
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Set up the sector cache in a block of memory (size 0 turns it off)    */
+/*-----------------------------------------------------------------------*/
+
+void disk_cache_init (
+    void* memory,           /* Block for the cache, word aligned */
+    DWORD size)             /* Size of the block in bytes */
+{
+    DWORD n;
+
+    n = size / (_MAX_SS + sizeof(CACHE_ENTRY) + sizeof(WORD));
+    if (n >= CACHE_NIL) n = CACHE_NIL - 1;
+    CacheSectors = 0;
+    if (!n) return;
+
+    CacheData = (BYTE*)memory;
+    CacheEntry = (CACHE_ENTRY*)(CacheData + n * _MAX_SS);
+    CacheHash = (WORD*)&CacheEntry[n];
+    for (CacheHashMask = 1; CacheHashMask * 2 <= n; CacheHashMask *= 2) ;
+    CacheHashMask--;
+
+    CacheSectors = (WORD)n;
+    CachePinMax = (WORD)(n / DISK_CACHE_PIN_SHARE);
+    cache_reset();
+    memset(&CacheStats, 0, sizeof(CacheStats));
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Set the read policy for sectors read into a fixed buffer              */
+/*-----------------------------------------------------------------------*/
+/* Any read landing in [buff, buff + size) gets the policy, so reads at  */
+/* an offset into a ring or a wave buffer are matched as well            */
+
+void disk_cache_buffer (
+    const BYTE* buff,       /* Buffer later passed to disk_read */
+    DWORD size,             /* Size of the buffer in bytes */
+    BYTE policy)            /* DISK_CACHE_DATA, DISK_CACHE_PIN or DISK_CACHE_NONE */
+{
+    BYTE i;
+
+    for (i = 0; i < DISK_CACHE_BUFFERS; i++) {
+        if (!CacheBuffer[i] || CacheBuffer[i] == buff) {
+            CacheBuffer[i] = buff;
+            CacheBufferSize[i] = size;
+            CachePolicy[i] = policy;
+            return;
+        }
+    }
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Get (and optionally clear) the cache counters                         */
+/*-----------------------------------------------------------------------*/
+
+void disk_cache_stats (
+    DISK_CACHE_STATS* stats,
+    BYTE clear)
+{
+    CacheStats.sectors = CacheSectors;
+    CacheStats.used = CacheSectors ? CacheSectors - CacheList[CACHE_FREE].count : 0;
+    CacheStats.pinned = CacheSectors ? CacheList[DISK_CACHE_PIN].count : 0;
+    *stats = CacheStats;
+    if (clear) {
+        CacheStats.hits = CacheStats.misses = CacheStats.bypassed = 0;
+        CacheStats.writes = CacheStats.evictions = 0;
+    }
+}
+
 /*-----------------------------------------------------------------------*/
 /* Initialize Disk Drive                                                 */
 /*-----------------------------------------------------------------------*/
@@ -40,6 +301,9 @@ disk_initialize(
     /* Clear the not init flag. */
     USBStat &= ~STA_NOINIT;
 
+    /* The drive may have been swapped, forget what was cached */
+    if (CacheSectors) cache_reset();
+
     return 0;
 }
 
@@ -61,6 +325,11 @@ DSTATUS disk_status (
 /*-----------------------------------------------------------------------*/
 /* This function reads sector(s) from the disk drive                     */
 /*-----------------------------------------------------------------------*/
+/* USBHMSCBlockRead runs the whole READ(10) transaction (CBW, data, CSW) */
+/* before it returns and the host MSC driver keeps its bulk pipes to     */
+/* itself, so no transfer can be left in flight from here. Drive time is */
+/* overlapped with playback one level up instead: the player fills its  */
+/* read-ahead ring while the I2S interrupt drains the wave buffers.      */
 
 DRESULT disk_read (
     BYTE drv,               /* Physical drive number (0) */
@@ -68,16 +337,47 @@ DRESULT disk_read (
     DWORD sector,           /* Physical drive nmuber (0) */
     BYTE count)             /* Sector count (1..255) */
 {
+    BYTE policy, n, i;
+    WORD e;
+
     if(USBStat & STA_NOINIT)
     {
         return(RES_NOTRDY);
     }
 
-    /* READ BLOCK */
-    if (USBHMSCBlockRead(g_MSCdriverInstance, sector, buff, count) == 0)
-        return RES_OK;
+    policy = cache_policy(buff);
+    if (!CacheSectors || policy == DISK_CACHE_NONE || count > DISK_CACHE_MAX_RUN) {
+        CacheStats.bypassed += count;
 
-    return RES_ERROR;
+        /* READ BLOCK */
+        if (USBHMSCBlockRead(g_MSCdriverInstance, sector, buff, count) == 0)
+            return RES_OK;
+
+        return RES_ERROR;
+    }
+
+    while (count) {
+        e = cache_find(sector);
+        if (e != CACHE_NIL) {
+            memcpy(buff, CacheData + (DWORD)e * _MAX_SS, _MAX_SS);
+            cache_touch(e, policy);
+            CacheStats.hits++;
+            n = 1;
+        } else {
+            /* Read the whole run of missing sectors with one command */
+            for (n = 1; n < count && cache_find(sector + n) == CACHE_NIL; n++) ;
+            if (USBHMSCBlockRead(g_MSCdriverInstance, sector, buff, n) != 0)
+                return RES_ERROR;
+            for (i = 0; i < n; i++)
+                cache_store(sector + i, buff + (UINT)i * _MAX_SS, policy);
+            CacheStats.misses += n;
+        }
+        sector += n;
+        buff += (UINT)n * _MAX_SS;
+        count -= n;
+    }
+
+    return RES_OK;
 }
 
 
@@ -93,13 +393,37 @@ DRESULT disk_write (
     DWORD sector,           /* Start sector number (LBA) */
     BYTE count)             /* Sector count (1..255) */
 {
+    BYTE policy, i;
+    WORD e;
+    int res;
+
     if (ucDrive || !count) return RES_PARERR;
     if (USBStat & STA_NOINIT) return RES_NOTRDY;
     if (USBStat & STA_PROTECT) return RES_WRPRT;
 
     /* WRITE BLOCK */
-    if(USBHMSCBlockWrite(g_MSCdriverInstance, sector, (unsigned char *)buff,
-                         count) == 0)
+    res = USBHMSCBlockWrite(g_MSCdriverInstance, sector, (unsigned char *)buff,
+                            count);
+
+    /* Write through: keep cached copies in step, or drop them if the */
+    /* drive now holds something unknown */
+    if (CacheSectors) {
+        policy = cache_policy(buff);
+        if (count > DISK_CACHE_MAX_RUN) policy = DISK_CACHE_NONE;
+        for (i = 0; i < count; i++, buff += _MAX_SS) {
+            e = cache_find(sector + i);
+            if (res != 0) {
+                if (e != CACHE_NIL) cache_drop(e);
+            } else if (e != CACHE_NIL) {
+                cache_store(sector + i, buff, CacheEntry[e].list);
+            } else if (policy != DISK_CACHE_NONE) {
+                cache_store(sector + i, buff, policy);
+            }
+        }
+        if (res == 0) CacheStats.writes += count;
+    }
+
+    if (res == 0)
         return RES_OK;
 
     return RES_ERROR;
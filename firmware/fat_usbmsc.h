@@ -0,0 +1,34 @@
+/*-----------------------------------------------------------------------*/
+/* Stellaris USB module - SDRAM sector cache                             */
+/*-----------------------------------------------------------------------*/
+
+#ifndef _FAT_USBMSC
+#define _FAT_USBMSC
+
+#include "fatfs/src/integer.h"
+
+/* Read policy of reads into a buffer given to disk_read (see disk_cache_buffer) */
+#define DISK_CACHE_DATA     0   /* Cached on the data LRU list (default) */
+#define DISK_CACHE_PIN      1   /* Cached on the pinned list, data reads can not evict it */
+#define DISK_CACHE_NONE     2   /* Read straight from the drive (streamed track data) */
+
+#define DISK_CACHE_BUFFERS  8   /* Number of buffers disk_cache_buffer can register */
+#define DISK_CACHE_MAX_RUN  8   /* Reads longer than this (sectors) bypass the cache */
+#define DISK_CACHE_PIN_SHARE 4  /* 1/n of the cache can be held by pinned sectors */
+
+typedef struct {
+    DWORD hits;         /* Sectors served from the cache */
+    DWORD misses;       /* Sectors read from the drive into the cache */
+    DWORD bypassed;     /* Sectors read from the drive without caching */
+    DWORD writes;       /* Sectors written through to the drive */
+    DWORD evictions;    /* Cached sectors dropped to make room */
+    DWORD sectors;      /* Capacity of the cache */
+    DWORD used;         /* Sectors currently cached */
+    DWORD pinned;       /* Of those, sectors on the pinned list */
+} DISK_CACHE_STATS;
+
+void disk_cache_init (void* memory, DWORD size);
+void disk_cache_buffer (const BYTE* buff, DWORD size, BYTE policy);
+void disk_cache_stats (DISK_CACHE_STATS* stats, BYTE clear);
+
+#endif
@@ -483,6 +483,35 @@ static
 FILESEM	Files[_FS_SHARE];	/* File lock semaphores */
 #endif
 
+#if _FS_DIRCACHE
+typedef struct {
+	WORD	id;			/* Mount ID of the file system (0:empty) */
+	WORD	index;		/* Directory index of the entry (of its first LFN entry if it has an LFN) */
+	DWORD	sclust;		/* Start cluster of the directory containing the entry */
+	BYTE	fn[11];		/* SFN of the name searched for */
+#if _USE_LFN
+	BYTE	cnt;		/* Number of directory entries of the object (LFN entries and SFN) */
+	DWORD	lkey;		/* Hash of the LFN searched for */
+#endif
+} DCENT;
+
+typedef struct {
+	WORD	id;			/* Mount ID of the file system (0:empty) */
+	WORD	len;		/* Length of the directory path */
+	DWORD	hash[2];	/* Hashes of the directory path */
+	DWORD	sclust;		/* Start cluster of the directory */
+} DCPATH;
+
+#define	DC_PATHS	(_FS_DIRCACHE / 4 + 1)
+
+static
+DCENT DcEnt[_FS_DIRCACHE];	/* Directory entry cache */
+static
+DCENT DcRead;				/* Entry last returned by f_readdir (fn and lkey not used) */
+static
+DCPATH DcPath[DC_PATHS];	/* Directory path cache */
+#endif
+
 #if _USE_LFN == 0			/* No LFN feature */
 #define	DEF_NAMEBUF			BYTE sfn[12]
 #define INIT_BUF(dobj)		(dobj).fn = sfn
@@ -741,6 +770,14 @@ FRESULT move_window (
 		}
 #endif
 		if (sector) {
+#if _FS_FATWIN
+			if (sector == fs->fatsect) {	/* Take the sector over from the FAT window (a sector is never in both) */
+				mem_cpy(fs->win, fs->fatwin, SS(fs));
+				fs->wflag = fs->fatflag;
+				fs->fatflag = 0;
+				fs->fatsect = 0;
+			} else
+#endif
 			if (disk_read(fs->drv, fs->win, sector, 1) != RES_OK)
 				return FR_DISK_ERR;
 			fs->winsect = sector;
@@ -753,6 +790,60 @@ FRESULT move_window (
 
 
 
+/*-----------------------------------------------------------------------*/
+/* Change FAT window offset                                              */
+/*-----------------------------------------------------------------------*/
+#if _FS_FATWIN
+static
+FRESULT move_fat_window (
+	FATFS *fs,		/* File system object */
+	DWORD sector	/* Sector number to make appearance in the fs->fatwin[] */
+)					/* Move to zero only writes back dirty window */
+{
+	DWORD wsect;
+
+
+	wsect = fs->fatsect;
+	if (wsect != sector) {	/* Changed current window */
+#if !_FS_READONLY
+		if (fs->fatflag) {	/* Write back dirty window if needed */
+			if (disk_write(fs->drv, fs->fatwin, wsect, 1) != RES_OK)
+				return FR_DISK_ERR;
+			fs->fatflag = 0;
+			if (wsect < (fs->fatbase + fs->fsize)) {	/* In FAT area */
+				BYTE nf;
+				for (nf = fs->n_fats; nf > 1; nf--) {	/* Reflect the change to all FAT copies */
+					wsect += fs->fsize;
+					disk_write(fs->drv, fs->fatwin, wsect, 1);
+				}
+			}
+		}
+#endif
+		if (sector) {
+			if (sector == fs->winsect) {	/* Take the sector over from the directory window */
+				mem_cpy(fs->fatwin, fs->win, SS(fs));
+				fs->fatflag = fs->wflag;
+				fs->wflag = 0;
+				fs->winsect = 0;
+			} else if (disk_read(fs->drv, fs->fatwin, sector, 1) != RES_OK)
+				return FR_DISK_ERR;
+			fs->fatsect = sector;
+		}
+	}
+
+	return FR_OK;
+}
+#define	FAT_WIN(fs)		((fs)->fatwin)
+#define	FAT_WFLAG(fs)	((fs)->fatflag)
+#else
+#define	move_fat_window	move_window
+#define	FAT_WIN(fs)		((fs)->win)
+#define	FAT_WFLAG(fs)	((fs)->wflag)
+#endif
+
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Clean-up cached data                                                  */
 /*-----------------------------------------------------------------------*/
@@ -766,6 +857,10 @@ FRESULT sync (	/* FR_OK: successful, FR_DISK_ERR: failed */
 
 
 	res = move_window(fs, 0);
+#if _FS_FATWIN
+	if (res == FR_OK)
+		res = move_fat_window(fs, 0);
+#endif
 	if (res == FR_OK) {
 		/* Update FSInfo sector if needed */
 		if (fs->fs_type == FS_FAT32 && fs->fsi_flag) {
@@ -831,20 +926,20 @@ DWORD get_fat (	/* 0xFFFFFFFF:Disk error, 1:Internal error, Else:Cluster status
 	switch (fs->fs_type) {
 	case FS_FAT12 :
 		bc = (UINT)clst; bc += bc / 2;
-		if (move_window(fs, fs->fatbase + (bc / SS(fs)))) break;
-		wc = fs->win[bc % SS(fs)]; bc++;
-		if (move_window(fs, fs->fatbase + (bc / SS(fs)))) break;
-		wc |= fs->win[bc % SS(fs)] << 8;
+		if (move_fat_window(fs, fs->fatbase + (bc / SS(fs)))) break;
+		wc = FAT_WIN(fs)[bc % SS(fs)]; bc++;
+		if (move_fat_window(fs, fs->fatbase + (bc / SS(fs)))) break;
+		wc |= FAT_WIN(fs)[bc % SS(fs)] << 8;
 		return (clst & 1) ? (wc >> 4) : (wc & 0xFFF);
 
 	case FS_FAT16 :
-		if (move_window(fs, fs->fatbase + (clst / (SS(fs) / 2)))) break;
-		p = &fs->win[clst * 2 % SS(fs)];
+		if (move_fat_window(fs, fs->fatbase + (clst / (SS(fs) / 2)))) break;
+		p = &FAT_WIN(fs)[clst * 2 % SS(fs)];
 		return LD_WORD(p);
 
 	case FS_FAT32 :
-		if (move_window(fs, fs->fatbase + (clst / (SS(fs) / 4)))) break;
-		p = &fs->win[clst * 4 % SS(fs)];
+		if (move_fat_window(fs, fs->fatbase + (clst / (SS(fs) / 4)))) break;
+		p = &FAT_WIN(fs)[clst * 4 % SS(fs)];
 		return LD_DWORD(p) & 0x0FFFFFFF;
 	}
 
@@ -877,29 +972,29 @@ FRESULT put_fat (
 		switch (fs->fs_type) {
 		case FS_FAT12 :
 			bc = clst; bc += bc / 2;
-			res = move_window(fs, fs->fatbase + (bc / SS(fs)));
+			res = move_fat_window(fs, fs->fatbase + (bc / SS(fs)));
 			if (res != FR_OK) break;
-			p = &fs->win[bc % SS(fs)];
+			p = &FAT_WIN(fs)[bc % SS(fs)];
 			*p = (clst & 1) ? ((*p & 0x0F) | ((BYTE)val << 4)) : (BYTE)val;
 			bc++;
-			fs->wflag = 1;
-			res = move_window(fs, fs->fatbase + (bc / SS(fs)));
+			FAT_WFLAG(fs) = 1;
+			res = move_fat_window(fs, fs->fatbase + (bc / SS(fs)));
 			if (res != FR_OK) break;
-			p = &fs->win[bc % SS(fs)];
+			p = &FAT_WIN(fs)[bc % SS(fs)];
 			*p = (clst & 1) ? (BYTE)(val >> 4) : ((*p & 0xF0) | ((BYTE)(val >> 8) & 0x0F));
 			break;
 
 		case FS_FAT16 :
-			res = move_window(fs, fs->fatbase + (clst / (SS(fs) / 2)));
+			res = move_fat_window(fs, fs->fatbase + (clst / (SS(fs) / 2)));
 			if (res != FR_OK) break;
-			p = &fs->win[clst * 2 % SS(fs)];
+			p = &FAT_WIN(fs)[clst * 2 % SS(fs)];
 			ST_WORD(p, (WORD)val);
 			break;
 
 		case FS_FAT32 :
-			res = move_window(fs, fs->fatbase + (clst / (SS(fs) / 4)));
+			res = move_fat_window(fs, fs->fatbase + (clst / (SS(fs) / 4)));
 			if (res != FR_OK) break;
-			p = &fs->win[clst * 4 % SS(fs)];
+			p = &FAT_WIN(fs)[clst * 4 % SS(fs)];
 			val |= LD_DWORD(p) & 0xF0000000;
 			ST_DWORD(p, val);
 			break;
@@ -907,7 +1002,7 @@ FRESULT put_fat (
 		default :
 			res = FR_INT_ERR;
 		}
-		fs->wflag = 1;
+		FAT_WFLAG(fs) = 1;
 	}
 
 	return res;
@@ -1181,6 +1276,16 @@ static
 const BYTE LfnOfs[] = {1,3,5,7,9,14,16,18,20,22,24,28,30};	/* Offset of LFN chars in the directory entry */
 
 
+static
+WCHAR lfn_upper (		/* Upper case of a Unicode char, ASCII without the table search */
+	WCHAR c
+)
+{
+	if (c < 0x80) return (c >= 'a' && c <= 'z') ? c - 0x20 : c;
+	return ff_wtoupper(c);
+}
+
+
 static
 int cmp_lfn (			/* 1:Matched, 0:Not matched */
 	WCHAR *lfnbuf,		/* Pointer to the LFN to be compared */
@@ -1196,9 +1301,11 @@ int cmp_lfn (			/* 1:Matched, 0:Not matched */
 	do {
 		uc = LD_WORD(dir+LfnOfs[s]);	/* Pick an LFN character from the entry */
 		if (wc) {	/* Last char has not been processed */
-			wc = ff_wtoupper(uc);		/* Convert it to upper case */
-			if (i >= _MAX_LFN || wc != ff_wtoupper(lfnbuf[i++]))	/* Compare it */
+			wc = uc;
+			if (i >= _MAX_LFN) return 0;
+			if (wc != lfnbuf[i] && lfn_upper(wc) != lfn_upper(lfnbuf[i]))	/* Compare it, case folded only if it differs */
 				return 0;				/* Not matched */
+			i++;
 		} else {
 			if (uc != 0xFFFF) return 0;	/* Check filler */
 		}
@@ -1345,6 +1452,96 @@ BYTE sum_sfn (
 
 
 
+/*-----------------------------------------------------------------------*/
+/* Hash an LFN for the directory lookup cache                            */
+/*-----------------------------------------------------------------------*/
+#if _USE_LFN && _FS_DIRCACHE
+static
+DWORD lfn_key (		/* Hash of the LFN with ASCII letters folded to upper case */
+	const WCHAR *lfn,
+	UINT *len		/* Length of the LFN */
+)
+{
+	DWORD h = 2166136261UL;
+	WCHAR c;
+	UINT i;
+
+
+	for (i = 0; (c = lfn[i]) != 0; i++) {
+		if (c >= 'a' && c <= 'z') c -= 0x20;
+		h = (h ^ c) * 16777619UL;
+	}
+	*len = i;
+	return h;
+}
+#endif
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Directory lookup cache                                                */
+/*-----------------------------------------------------------------------*/
+#if _FS_DIRCACHE
+static
+void dc_clear (void)
+{
+	mem_set(DcEnt, 0, sizeof(DcEnt));
+	mem_set(DcPath, 0, sizeof(DcPath));
+	mem_set(&DcRead, 0, sizeof(DcRead));
+}
+
+
+static
+DCENT* dc_entry (	/* Cache slot of a name in a directory */
+	DWORD sclust,	/* Start cluster of the directory */
+	const BYTE *fn,	/* SFN */
+	DWORD lkey		/* Hash of the LFN (0:no LFN) */
+)
+{
+	DWORD h = sclust ^ lkey;
+	UINT i;
+
+
+	for (i = 0; i < 11; i++) h = h * 31 + fn[i];
+	return &DcEnt[h % _FS_DIRCACHE];
+}
+
+
+static
+const TCHAR* dc_path (	/* Returns the last segment of the path */
+	DWORD sclust,		/* Start directory of the path */
+	const TCHAR *path,	/* Path without heading separator */
+	DWORD *hash,		/* Hashes of the directory part */
+	UINT *len			/* Length of the directory part (0:no directory part) */
+)
+{
+	const TCHAR *last = path;
+	UINT i, c;
+
+
+	for (i = 0; (UINT)path[i] >= ' '; i++) {
+		if (path[i] == '/' || path[i] == '\\') last = &path[i + 1];
+	}
+	*len = ((UINT)*last >= ' ') ? (UINT)(last - path) : 0;	/* No caching for a trailing separator */
+
+	hash[0] = 2166136261UL ^ sclust;
+	hash[1] = 5381 + sclust;
+	for (i = 0; i < *len; i++) {	/* Hash the folded directory part */
+		c = (UINT)path[i];
+		if (IsLower(c)) c -= 0x20;
+		if (c == '\\') c = '/';
+		hash[0] = (hash[0] ^ c) * 16777619UL;
+		hash[1] = hash[1] * 33 + c;
+	}
+
+	return last;
+}
+#endif
+
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Directory handling - Find an object in the directory                  */
 /*-----------------------------------------------------------------------*/
@@ -1356,49 +1553,114 @@ FRESULT dir_find (
 {
 	FRESULT res;
 	BYTE c, *dir;
+	WORD start, limit, n;
 #if _USE_LFN
 	BYTE a, ord, sum;
+	UINT len;
+#endif
+#if _FS_DIRCACHE
+	DCENT *ent;
+	DWORD lkey = 0;
 #endif
 
-	res = dir_sdi(dj, 0);			/* Rewind directory object */
-	if (res != FR_OK) return res;
 
+	start = 0; limit = 0;			/* Search the whole directory */
 #if _USE_LFN
-	ord = sum = 0xFF;
+	len = 0;
+#if _FS_DIRCACHE
+	if (dj->lfn) lkey = lfn_key(dj->lfn, &len);
+#else
+	if (dj->lfn) while (dj->lfn[len]) len++;
 #endif
-	do {
-		res = move_window(dj->fs, dj->sect);
-		if (res != FR_OK) break;
-		dir = dj->dir;					/* Ptr to the directory entry of current index */
-		c = dir[DIR_Name];
-		if (c == 0) { res = FR_NO_FILE; break; }	/* Reached to end of table */
+#endif
+#if _FS_DIRCACHE
+	ent = dc_entry(dj->sclust, dj->fn, lkey);
+	if (ent->id == dj->fs->id && ent->sclust == dj->sclust && !mem_cmp(ent->fn, dj->fn, 11)
+#if _USE_LFN
+		&& ent->lkey == lkey
+#endif
+		) {
+		start = ent->index;			/* Check the entries where it was found last time first */
+#if _USE_LFN
+		limit = ent->cnt;
+#else
+		limit = 1;
+#endif
+	} else if (DcRead.id == dj->fs->id && DcRead.sclust == dj->sclust) {
+		start = DcRead.index;		/* Else the entry just read, a directory walk opens what it lists */
+#if _USE_LFN
+		limit = DcRead.cnt;
+#else
+		limit = 1;
+#endif
+	}
+#endif
+
+	for (;;) {
+		res = dir_sdi(dj, start);	/* Rewind directory object */
+		if (res != FR_OK) {
+			if (!limit) return res;
+			start = 0; limit = 0; continue;
+		}
+
+#if _USE_LFN
+		ord = sum = 0xFF; dj->lfn_idx = 0xFFFF;
+#endif
+		n = limit;
+		do {
+			res = move_window(dj->fs, dj->sect);
+			if (res != FR_OK) break;
+			dir = dj->dir;					/* Ptr to the directory entry of current index */
+			c = dir[DIR_Name];
+			if (c == 0) { res = FR_NO_FILE; break; }	/* Reached to end of table */
 #if _USE_LFN	/* LFN configuration */
-		a = dir[DIR_Attr] & AM_MASK;
-		if (c == DDE || ((a & AM_VOL) && a != AM_LFN)) {	/* An entry without valid data */
-			ord = 0xFF;
-		} else {
-			if (a == AM_LFN) {			/* An LFN entry is found */
-				if (dj->lfn) {
-					if (c & LLE) {		/* Is it start of LFN sequence? */
-						sum = dir[LDIR_Chksum];
-						c &= ~LLE; ord = c;	/* LFN start order */
-						dj->lfn_idx = dj->index;
+			a = dir[DIR_Attr] & AM_MASK;
+			if (c == DDE || ((a & AM_VOL) && a != AM_LFN)) {	/* An entry without valid data */
+				ord = 0xFF;
+			} else {
+				if (a == AM_LFN) {			/* An LFN entry is found */
+					if (dj->lfn) {
+						if (c & LLE) {		/* Is it start of LFN sequence? */
+							sum = dir[LDIR_Chksum];
+							c &= ~LLE; ord = c;	/* LFN start order */
+							dj->lfn_idx = dj->index;
+							if ((len + 12) / 13 != c) ord = 0xFF;	/* Skip a sequence of another length without comparing it */
+						}
+						/* Check validity of the LFN entry and compare it with given name */
+						ord = (c == ord && sum == dir[LDIR_Chksum] && cmp_lfn(dj->lfn, dir)) ? ord - 1 : 0xFF;
 					}
-					/* Check validity of the LFN entry and compare it with given name */
-					ord = (c == ord && sum == dir[LDIR_Chksum] && cmp_lfn(dj->lfn, dir)) ? ord - 1 : 0xFF;
+				} else {					/* An SFN entry is found */
+					if (!ord && sum == sum_sfn(dir)) break;	/* LFN matched? */
+					ord = 0xFF; dj->lfn_idx = 0xFFFF;	/* Reset LFN sequence */
+					if (!(dj->fn[NS] & NS_LOSS) && !mem_cmp(dir, dj->fn, 11)) break;	/* SFN matched? */
 				}
-			} else {					/* An SFN entry is found */
-				if (!ord && sum == sum_sfn(dir)) break;	/* LFN matched? */
-				ord = 0xFF; dj->lfn_idx = 0xFFFF;	/* Reset LFN sequence */
-				if (!(dj->fn[NS] & NS_LOSS) && !mem_cmp(dir, dj->fn, 11)) break;	/* SFN matched? */
 			}
-		}
 #else		/* Non LFN configuration */
-		if (!(dir[DIR_Attr] & AM_VOL) && !mem_cmp(dir, dj->fn, 11)) /* Is it a valid entry? */
-			break;
+			if (!(dir[DIR_Attr] & AM_VOL) && !mem_cmp(dir, dj->fn, 11)) /* Is it a valid entry? */
+				break;
+#endif
+			if (n && !--n) { res = FR_NO_FILE; break; }	/* Not in the cached entries */
+			res = dir_next(dj, 0);		/* Next entry */
+		} while (res == FR_OK);
+
+		if (res != FR_NO_FILE || !limit) break;
+		start = 0; limit = 0;			/* It has moved, search the whole directory */
+	}
+
+#if _FS_DIRCACHE
+	if (res == FR_OK) {				/* Remember where it was found */
+		ent->id = dj->fs->id;
+		ent->sclust = dj->sclust;
+		mem_cpy(ent->fn, dj->fn, 11);
+#if _USE_LFN
+		ent->index = (dj->lfn_idx == 0xFFFF) ? dj->index : dj->lfn_idx;
+		ent->cnt = (BYTE)(dj->index - ent->index + 1);
+		ent->lkey = lkey;
+#else
+		ent->index = dj->index;
+#endif
+	}
 #endif
-		res = dir_next(dj, 0);		/* Next entry */
-	} while (res == FR_OK);
 
 	return res;
 }
@@ -1923,6 +2185,12 @@ FRESULT follow_path (	/* FR_OK(0): successful, !=0: error code */
 {
 	FRESULT res;
 	BYTE *dir, ns;
+#if _FS_DIRCACHE
+	DCPATH *dcp;
+	const TCHAR *last;
+	DWORD hash[2];
+	UINT len;
+#endif
 
 
 #if _FS_RPATH
@@ -1942,9 +2210,27 @@ FRESULT follow_path (	/* FR_OK(0): successful, !=0: error code */
 		dj->dir = 0;
 
 	} else {							/* Follow path */
+#if _FS_DIRCACHE
+		last = dc_path(dj->sclust, path, hash, &len);
+		dcp = &DcPath[hash[0] % DC_PATHS];
+		if (len && dcp->id == dj->fs->id && dcp->len == len
+			&& dcp->hash[0] == hash[0] && dcp->hash[1] == hash[1]) {
+			dj->sclust = dcp->sclust;		/* The directory is known, go to the last segment */
+			path = last;
+		}
+#endif
 		for (;;) {
 			res = create_name(dj, &path);	/* Get a segment */
 			if (res != FR_OK) break;
+#if _FS_DIRCACHE
+			if (len && (dj->fn[NS] & NS_LAST)) {
+				dcp->id = dj->fs->id;		/* Remember the directory of the last segment */
+				dcp->len = (WORD)len;
+				dcp->hash[0] = hash[0];
+				dcp->hash[1] = hash[1];
+				dcp->sclust = dj->sclust;
+			}
+#endif
 			res = dir_find(dj);				/* Find it */
 			ns = *(dj->fn+NS);
 			if (res != FR_OK) {				/* Failed to find the object */
@@ -2151,6 +2437,10 @@ FRESULT chk_mounted (	/* FR_OK(0): successful, !=0: any error occurred */
 	fs->id = ++Fsid;		/* File system mount ID */
 	fs->winsect = 0;		/* Invalidate sector cache */
 	fs->wflag = 0;
+#if _FS_FATWIN
+	fs->fatsect = 0;
+	fs->fatflag = 0;
+#endif
 #if _FS_RPATH
 	fs->cdir = 0;			/* Current directory (root dir) */
 #endif
@@ -2418,8 +2708,22 @@ FRESULT f_read (
 			sect += csect;
 			cc = btr / SS(fp->fs);				/* When remaining bytes >= sector size, */
 			if (cc) {							/* Read maximum contiguous sectors directly */
-				if (csect + cc > fp->fs->csize)	/* Clip at cluster boundary */
-					cc = fp->fs->csize - csect;
+				DWORD ncl;
+				UINT mcc;
+				if (cc > 255) cc = 255;			/* disk_read() takes up to 255 sectors */
+				mcc = fp->fs->csize - csect;	/* Sectors to the end of the cluster */
+				while (mcc < cc) {				/* Take in the following clusters while they are physically adjacent */
+#if _USE_FASTSEEK
+					if (fp->cltbl)
+						ncl = clmt_clust(fp, fp->fptr + mcc * SS(fp->fs));
+					else
+#endif
+						ncl = get_fat(fp->fs, fp->clust);
+					if (ncl != fp->clust + 1 || ncl >= fp->fs->n_fatent) break;
+					fp->clust = ncl;				/* Last cluster read from */
+					mcc += fp->fs->csize;
+				}
+				if (cc > mcc) cc = mcc;			/* Clip at the end of the contiguous clusters */
 				if (disk_read(fp->fs->drv, rbuff, sect, (BYTE)cc) != RES_OK)
 					ABORT(fp->fs, FR_DISK_ERR);
 #if !_FS_READONLY && _FS_MINIMIZE <= 2			/* Replace one of the read sectors with cached data if it contains a dirty sector */
@@ -3021,6 +3325,19 @@ FRESULT f_readdir (
 			}
 			if (res == FR_OK) {				/* A valid entry is found */
 				get_fileinfo(dj, fno);		/* Get the object information */
+				dj->rclust = dj->sect ? LD_CLUST(dj->dir) : 0;	/* Where f_opensubdir finds it */
+#if _FS_DIRCACHE
+				if (dj->sect) {				/* Remember where it is for a following open */
+					DcRead.id = dj->fs->id;
+					DcRead.sclust = dj->sclust;
+#if _USE_LFN
+					DcRead.index = (dj->lfn_idx == 0xFFFF) ? dj->index : dj->lfn_idx;
+					DcRead.cnt = (BYTE)(dj->index - DcRead.index + 1);
+#else
+					DcRead.index = dj->index;
+#endif
+				}
+#endif
 				res = dir_next(dj, 0);		/* Increment index for next */
 				if (res == FR_NO_FILE) {
 					dj->sect = 0;
@@ -3036,6 +3353,39 @@ FRESULT f_readdir (
 
 
 
+
+/*-----------------------------------------------------------------------*/
+/* Open the Sub-directory Last Read from a Directory                     */
+/*-----------------------------------------------------------------------*/
+/* The directory is opened from its start cluster, so a tree walk does not
+/  follow the path of each sub-directory from the root again */
+
+FRESULT f_opensubdir (
+	DIR *dj,			/* Pointer to directory object to create */
+	const DIR *parent	/* Directory the sub-directory entry was read from */
+)
+{
+	FRESULT res;
+
+
+	res = validate(parent->fs, parent->id);	/* Check validity of the parent */
+	if (res == FR_OK) {
+		if (!parent->rclust) {				/* No entry read or it has no cluster */
+			res = FR_NO_PATH;
+		} else {
+			dj->fs = parent->fs;
+			dj->id = parent->id;
+			dj->sclust = parent->rclust;
+			dj->rclust = 0;
+			res = dir_sdi(dj, 0);			/* Rewind dir */
+		}
+	}
+
+	LEAVE_FF(parent->fs, res);
+}
+
+
+
 #if _FS_MINIMIZE == 0
 /*-----------------------------------------------------------------------*/
 /* Get File Status                                                       */
@@ -3235,6 +3585,9 @@ FRESULT f_unlink (
 				}
 			}
 			if (res == FR_OK) {
+#if _FS_DIRCACHE
+				dc_clear();
+#endif
 				res = dir_remove(&dj);		/* Remove the directory entry */
 				if (res == FR_OK) {
 					if (dclst)				/* Remove the cluster chain if exist */
@@ -3442,6 +3795,9 @@ FRESULT f_rename (
 				res = follow_path(&djn, path_new);
 				if (res == FR_OK) res = FR_EXIST;		/* The new object name is already existing */
 				if (res == FR_NO_FILE) { 				/* Is it a valid path and no name collision? */
+#if _FS_DIRCACHE
+					dc_clear();
+#endif
 /* Start critical section that any interruption or error can cause cross-link */
 					res = dir_register(&djn);			/* Register the new entry */
 					if (res == FR_OK) {
@@ -104,6 +104,11 @@ typedef struct {
 	DWORD	database;		/* Data start sector */
 	DWORD	winsect;		/* Current sector appearing in the win[] */
 	BYTE	win[_MAX_SS];	/* Disk access window for Directory, FAT (and Data on tiny cfg) */
+#if _FS_FATWIN
+	BYTE	fatflag;		/* fatwin[] dirty flag (1:must be written back) */
+	DWORD	fatsect;		/* Current sector appearing in the fatwin[] */
+	BYTE	fatwin[_MAX_SS];	/* Disk access window for FAT */
+#endif
 } FATFS;
 
 
@@ -152,6 +157,7 @@ typedef struct {
 	WCHAR*	lfn;			/* Pointer to the LFN working buffer */
 	WORD	lfn_idx;		/* Last matched LFN index number (0xFFFF:No LFN) */
 #endif
+	DWORD	rclust;			/* Start cluster of the entry last read by f_readdir */
 } DIR;
 
 
@@ -209,6 +215,7 @@ FRESULT f_lseek (FIL*, DWORD);						/* Move file pointer of a file object */
 FRESULT f_close (FIL*);								/* Close an open file object */
 FRESULT f_opendir (DIR*, const TCHAR*);				/* Open an existing directory */
 FRESULT f_readdir (DIR*, FILINFO*);					/* Read a directory item */
+FRESULT f_opensubdir (DIR*, const DIR*);			/* Open the sub-directory last read from a directory */
 FRESULT f_stat (const TCHAR*, FILINFO*);			/* Get file status */
 FRESULT f_write (FIL*, const void*, UINT, UINT*);	/* Write data to a file */
 FRESULT f_getfree (const TCHAR*, DWORD*, FATFS**);	/* Get number of free clusters on the drive */
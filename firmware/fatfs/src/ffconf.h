@@ -20,6 +20,12 @@
 /  data transfer. This reduces memory consumption 512 bytes each file object. */
 
 
+#define	_FS_FATWIN		1	/* 0:Shared window or 1:Separate FAT window */
+/* When _FS_FATWIN is set to 1, FAT entries are accessed through a second sector
+/  buffer in the file system object, so FAT lookups and directory entry reads
+/  do not evict each other. This increases the file system object 512 bytes. */
+
+
 #define _FS_READONLY	0	/* 0:Read/Write or 1:Read only */
 /* Setting _FS_READONLY to 1 defines read only configuration. This removes
 /  writing functions, f_write, f_sync, f_unlink, f_mkdir, f_chmod, f_rename,
@@ -48,16 +54,25 @@
 /* To enable f_forward function, set _USE_FORWARD to 1 and set _FS_TINY to 1. */
 
 
-#define	_USE_FASTSEEK	0	/* 0:Disable or 1:Enable */
+#define	_USE_FASTSEEK	1	/* 0:Disable or 1:Enable */
 /* To enable fast seek feature, set _USE_FASTSEEK to 1. */
 
 
+#define	_FS_DIRCACHE	32	/* 0:Disable or >=1:Number of cached directory entries */
+/* When _FS_DIRCACHE is not zero, follow_path remembers where recently found
+/  directory entries are and which cluster recently used directory paths start
+/  at, so opening a file deep in the tree does not scan every directory from
+/  the root. The entry last returned by f_readdir is tried as well, so a walk
+/  that opens each file it lists finds it at once. Long names are cached by a
+/  hash of the name. The cache is dropped on mount, f_unlink and f_rename. */
+
+
 
 /*---------------------------------------------------------------------------/
 / Locale and Namespace Configurations
 /----------------------------------------------------------------------------*/
 
-#define _CODE_PAGE	932
+#define _CODE_PAGE	437
 /* The _CODE_PAGE specifies the OEM code page to be used on the target system.
 /  Incorrect setting of the code page can cause a file open failure.
 /
@@ -90,7 +105,7 @@
 */
 
 
-#define	_USE_LFN	0		/* 0 to 3 */
+#define	_USE_LFN	1		/* 0 to 3 */
 #define	_MAX_LFN	255		/* Maximum LFN length to handle (12 to 255) */
 /* The _USE_LFN option switches the LFN support.
 /
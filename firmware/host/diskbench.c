@@ -0,0 +1,194 @@
+/*
+Host equivalent of the openHiFi "bench disk" command
+
+Copyright (C) 2011 teho Labs/B. A. Bryce
+
+Runs the firmware's FatFs (ff.c) on a drive plugged into a PC, or on an image
+of one, and prints the same tables as bench disk: disk_read throughput at
+several transfer sizes, random 4K read latency and f_read throughput of a file.
+Drives can then be compared and buffer sizes tuned without the board.
+
+The drive is opened with O_DIRECT where the host has it, so the page cache
+does not answer the reads. Image files on file systems without O_DIRECT are
+read through the page cache, which only gives an upper bound.
+
+usage: diskbench <device or image> [file]
+
+Please see project readme for more details on licenses
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "ff.h"
+#include "diskio.h"
+
+#define benchBytes (1024*1024)
+#define benchRandomReads 64
+
+static int Drive = -1;
+static BYTE* Bounce;                    /* 255 sectors, aligned for O_DIRECT */
+
+DSTATUS disk_initialize (BYTE drv)
+{
+    return (drv || Drive < 0) ? STA_NOINIT : 0;
+}
+
+DSTATUS disk_status (BYTE drv)
+{
+    return (drv || Drive < 0) ? STA_NOINIT : STA_PROTECT;
+}
+
+/* O_DIRECT needs aligned buffers, so every read goes through Bounce */
+DRESULT disk_read (BYTE drv, BYTE* buff, DWORD sector, BYTE count)
+{
+    size_t length = (size_t)count * _MAX_SS;
+
+    if (drv || !count) return RES_PARERR;
+    if (pread(Drive, Bounce, length, (off_t)sector * _MAX_SS) != (ssize_t)length) return RES_ERROR;
+    memcpy(buff, Bounce, length);
+    return RES_OK;
+}
+
+DRESULT disk_write (BYTE drv, const BYTE* buff, DWORD sector, BYTE count)
+{
+    return RES_WRPRT;
+}
+
+DRESULT disk_ioctl (BYTE drv, BYTE ctrl, void* buff)
+{
+    return ctrl == CTRL_SYNC ? RES_OK : RES_PARERR;
+}
+
+DWORD get_fattime (void)
+{
+    return 0;
+}
+
+static unsigned long benchMicroseconds(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000000 + t.tv_nsec / 1000;
+}
+
+int main(int argc, char **argv)
+{
+    static const BYTE sectorCounts[] = {1, 8, 32, 64, 128, 255};
+    static const UINT readSizes[] = {512, 4096, 32768, 65536};
+    static FATFS fs;
+    static FIL file;
+    static DWORD linkMap[128 * 1024 / sizeof(DWORD)];     /* linkMapSize of the firmware */
+    DIR dir;
+    BYTE* buffer;
+    DWORD first, length, sector, total, seed;
+    unsigned long start, elapsed, readTime, best, worst, reads, i, k;
+    const char* path;
+    UINT s1;
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: diskbench <device or image> [file]\n");
+        return 1;
+    }
+    path = argc > 2 ? argv[2] : "index.txt";
+
+    Drive = open(argv[1], O_RDONLY | O_DIRECT);
+    if (Drive < 0) {
+        Drive = open(argv[1], O_RDONLY);
+        if (Drive >= 0) printf("No O_DIRECT on %s, reads can come from the page cache\n", argv[1]);
+    }
+    if (Drive < 0) {
+        fprintf(stderr, "Cannot open: %s\n", argv[1]);
+        return 1;
+    }
+    if (posix_memalign((void**)&Bounce, 4096, 255 * _MAX_SS) != 0 || posix_memalign((void**)&buffer, 4096, 255 * _MAX_SS) != 0) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    /* Mounts the drive, the reads stay inside the data area of the volume */
+    f_mount(0, &fs);
+    if (f_opendir(&dir, "/") != FR_OK) {
+        fprintf(stderr, "No FAT volume on %s\n", argv[1]);
+        return 1;
+    }
+    first = fs.database;
+    length = (fs.n_fatent - 2) * fs.csize;
+
+    total = benchBytes / _MAX_SS;
+    if (total > length) total = length;
+
+    printf("Sequential disk_read\n Sectors    KB/s  us/read\n");
+    for (k = 0; k < sizeof(sectorCounts); k++) {
+        /* Each size reads a new span so the drive can not answer from its own buffer */
+        sector = first + k * total;
+        if (sector + total > first + length) sector = first;
+
+        reads = total / sectorCounts[k];
+        start = benchMicroseconds();
+        for (i = 0; i < reads; i++) {
+            if (disk_read(0, buffer, sector, sectorCounts[k]) != RES_OK) {
+                printf("Read error at sector %lu\n", (unsigned long)sector);
+                return 1;
+            }
+            sector += sectorCounts[k];
+        }
+        elapsed = benchMicroseconds() - start;
+        if (elapsed == 0) elapsed = 1;
+
+        printf("%8u %7lu %8lu\n", sectorCounts[k], reads * sectorCounts[k] / 2 * 1000000 / elapsed, elapsed / reads);
+    }
+
+    seed = (DWORD)benchMicroseconds();
+    best = 0xFFFFFFFF;
+    worst = 0;
+    elapsed = 0;
+    for (i = 0; i < benchRandomReads; i++) {
+        seed = seed * 1103515245 + 12345;
+        sector = first + ((seed >> 8) % (length / 8)) * 8;
+
+        start = benchMicroseconds();
+        if (disk_read(0, buffer, sector, 8) != RES_OK) {
+            printf("Read error at sector %lu\n", (unsigned long)sector);
+            return 1;
+        }
+        readTime = benchMicroseconds() - start;
+
+        elapsed += readTime;
+        if (readTime < best) best = readTime;
+        if (readTime > worst) worst = readTime;
+    }
+    printf("Random 4K disk_read (%u reads)\n     Avg      Min      Max (us)\n%8lu %8lu %8lu\n", benchRandomReads,
+           elapsed / benchRandomReads, best, worst);
+
+    if (f_open(&file, path, FA_OPEN_EXISTING | FA_READ) != FR_OK) {
+        printf("Cannot open: %s\n", path);
+        return 1;
+    }
+    /* The firmware reads with a cluster link map (see fileLinkMap) */
+    file.cltbl = linkMap;
+    linkMap[0] = sizeof(linkMap) / sizeof(DWORD);
+    if (f_lseek(&file, CREATE_LINKMAP) != FR_OK) file.cltbl = 0;
+
+    total = f_size(&file) < benchBytes ? f_size(&file) : benchBytes;
+    printf("f_read %s (%lu KB)\n   Bytes    KB/s\n", path, (unsigned long)total / 1024);
+    for (k = 0; k < sizeof(readSizes) / sizeof(readSizes[0]) && total; k++) {
+        f_lseek(&file, 0);
+        start = benchMicroseconds();
+        for (i = 0; i < total; i += s1) {
+            if (f_read(&file, buffer, readSizes[k], &s1) != FR_OK || s1 == 0) break;
+        }
+        elapsed = benchMicroseconds() - start;
+        if (elapsed == 0) elapsed = 1;
+
+        printf("%8u %7lu\n", readSizes[k], i / 1024 * 1000000 / elapsed);
+    }
+    f_close(&file);
+    close(Drive);
+    return 0;
+}
@@ -0,0 +1,177 @@
+/*
+Host benchmark of the openHiFi MP3 decoder
+
+Copyright (C) 2011 teho Labs/B. A. Bryce
+
+Decodes the Layer III frames of an MP3 file with mp3.c as the firmware does
+(same SRAM scratch size, see playMP3) and reports the cycles each frame took
+against what the 50 MHz Cortex-M3 has for it.
+
+Cycles are read from the host time stamp counter, or are nanoseconds on hosts
+without one. The Cortex-M3 needs more cycles than a desktop CPU for the same
+code, and the ratio depends on both machines, so it has to be given: run
+"bench mp3 <file>" on the board for the same file and pass its average cycles
+per frame divided by the host average printed here. Both time only
+mp3_decode_frame and mp3_read_pcm, so the ratio holds for other files.
+
+usage: mp3bench <file.mp3> <scale> [repeats]
+
+Please see project readme for more details on licenses
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "mp3.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CYCLE_UNIT "cycles"
+static uint64_t cycles(void)
+{
+    return __rdtsc();
+}
+#else
+#define CYCLE_UNIT "ns"
+static uint64_t cycles(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000 + t.tv_nsec;
+}
+#endif
+
+#define TARGET_CLOCK 50000000                   /* Cortex-M3 clock (Hz) */
+#define FAST_SIZE (32768 + 4608 * 8)            /* decoderScatchSize of the firmware */
+#define PCM_FRAMES 4096                         /* Frames in one wave buffer */
+
+static const unsigned short bitrates[2][15] = {
+    {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320},
+    {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160}
+};
+
+static const unsigned short samplerates[3] = {44100, 48000, 32000};
+
+/* Length of the Layer III frame starting at p, 0 when it is not one (see parceMPEGframe) */
+static unsigned long frame_length(const uint8_t *p)
+{
+    int version, bitrate, rate, samplerate;
+
+    if (p[0] != 0xff || (p[1] & 0xe0) != 0xe0 || ((p[1] >> 1) & 3) != 1)
+        return 0;
+    version = (p[1] >> 3) & 3;
+    bitrate = p[2] >> 4;
+    rate = (p[2] >> 2) & 3;
+    if (version == 1 || bitrate == 0 || bitrate == 15 || rate == 3)
+        return 0;
+
+    samplerate = samplerates[rate] >> (version == 3 ? 0 : version == 2 ? 1 : 2);
+    if (version == 3)
+        return 144000 * bitrates[0][bitrate] / samplerate + ((p[2] >> 1) & 1);
+    return 72000 * bitrates[1][bitrate] / samplerate + ((p[2] >> 1) & 1);
+}
+
+static Mp3Context mp3;
+static uint8_t fast_memory[FAST_SIZE];
+static uint16_t pcm[PCM_FRAMES * 2];
+
+int main(int argc, char **argv)
+{
+    FILE *f;
+    uint8_t *data;
+    unsigned long size, start, position, length, frames = 0, bad = 0;
+    uint64_t begin, frame_cycles, total_cycles = 0, max_cycles = 0, samples = 0;
+    double budget, scale;
+    int repeats, repeat, count, samplerate = 0, channels = 0, version = 0;
+
+    if (argc < 3) {
+        fprintf(stderr, "usage: mp3bench <file.mp3> <scale> [repeats]\n"
+                "scale is board cycles / host cycles per frame, from bench mp3 on the board\n");
+        return 1;
+    }
+    scale = atof(argv[2]);
+    repeats = argc > 3 ? atoi(argv[3]) : 1;
+    if (scale <= 0 || repeats < 1) {
+        fprintf(stderr, "Bad scale or repeats\n");
+        return 1;
+    }
+
+    f = fopen(argv[1], "rb");
+    if (f == NULL) {
+        fprintf(stderr, "Cannot open: %s\n", argv[1]);
+        return 1;
+    }
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    data = malloc(size + 4);
+    if (data == NULL || fread(data, 1, size, f) != size) {
+        fprintf(stderr, "Read failure\n");
+        return 1;
+    }
+    fclose(f);
+    memset(data + size, 0, 4);
+
+    /* The ID3v2 tag is skipped, its size is syncsafe and does not include the header */
+    start = 0;
+    if (size >= 10 && memcmp(data, "ID3", 3) == 0)
+        start = 10 + ((data[6] & 0x7f) << 21 | (data[7] & 0x7f) << 14 | (data[8] & 0x7f) << 7 | (data[9] & 0x7f));
+
+    for (repeat = 0; repeat < repeats; repeat++) {
+        if (mp3_init(&mp3, fast_memory, FAST_SIZE) != 0) {
+            fprintf(stderr, "mp3_init needs %d bytes\n", MP3_FAST_SIZE);
+            return 1;
+        }
+
+        /* Bytes that do not start a frame are skipped one at a time, as readMPEGframe does */
+        for (position = start; position + 4 <= size; position += length) {
+            length = frame_length(&data[position]);
+            if (length == 0) {
+                length = 1;
+                continue;
+            }
+            if (position + length > size)
+                break;
+
+            /* Times the same span as bench mp3: decode and PCM copy, not the file reads */
+            begin = cycles();
+            if (mp3_decode_frame(&mp3, &data[position], length) < 0) {
+                bad++;
+                continue;
+            }
+            while ((count = mp3_read_pcm(&mp3, pcm, PCM_FRAMES)) > 0)
+                samples += count;
+            frame_cycles = cycles() - begin;
+
+            total_cycles += frame_cycles;
+            if (frame_cycles > max_cycles)
+                max_cycles = frame_cycles;
+            frames++;
+
+            samplerate = mp3.samplerate;
+            channels = mp3.channels;
+            version = mp3.version;
+        }
+    }
+
+    if (frames == 0 || samples == 0) {
+        fprintf(stderr, "No Layer III frames\n");
+        return 1;
+    }
+
+    /* Cycles the target has for the audio of an average frame */
+    budget = (double)samples / samplerate * TARGET_CLOCK / frames;
+
+    printf("%s: MPEG-%s Layer III, %d channels, %d Hz\n", argv[1], version == 1 ? "1" : version == 2 ? "2" : "2.5",
+           channels, samplerate);
+    printf("memory: %lu of %d bytes SRAM scratch\n", mp3.fast_used, FAST_SIZE);
+    printf("%lu frames (%lu without PCM), %llu samples\n", frames, bad, (unsigned long long)samples);
+    printf("%-24s %12s %12s\n", "per frame", "average", "worst");
+    printf("%-24s %12.0f %12.0f\n", "host " CYCLE_UNIT, (double)total_cycles / frames, (double)max_cycles);
+    printf("%-24s %12.0f %12.0f\n", "scaled", scale * total_cycles / frames, scale * max_cycles);
+    printf("%-24s %12.0f\n", "50 MHz budget", budget);
+    printf("%.1f%% of the 50 MHz budget (scale %.2f)\n", 100.0 * scale * total_cycles / frames / budget, scale);
+    return 0;
+}
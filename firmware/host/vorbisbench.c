@@ -0,0 +1,161 @@
+/*
+Host benchmark of the openHiFi Vorbis decoder
+
+Copyright (C) 2011 teho Labs/B. A. Bryce
+
+Decodes an Ogg Vorbis file with vorbis.c, mdct.c and ogg.c as the firmware
+does (same SRAM scratch and SDRAM table sizes, see playOGG) and reports the
+cycles each audio packet took against what the 50 MHz Cortex-M3 has for it.
+
+Cycles are read from the host time stamp counter, or are nanoseconds on hosts
+without one. The Cortex-M3 needs more cycles than a desktop CPU for the same
+code, and the ratio depends on both machines, so it has to be given: run
+"bench ogg <file>" on the board for the same file and pass its average cycles
+per packet divided by the host average printed here. Both time only
+vorbis_decode_packet and vorbis_read_pcm, so the ratio holds for other files.
+
+usage: vorbisbench <file.ogg> <scale> [repeats]
+
+Please see project readme for more details on licenses
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "vorbis.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CYCLE_UNIT "cycles"
+static uint64_t cycles(void)
+{
+    return __rdtsc();
+}
+#else
+#define CYCLE_UNIT "ns"
+static uint64_t cycles(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000 + t.tv_nsec;
+}
+#endif
+
+#define TARGET_CLOCK 50000000                   /* Cortex-M3 clock (Hz) */
+#define FAST_SIZE (32768 + 4608 * 8)            /* decoderScatchSize of the firmware */
+#define TABLE_SIZE (2 * 1024 * 1024)            /* decoderTableSize of the firmware */
+#define PCM_FRAMES 4096                         /* Frames in one wave buffer */
+
+typedef struct {
+    const uint8_t *data;
+    unsigned long size, position;
+} MemoryFile;
+
+static unsigned long memory_read(void *handle, void *buffer, unsigned long length)
+{
+    MemoryFile *f = handle;
+
+    if (length > f->size - f->position)
+        length = f->size - f->position;
+    memcpy(buffer, f->data + f->position, length);
+    f->position += length;
+    return length;
+}
+
+static VorbisContext vorbis;
+static uint8_t fast_memory[FAST_SIZE];
+static uint8_t table_memory[TABLE_SIZE];
+static uint16_t pcm[PCM_FRAMES * 2];
+
+int main(int argc, char **argv)
+{
+    MemoryFile file;
+    OggStream stream;
+    FILE *f;
+    uint8_t *data, *packet;
+    unsigned long length, packets = 0;
+    uint64_t start, packet_cycles, total_cycles = 0, max_cycles = 0, samples = 0;
+    double budget, long_budget, scale;
+    int repeats, repeat, i, frames;
+
+    if (argc < 3) {
+        fprintf(stderr, "usage: vorbisbench <file.ogg> <scale> [repeats]\n"
+                "scale is board cycles / host cycles per packet, from bench ogg on the board\n");
+        return 1;
+    }
+    scale = atof(argv[2]);
+    repeats = argc > 3 ? atoi(argv[3]) : 1;
+    if (scale <= 0 || repeats < 1) {
+        fprintf(stderr, "Bad scale or repeats\n");
+        return 1;
+    }
+
+    f = fopen(argv[1], "rb");
+    if (f == NULL) {
+        fprintf(stderr, "Cannot open: %s\n", argv[1]);
+        return 1;
+    }
+    fseek(f, 0, SEEK_END);
+    file.size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    data = malloc(file.size);
+    if (data == NULL || fread(data, 1, file.size, f) != file.size) {
+        fprintf(stderr, "Read failure\n");
+        return 1;
+    }
+    fclose(f);
+    file.data = data;
+
+    for (repeat = 0; repeat < repeats; repeat++) {
+        file.position = 0;
+        ogg_init(&stream, memory_read, &file, table_memory);
+        vorbis_init(&vorbis, fast_memory, FAST_SIZE, &table_memory[VORBIS_MAX_PACKET], TABLE_SIZE - VORBIS_MAX_PACKET);
+
+        for (i = 0; i < 3; i++) {
+            if (ogg_read_packet(&stream, &packet, &length) != 0 || vorbis_decode_header(&vorbis, packet, length) < 0) {
+                fprintf(stderr, "Bad Vorbis header %d\n", i);
+                return 1;
+            }
+        }
+
+        /* Times the same span as bench ogg: decode and PCM conversion, not the file reads */
+        for (;;) {
+            if (ogg_read_packet(&stream, &packet, &length) != 0)
+                break;
+            start = cycles();
+            if (vorbis_decode_packet(&vorbis, packet, length) < 0)
+                continue;
+            while ((frames = vorbis_read_pcm(&vorbis, pcm, PCM_FRAMES)) > 0)
+                samples += frames;
+            packet_cycles = cycles() - start;
+
+            total_cycles += packet_cycles;
+            if (packet_cycles > max_cycles)
+                max_cycles = packet_cycles;
+            packets++;
+        }
+    }
+
+    if (packets == 0 || samples == 0) {
+        fprintf(stderr, "No audio packets\n");
+        return 1;
+    }
+
+    /* Cycles the target has for the audio of an average packet and of a long block packet */
+    budget = (double)samples / vorbis.samplerate * TARGET_CLOCK / packets;
+    long_budget = (double)vorbis.blocksize[1] / 2 / vorbis.samplerate * TARGET_CLOCK;
+
+    printf("%s: %d channels, %lu Hz, blocksizes %d/%d\n", argv[1], vorbis.channels, vorbis.samplerate,
+           vorbis.blocksize[0], vorbis.blocksize[1]);
+    printf("memory: %lu of %d bytes SRAM scratch, %lu of %d bytes SDRAM tables\n", vorbis.fast_used, FAST_SIZE,
+           vorbis.table_used + VORBIS_MAX_PACKET, TABLE_SIZE);
+    printf("%lu packets, %llu samples\n", packets, (unsigned long long)samples);
+    printf("%-24s %12s %12s\n", "per packet", "average", "worst");
+    printf("%-24s %12.0f %12.0f\n", "host " CYCLE_UNIT, (double)total_cycles / packets, (double)max_cycles);
+    printf("%-24s %12.0f %12.0f\n", "scaled", scale * total_cycles / packets, scale * max_cycles);
+    printf("%-24s %12.0f %12.0f\n", "50 MHz budget", budget, long_budget);
+    printf("%.1f%% of the 50 MHz budget (scale %.2f)\n", 100.0 * scale * total_cycles / packets / budget, scale);
+    return 0;
+}
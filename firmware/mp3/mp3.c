@@ -0,0 +1,987 @@
+/*
+Integer MPEG audio Layer III decoder for openHiFi
+
+Copyright (C) 2011 teho Labs/B. A. Bryce
+
+Side information, bit reservoir, scalefactors, Huffman decoding, requantization,
+MS and intensity stereo, alias reduction, the IMDCT and the polyphase synthesis.
+Spectrum and subband values are MP3_SPECTRUM_SHIFT fixed point, the cosine and
+window tables Q31. The products are 64 bits wide, on the Cortex-M3 they are one
+SMULL or SMLAL each.
+
+Please see project readme for more details on licenses
+*/
+
+#include <string.h>
+#include "mp3.h"
+
+static const unsigned short bitrates[2][15] = {
+    {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320},    /* MPEG-1 */
+    {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160}          /* MPEG-2 and 2.5 */
+};
+
+static const unsigned short samplerates[3] = {44100, 48000, 32000};
+
+/* (x * y) >> 31 with y Q31 */
+static inline int32_t MULT31(int32_t x, int32_t y)
+{
+#if defined(__arm__) && defined(__thumb2__)
+    uint32_t lo;
+    int32_t hi;
+
+    __asm__ ("smull %0, %1, %2, %3" : "=&r" (lo), "=&r" (hi) : "r" (x), "r" (y));
+    return (hi << 1) | (lo >> 31);
+#else
+    return (int32_t)(((int64_t)x * y) >> 31);
+#endif
+}
+
+/* sum + x * y in 64 bits */
+static inline int64_t MLA64(int64_t sum, int32_t x, int32_t y)
+{
+#if defined(__arm__) && defined(__thumb2__)
+    uint32_t lo = (uint32_t)sum;
+    int32_t hi = (int32_t)(sum >> 32);
+
+    __asm__ ("smlal %0, %1, %2, %3" : "+r" (lo), "+r" (hi) : "r" (x), "r" (y));
+    return (int64_t)((uint64_t)(uint32_t)hi << 32 | lo);
+#else
+    return sum + (int64_t)x * y;
+#endif
+}
+
+/* Bit reader, MPEG audio packs MSB first. Up to 25 bits are read at a time and
+   the buffer has to have 4 readable bytes after the last bit used. */
+typedef struct Mp3Bits {
+    const uint8_t *buffer;
+    unsigned long position;         /* bits */
+} Mp3Bits;
+
+static inline uint32_t peek_bits(Mp3Bits *b, int n)
+{
+    const uint8_t *p = b->buffer + (b->position >> 3);
+    uint32_t v = (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+
+    return (v << (b->position & 7)) >> (32 - n);
+}
+
+static inline uint32_t get_bits(Mp3Bits *b, int n)
+{
+    uint32_t v;
+
+    if (n == 0)
+        return 0;
+    v = peek_bits(b, n);
+    b->position += n;
+    return v;
+}
+
+/* Decodes one Huffman code with the tables of mp3tab.c */
+static inline int huffman_decode(Mp3Bits *b, const Mp3Huffman *h)
+{
+    const uint16_t *table = h->table;
+    int bits = h->bits;
+    uint32_t e = table[peek_bits(b, bits)];
+
+    while (e & 0x8000) {
+        b->position += bits;
+        bits = (e >> 12) & 7;
+        e = table[(e & 0x0fff) + peek_bits(b, bits)];
+    }
+    b->position += e >> 8;
+    return e & 0xff;
+}
+
+static void *fast_alloc(Mp3Context *m, unsigned long size)
+{
+    void *p;
+
+    size = (size + 3) & ~3UL;
+    if (m->fast_used + size > m->fast_size)
+        return NULL;
+    p = m->fast_memory + m->fast_used;
+    m->fast_used += size;
+    return p;
+}
+
+/* floor(cbrt(x)) */
+static uint32_t icbrt(uint64_t x)
+{
+    uint64_t y = 0;
+    int s;
+
+    for (s = 63; s >= 0; s -= 3) {
+        y <<= 1;
+        if ((x >> s) >= 3 * y * (y + 1) + 1) {
+            x -= (3 * y * (y + 1) + 1) << s;
+            y++;
+        }
+    }
+    return (uint32_t)y;
+}
+
+int mp3_init(Mp3Context *m, void *fast_memory, unsigned long fast_size)
+{
+    int ch, i;
+
+    m->fast_memory = fast_memory;
+    m->fast_size = fast_size;
+    m->fast_used = 0;
+
+    m->main_data = fast_alloc(m, MP3_MAIN_DATA_SIZE + 4);
+    for (ch = 0; ch < MP3_MAX_CHANNELS; ch++) {
+        m->xr[ch] = fast_alloc(m, 576 * sizeof(int32_t));
+        m->overlap[ch] = fast_alloc(m, 576 * sizeof(int32_t));
+        m->synth[ch] = fast_alloc(m, 1024 * sizeof(int32_t));
+    }
+    m->work = fast_alloc(m, 576 * sizeof(int32_t));
+    m->window = fast_alloc(m, 512 * sizeof(int32_t));
+    m->pow43 = fast_alloc(m, MP3_POW43_SIZE * sizeof(uint32_t));
+    m->pcm = fast_alloc(m, 2 * MP3_MAX_SAMPLES * sizeof(uint16_t));
+    if (m->pcm == NULL)
+        return -1;
+
+    /* i^(4/3) = i cbrt(i), in Q17 from the cube root of i * 2^51 */
+    for (i = 0; i < MP3_POW43_SIZE; i++)
+        m->pow43[i] = i * icbrt((uint64_t)i << 51);
+
+    /* D[i] for i > 256 mirrors D[512 - i], the sign changes every 64 taps */
+    for (i = 0; i < 512; i++) {
+        m->window[i] = mp3_synth_window[i <= 256 ? i : 512 - i];
+        if ((i >> 6) & 1)
+            m->window[i] = -m->window[i];
+    }
+
+    for (ch = 0; ch < MP3_MAX_CHANNELS; ch++) {
+        memset(m->overlap[ch], 0, 576 * sizeof(int32_t));
+        memset(m->synth[ch], 0, 1024 * sizeof(int32_t));
+    }
+    memset(m->main_data, 0, MP3_MAIN_DATA_SIZE + 4);
+    m->main_data_size = 0;
+    m->synth_block = 0;
+    m->output_frames = 0;
+    m->output_index = 0;
+    return 0;
+}
+
+/* Frame header and side information, returns the side information length or -1 */
+static int read_side_info(Mp3Context *m, const uint8_t *frame, unsigned long length, int *frame_length)
+{
+    Mp3Bits b;
+    Mp3Granule *g;
+    int version, bitrate, rate, padding, protection, side_length;
+    int gr, ch, i;
+
+    if (length < 4 || frame[0] != 0xff || (frame[1] & 0xe0) != 0xe0)
+        return -1;
+
+    version = (frame[1] >> 3) & 3;          /* 0 MPEG-2.5, 1 reserved, 2 MPEG-2, 3 MPEG-1 */
+    bitrate = frame[2] >> 4;
+    rate = (frame[2] >> 2) & 3;
+    if (version == 1 || ((frame[1] >> 1) & 3) != 1 || bitrate == 0 || bitrate == 15 || rate == 3)
+        return -1;
+
+    protection = !(frame[1] & 1);
+    padding = (frame[2] >> 1) & 1;
+    m->version = version == 3 ? 1 : version == 2 ? 2 : 25;
+    m->mode = frame[3] >> 6;
+    m->mode_extension = (frame[3] >> 4) & 3;
+    m->channels = m->mode == 3 ? 1 : 2;
+    m->samplerate = samplerates[rate] >> (version == 3 ? 0 : version == 2 ? 1 : 2);
+    m->sfb = version == 3 ? rate : version == 2 ? 3 + rate : 6 + rate;
+    m->granules = version == 3 ? 2 : 1;
+
+    if (version == 3) {
+        *frame_length = 144000 * bitrates[0][bitrate] / m->samplerate + padding;
+        side_length = m->channels == 1 ? 17 : 32;
+    } else {
+        *frame_length = 72000 * bitrates[1][bitrate] / m->samplerate + padding;
+        side_length = m->channels == 1 ? 9 : 17;
+    }
+    if (length < (unsigned long)(4 + 2 * protection + side_length))
+        return -1;
+
+    b.buffer = frame + 4 + 2 * protection;
+    b.position = 0;
+
+    if (m->version == 1) {
+        m->main_data_begin = get_bits(&b, 9);
+        get_bits(&b, m->channels == 1 ? 5 : 3);
+        for (ch = 0; ch < m->channels; ch++)
+            m->scfsi[ch] = get_bits(&b, 4);
+    } else {
+        m->main_data_begin = get_bits(&b, 8);
+        get_bits(&b, m->channels == 1 ? 1 : 2);
+        m->scfsi[0] = m->scfsi[1] = 0;
+    }
+
+    for (gr = 0; gr < m->granules; gr++) {
+        for (ch = 0; ch < m->channels; ch++) {
+            g = &m->granule[gr][ch];
+            g->part2_3_length = get_bits(&b, 12);
+            g->big_values = get_bits(&b, 9);
+            g->global_gain = get_bits(&b, 8);
+            g->scalefac_compress = get_bits(&b, m->version == 1 ? 4 : 9);
+            if (g->big_values > 288)
+                return -1;
+
+            if (get_bits(&b, 1)) {
+                /* Window switching, the regions are implicit */
+                g->block_type = get_bits(&b, 2);
+                g->mixed_block = get_bits(&b, 1);
+                for (i = 0; i < 2; i++)
+                    g->table_select[i] = get_bits(&b, 5);
+                g->table_select[2] = 0;
+                for (i = 0; i < 3; i++)
+                    g->subblock_gain[i] = get_bits(&b, 3);
+                if (g->block_type == 0)
+                    return -1;
+
+                if (g->block_type == 2 && !g->mixed_block)
+                    g->region1_start = 3 * mp3_sfb_short[m->sfb][3];
+                else
+                    g->region1_start = mp3_sfb_long[m->sfb][8];
+                g->region2_start = 576;
+            } else {
+                int region0_count, region1_count;
+
+                g->block_type = 0;
+                g->mixed_block = 0;
+                for (i = 0; i < 3; i++)
+                    g->table_select[i] = get_bits(&b, 5);
+                g->subblock_gain[0] = g->subblock_gain[1] = g->subblock_gain[2] = 0;
+                region0_count = get_bits(&b, 4);
+                region1_count = get_bits(&b, 3);
+
+                g->region1_start = mp3_sfb_long[m->sfb][region0_count + 1];
+                i = region0_count + region1_count + 2;
+                g->region2_start = mp3_sfb_long[m->sfb][i > 22 ? 22 : i];
+            }
+
+            /* MPEG-2 takes preflag from scalefac_compress (see read_scalefactors_lsf) */
+            g->preflag = m->version == 1 ? get_bits(&b, 1) : 0;
+            g->scalefac_scale = get_bits(&b, 1);
+            g->count1_table = get_bits(&b, 1);
+        }
+    }
+
+    return 4 + 2 * protection + side_length;
+}
+
+static void read_scalefactors(Mp3Context *m, Mp3Bits *b, int gr, int ch)
+{
+    Mp3Granule *g = &m->granule[gr][ch];
+    uint8_t *l = m->scalefac_l[ch];
+    uint8_t (*s)[3] = m->scalefac_s[ch];
+    int slen1 = mp3_slen[0][g->scalefac_compress];
+    int slen2 = mp3_slen[1][g->scalefac_compress];
+    int sfb, w;
+
+    if (g->block_type == 2) {
+        sfb = 0;
+        if (g->mixed_block) {
+            for (; sfb < 8; sfb++)
+                l[sfb] = get_bits(b, slen1);
+            sfb = 3;
+        }
+        for (; sfb < 6; sfb++)
+            for (w = 0; w < 3; w++)
+                s[sfb][w] = get_bits(b, slen1);
+        for (; sfb < 12; sfb++)
+            for (w = 0; w < 3; w++)
+                s[sfb][w] = get_bits(b, slen2);
+        s[12][0] = s[12][1] = s[12][2] = 0;
+        return;
+    }
+
+    /* scfsi bits reuse the bands 0-5, 6-10, 11-15 and 16-20 of the first granule */
+    if (gr == 0 || !(m->scfsi[ch] & 8))
+        for (sfb = 0; sfb < 6; sfb++)
+            l[sfb] = get_bits(b, slen1);
+    if (gr == 0 || !(m->scfsi[ch] & 4))
+        for (sfb = 6; sfb < 11; sfb++)
+            l[sfb] = get_bits(b, slen1);
+    if (gr == 0 || !(m->scfsi[ch] & 2))
+        for (sfb = 11; sfb < 16; sfb++)
+            l[sfb] = get_bits(b, slen2);
+    if (gr == 0 || !(m->scfsi[ch] & 1))
+        for (sfb = 16; sfb < 21; sfb++)
+            l[sfb] = get_bits(b, slen2);
+    l[21] = 0;
+}
+
+/* MPEG-2 scalefactors, the right channel of intensity stereo has its own slen partitions */
+static void read_scalefactors_lsf(Mp3Context *m, Mp3Bits *b, int ch)
+{
+    Mp3Granule *g = &m->granule[0][ch];
+    uint8_t *l = m->scalefac_l[ch];
+    uint8_t (*s)[3] = m->scalefac_s[ch];
+    int intensity = ch == 1 && (m->mode_extension & 1) && m->mode == 1;
+    int sfc = g->scalefac_compress;
+    int slen[4], table, blocks, part, n, i, value, sfb, w, index;
+
+    if (intensity) {
+        sfc >>= 1;
+        if (sfc < 180) {
+            slen[0] = sfc / 36;
+            slen[1] = (sfc % 36) / 6;
+            slen[2] = sfc % 6;
+            slen[3] = 0;
+            table = 3;
+        } else if (sfc < 244) {
+            sfc -= 180;
+            slen[0] = (sfc & 63) >> 4;
+            slen[1] = (sfc & 15) >> 2;
+            slen[2] = sfc & 3;
+            slen[3] = 0;
+            table = 4;
+        } else {
+            sfc -= 244;
+            slen[0] = sfc / 3;
+            slen[1] = sfc % 3;
+            slen[2] = slen[3] = 0;
+            table = 5;
+        }
+    } else if (sfc < 400) {
+        slen[0] = (sfc >> 4) / 5;
+        slen[1] = (sfc >> 4) % 5;
+        slen[2] = (sfc & 15) >> 2;
+        slen[3] = sfc & 3;
+        table = 0;
+    } else if (sfc < 500) {
+        sfc -= 400;
+        slen[0] = (sfc >> 2) / 5;
+        slen[1] = (sfc >> 2) % 5;
+        slen[2] = sfc & 3;
+        slen[3] = 0;
+        table = 1;
+    } else {
+        sfc -= 500;
+        slen[0] = sfc / 3;
+        slen[1] = sfc % 3;
+        slen[2] = slen[3] = 0;
+        g->preflag = 1;
+        table = 2;
+    }
+
+    blocks = g->block_type != 2 ? 0 : g->mixed_block ? 2 : 1;
+
+    /* Scalefactors come long bands first (mixed blocks have 6), then short bands three windows each */
+    index = 0;
+    for (part = 0; part < 4; part++) {
+        n = mp3_lsf_nsfb[table][blocks][part];
+        for (i = 0; i < n; i++, index++) {
+            value = get_bits(b, slen[part]);
+            if (blocks == 0 || (blocks == 2 && index < 6)) {
+                l[index] = value;
+                if (intensity)
+                    m->illegal_l[index] = (1 << slen[part]) - 1;
+            } else {
+                sfb = blocks == 2 ? (index - 6) / 3 + 3 : index / 3;
+                w = blocks == 2 ? (index - 6) % 3 : index % 3;
+                s[sfb][w] = value;
+                if (intensity)
+                    m->illegal_s[sfb] = (1 << slen[part]) - 1;
+            }
+        }
+    }
+
+    /* Bands past the transmitted ones are 0, the top band takes the intensity position of the one below */
+    if (blocks == 0) {
+        for (; index < 22; index++) {
+            l[index] = 0;
+            m->illegal_l[index] = m->illegal_l[index - 1];
+        }
+    } else {
+        sfb = blocks == 2 ? (index - 6) / 3 + 3 : index / 3;
+        for (; sfb < 13; sfb++) {
+            s[sfb][0] = s[sfb][1] = s[sfb][2] = 0;
+            m->illegal_s[sfb] = m->illegal_s[sfb - 1];
+        }
+    }
+}
+
+/* Huffman decodes the spectrum of one channel into xr as integers, returns the lines decoded */
+static int ICODE_ATTR_MP3 read_huffman(Mp3Context *m, Mp3Bits *b, Mp3Granule *g, int32_t *xr, unsigned long end)
+{
+    const Mp3Huffman *h;
+    int big_end = g->big_values * 2;
+    int region_end, region, i, x, y, linbits, value;
+    unsigned long last;
+
+    if (big_end > 576)
+        big_end = 576;
+
+    i = 0;
+    for (region = 0; region < 3 && i < big_end; region++) {
+        region_end = region == 0 ? g->region1_start : region == 1 ? g->region2_start : 576;
+        if (region_end > big_end)
+            region_end = big_end;
+
+        h = &mp3_huffman[g->table_select[region]];
+        if (h->table == NULL) {
+            for (; i < region_end; i++)
+                xr[i] = 0;
+            continue;
+        }
+
+        linbits = h->linbits;
+        for (; i < region_end; i += 2) {
+            value = huffman_decode(b, h);
+            x = value >> 4;
+            y = value & 15;
+
+            if (x == 15 && linbits)
+                x += get_bits(b, linbits);
+            if (x && get_bits(b, 1))
+                x = -x;
+            if (y == 15 && linbits)
+                y += get_bits(b, linbits);
+            if (y && get_bits(b, 1))
+                y = -y;
+
+            xr[i] = x;
+            xr[i + 1] = y;
+        }
+    }
+
+    /* Quadruples of -1, 0 and 1 until the part2_3 bits run out, one that goes past the end is dropped */
+    h = &mp3_count1[g->count1_table];
+    while (i + 4 <= 576 && b->position < end) {
+        last = b->position;
+        value = huffman_decode(b, h);
+        for (x = 0; x < 4; x++) {
+            y = (value >> (3 - x)) & 1;
+            if (y && get_bits(b, 1))
+                y = -1;
+            xr[i + x] = y;
+        }
+        if (b->position > end) {
+            b->position = last;
+            xr[i] = xr[i + 1] = xr[i + 2] = xr[i + 3] = 0;
+            break;
+        }
+        i += 4;
+    }
+
+    /* The last line that is not zero */
+    while (i > 0 && xr[i - 1] == 0)
+        i--;
+    memset(&xr[i], 0, (576 - i) * sizeof(int32_t));
+    return i;
+}
+
+/* xr[i] = sign(is) |is|^(4/3) 2^(exponent/4), exponent in quarter steps */
+static void requantize(Mp3Context *m, int32_t *xr, int count, int exponent)
+{
+    int32_t root = mp3_root4[exponent & 3];
+    int shift = (exponent >> 2) + MP3_SPECTRUM_SHIFT - 16;
+    int i, extra, s;
+    int32_t is, magnitude, value;
+    uint32_t index, p;
+
+    for (i = 0; i < count; i++) {
+        is = xr[i];
+        if (is == 0)
+            continue;
+        index = is < 0 ? -is : is;
+
+        /* Above the table (i >> 3)^(4/3) is interpolated, 8^(4/3) = 16 */
+        extra = 0;
+        if (index < MP3_POW43_SIZE) {
+            p = m->pow43[index];
+        } else {
+            p = m->pow43[index >> 3] + (((m->pow43[(index >> 3) + 1] - m->pow43[index >> 3]) * (index & 7)) >> 3);
+            extra = 4;
+        }
+
+        /* Q17 times 2^(r/4) / 2 is Q16 */
+        magnitude = (int32_t)(((uint64_t)p * (uint32_t)root) >> 31);
+        s = shift + extra;
+        if (s >= 0) {
+            if (s > 30 || magnitude > (0x7fffffff >> s))
+                value = 0x7fffffff;
+            else
+                value = magnitude << s;
+        } else {
+            value = s < -31 ? 0 : magnitude >> -s;
+        }
+        xr[i] = is < 0 ? -value : value;
+    }
+}
+
+/* Scales the lines of one channel by global gain, subblock gain and scalefactors */
+static void ICODE_ATTR_MP3 dequantize(Mp3Context *m, Mp3Granule *g, int ch)
+{
+    const uint16_t *long_bands = mp3_sfb_long[m->sfb];
+    const uint16_t *short_bands = mp3_sfb_short[m->sfb];
+    int32_t *xr = m->xr[ch];
+    int nonzero = m->nonzero[ch];
+    int shift = g->scalefac_scale + 1;
+    int gain = g->global_gain - 210;
+    int sfb, w, start, end, width, long_end;
+
+    long_end = g->block_type != 2 ? 576 : g->mixed_block ? 36 : 0;
+
+    for (sfb = 0; sfb < 22 && long_bands[sfb] < long_end && long_bands[sfb] < nonzero; sfb++) {
+        start = long_bands[sfb];
+        end = long_bands[sfb + 1];
+        if (end > nonzero)
+            end = nonzero;
+        requantize(m, &xr[start], end - start,
+                   gain - ((m->scalefac_l[ch][sfb] + (g->preflag ? mp3_pretab[sfb] : 0)) << shift));
+    }
+
+    if (long_end == 576)
+        return;
+
+    for (sfb = g->mixed_block ? 3 : 0; sfb < 13; sfb++) {
+        width = short_bands[sfb + 1] - short_bands[sfb];
+        for (w = 0; w < 3; w++) {
+            start = 3 * short_bands[sfb] + w * width;
+            if (start >= nonzero)
+                return;
+            end = start + width > nonzero ? nonzero : start + width;
+            requantize(m, &xr[start], end - start,
+                       gain - 8 * g->subblock_gain[w] - (m->scalefac_s[ch][sfb][w] << shift));
+        }
+    }
+}
+
+/* Intensity stereo of one band, the right channel is made from the left one */
+static void intensity_band(Mp3Context *m, Mp3Granule *g, int start, int count, int position)
+{
+    int32_t *left = m->xr[0];
+    int32_t *right = m->xr[1];
+    int32_t kl, kr;
+    int i;
+
+    if (m->version == 1) {
+        kl = mp3_is_ratio[position][0];
+        kr = mp3_is_ratio[position][1];
+    } else {
+        /* Odd positions turn down the left channel, even ones the right */
+        const int32_t *gains = mp3_lsf_is[g->scalefac_compress & 1];
+
+        kl = position & 1 ? gains[(position + 1) >> 1] : 0x7fffffff;
+        kr = position & 1 ? 0x7fffffff : gains[position >> 1];
+    }
+
+    for (i = start; i < start + count; i++) {
+        right[i] = MULT31(left[i], kr);
+        left[i] = MULT31(left[i], kl);
+    }
+}
+
+static void ms_band(Mp3Context *m, int start, int count)
+{
+    int32_t *left = m->xr[0];
+    int32_t *right = m->xr[1];
+    int32_t mid, side;
+    int i;
+
+    for (i = start; i < start + count; i++) {
+        mid = left[i];
+        side = right[i];
+        left[i] = MULT31(mid + side, 1518500250);      /* 1/sqrt(2) */
+        right[i] = MULT31(mid - side, 1518500250);
+    }
+}
+
+/* The highest band of the right channel with a line that is not zero, -1 if there is none */
+static int last_band(const int32_t *xr, const uint16_t *bands, int first, int last, int step, int offset)
+{
+    int sfb, i, width;
+
+    for (sfb = last; sfb >= first; sfb--) {
+        width = bands[sfb + 1] - bands[sfb];
+        for (i = 0; i < width; i++)
+            if (xr[step * bands[sfb] + offset * width + i])
+                return sfb;
+    }
+    return -1;
+}
+
+/* MS and intensity stereo of a joint stereo granule. Bands above the last coded line of the
+   right channel are intensity coded unless their position is the illegal one, MS or nothing
+   is used for the others */
+static void stereo(Mp3Context *m, Mp3Granule *g)
+{
+    const uint16_t *long_bands = mp3_sfb_long[m->sfb];
+    const uint16_t *short_bands = mp3_sfb_short[m->sfb];
+    int ms = m->mode_extension & 2;
+    int nonzero = m->nonzero[0] > m->nonzero[1] ? m->nonzero[0] : m->nonzero[1];
+    int long_end, short_start, long_bound, short_bound[3], coded;
+    int sfb, w, width, start, position, illegal;
+
+    m->nonzero[0] = m->nonzero[1] = nonzero;
+    if (!(m->mode_extension & 1)) {
+        if (ms)
+            ms_band(m, 0, nonzero);
+        return;
+    }
+
+    /* Long bands end at 576 or at the mixed block boundary (36 lines), short bands start there */
+    long_end = g->block_type != 2 ? 22 : g->mixed_block ? (m->version == 1 ? 8 : 6) : 0;
+    short_start = g->block_type != 2 ? 13 : g->mixed_block ? 3 : 0;
+
+    /* Each short window has its own bound, the long bands of a mixed block are only
+       intensity coded when no short window has coded lines */
+    coded = 0;
+    for (w = 0; w < 3; w++) {
+        short_bound[w] = last_band(m->xr[1], short_bands, short_start, 12, 3, w) + 1;
+        if (short_bound[w] > short_start)
+            coded = 1;
+        else
+            short_bound[w] = short_start;
+    }
+    long_bound = coded ? long_end : last_band(m->xr[1], long_bands, 0, long_end - 1, 1, 0) + 1;
+
+    for (sfb = 0; sfb < long_end; sfb++) {
+        start = long_bands[sfb];
+        width = long_bands[sfb + 1] - start;
+        position = m->scalefac_l[1][sfb < 21 ? sfb : 20];
+        illegal = m->version == 1 ? 7 : m->illegal_l[sfb];
+        if (sfb >= long_bound && position != illegal)
+            intensity_band(m, g, start, width, position);
+        else if (ms)
+            ms_band(m, start, width);
+    }
+
+    for (sfb = short_start; sfb < 13; sfb++) {
+        width = short_bands[sfb + 1] - short_bands[sfb];
+        for (w = 0; w < 3; w++) {
+            start = 3 * short_bands[sfb] + w * width;
+            position = m->scalefac_s[1][sfb < 12 ? sfb : 11][w];
+            illegal = m->version == 1 ? 7 : m->illegal_s[sfb];
+            if (sfb >= short_bound[w] && position != illegal)
+                intensity_band(m, g, start, width, position);
+            else if (ms)
+                ms_band(m, start, width);
+        }
+    }
+
+    m->nonzero[0] = m->nonzero[1] = 576;
+}
+
+/* Short block lines come band by band, window by window. They are put in subband order,
+   the 6 lines of each window of a subband together */
+static void reorder(Mp3Context *m, Mp3Granule *g, int ch)
+{
+    const uint16_t *bands = mp3_sfb_short[m->sfb];
+    int32_t *xr = m->xr[ch];
+    int32_t *work = m->work;
+    int sfb = g->mixed_block ? 3 : 0;
+    int first = 3 * bands[sfb];
+    int last, top, width, w, f, j;
+
+    for (last = sfb; last < 13 && 3 * bands[last] < m->nonzero[ch]; last++)
+        ;
+    top = 18 * ((bands[last] + 5) / 6);
+    if (top <= first)
+        return;
+
+    memset(&work[first], 0, (top - first) * sizeof(int32_t));
+    for (; sfb < last; sfb++) {
+        width = bands[sfb + 1] - bands[sfb];
+        for (w = 0; w < 3; w++) {
+            for (f = 0; f < width; f++) {
+                j = bands[sfb] + f;
+                work[(j / 6) * 18 + w * 6 + j % 6] = xr[3 * bands[sfb] + w * width + f];
+            }
+        }
+    }
+    memcpy(&xr[first], &work[first], (top - first) * sizeof(int32_t));
+    m->nonzero[ch] = top;
+}
+
+/* Butterflies across the subband boundaries of long blocks */
+static void alias_reduce(Mp3Context *m, Mp3Granule *g, int ch)
+{
+    int32_t *xr = m->xr[ch];
+    int32_t up, down;
+    int limit, sb, i;
+
+    if (g->block_type == 2 && !g->mixed_block)
+        return;
+
+    limit = g->block_type == 2 ? 2 : (m->nonzero[ch] + 7) / 18 + 1;
+    if (limit > 32)
+        limit = 32;
+
+    for (sb = 1; sb < limit; sb++) {
+        for (i = 0; i < 8; i++) {
+            up = xr[18 * sb - 1 - i];
+            down = xr[18 * sb + i];
+            xr[18 * sb - 1 - i] = MULT31(up, mp3_alias[i][0]) - MULT31(down, mp3_alias[i][1]);
+            xr[18 * sb + i] = MULT31(down, mp3_alias[i][0]) + MULT31(up, mp3_alias[i][1]);
+        }
+    }
+
+    if (m->nonzero[ch] + 8 < 576)
+        m->nonzero[ch] += 8;
+    else
+        m->nonzero[ch] = 576;
+}
+
+/* 36 point IMDCT of one subband, windowed and overlapped with the previous granule.
+   x[17 - i] = -x[i] and x[35 - i] = x[18 + i], so 18 outputs are computed */
+static void ICODE_ATTR_MP3 imdct36(const int32_t *in, int32_t *out, int32_t *previous, const int32_t *window)
+{
+    int32_t a[18];
+    int32_t x;
+    int64_t sum;
+    int i, k;
+
+    for (i = 0; i < 18; i++) {
+        sum = 0;
+        for (k = 0; k < 18; k++)
+            sum = MLA64(sum, in[k], mp3_imdct36[i][k]);
+        a[i] = (int32_t)(sum >> 31);
+    }
+
+    for (i = 0; i < 18; i++) {
+        x = i < 9 ? a[i] : -a[17 - i];
+        out[32 * i] = previous[i] + MULT31(x, window[i]);
+        x = i < 9 ? a[9 + i] : a[26 - i];
+        previous[i] = MULT31(x, window[18 + i]);
+    }
+}
+
+/* Three 12 point IMDCTs of one subband, the windows overlap at 6, 12 and 18 */
+static void ICODE_ATTR_MP3 imdct12(const int32_t *in, int32_t *out, int32_t *previous)
+{
+    int32_t z[36];
+    int32_t b[6];
+    int32_t y;
+    int64_t sum;
+    int w, i, k;
+
+    memset(z, 0, sizeof(z));
+    for (w = 0; w < 3; w++) {
+        for (i = 0; i < 6; i++) {
+            sum = 0;
+            for (k = 0; k < 6; k++)
+                sum = MLA64(sum, in[6 * w + k], mp3_imdct12[i][k]);
+            b[i] = (int32_t)(sum >> 31);
+        }
+        for (i = 0; i < 12; i++) {
+            y = i < 3 ? b[i] : i < 6 ? -b[5 - i] : i < 9 ? b[i - 3] : b[14 - i];
+            z[6 + 6 * w + i] += MULT31(y, mp3_window[2][i]);
+        }
+    }
+
+    for (i = 0; i < 18; i++) {
+        out[32 * i] = previous[i] + z[i];
+        previous[i] = z[18 + i];
+    }
+}
+
+/* IMDCT and overlap of every subband into work, 18 time slots of 32 subband samples */
+static void ICODE_ATTR_MP3 hybrid(Mp3Context *m, Mp3Granule *g, int ch)
+{
+    int32_t *xr = m->xr[ch];
+    int32_t *previous = m->overlap[ch];
+    int32_t *out = m->work;
+    int limit = (m->nonzero[ch] + 17) / 18;
+    int sb, t;
+
+    for (sb = 0; sb < 32; sb++, previous += 18) {
+        if (sb >= limit) {
+            for (t = 0; t < 18; t++) {
+                out[32 * t + sb] = previous[t];
+                previous[t] = 0;
+            }
+        } else if (g->block_type == 2 && (sb >= 2 || !g->mixed_block)) {
+            imdct12(&xr[18 * sb], &out[sb], previous);
+        } else {
+            imdct36(&xr[18 * sb], &out[sb], previous, mp3_window[g->mixed_block ? 0 : g->block_type]);
+        }
+
+        /* Odd subbands are frequency inverted */
+        if (sb & 1)
+            for (t = 1; t < 18; t += 2)
+                out[32 * t + sb] = -out[32 * t + sb];
+    }
+}
+
+/* In place DCT-II of n values, x[k] = sum x[i] cos(pi k (2i + 1) / 2n). The odd outputs
+   are a DCT-IV of the differences of mirrored inputs, the even ones a DCT-II of the sums */
+static void ICODE_ATTR_MP3 dct_ii(int32_t *x, int n)
+{
+    int32_t sums[16], differences[16];
+    const int32_t *c;
+    int64_t sum;
+    int h = n >> 1;
+    int i, k;
+
+    if (n == 2) {
+        sums[0] = x[0] + x[1];
+        x[1] = MULT31(x[0] - x[1], 1518500250);
+        x[0] = sums[0];
+        return;
+    }
+
+    for (i = 0; i < h; i++) {
+        sums[i] = x[i] + x[n - 1 - i];
+        differences[i] = x[i] - x[n - 1 - i];
+    }
+
+    c = h == 16 ? mp3_dct4_16 : h == 8 ? mp3_dct4_8 : h == 4 ? mp3_dct4_4 : mp3_dct4_2;
+    for (k = 0; k < h; k++, c += h) {
+        sum = 0;
+        for (i = 0; i < h; i++)
+            sum = MLA64(sum, differences[i], c[i]);
+        x[2 * k + 1] = (int32_t)(sum >> 31);
+    }
+
+    dct_ii(sums, h);
+    for (k = 0; k < h; k++)
+        x[2 * k] = sums[k];
+}
+
+/* Polyphase synthesis of 32 subband samples into 32 PCM samples (every other uint16).
+   V is a DCT-II of the samples, block is its place in the FIFO of 16 */
+static void ICODE_ATTR_MP3 synthesis(Mp3Context *m, int ch, const int32_t *samples, int block, uint16_t *pcm)
+{
+    const int32_t *window = m->window;
+    const int32_t *taps[16];
+    int32_t *v = m->synth[ch] + 64 * block;
+    int32_t x[32];
+    int64_t sum;
+    int32_t sample;
+    int i, j;
+
+    memcpy(x, samples, sizeof(x));
+    dct_ii(x, 32);
+
+    for (i = 0; i < 16; i++)
+        v[i] = x[16 + i];
+    v[16] = 0;
+    for (i = 17; i < 48; i++)
+        v[i] = -x[48 - i];
+    for (i = 48; i < 64; i++)
+        v[i] = -x[i - 48];
+
+    /* Tap i uses the first half of an even block and the second half of an odd one */
+    for (i = 0; i < 16; i++)
+        taps[i] = m->synth[ch] + 64 * ((block + i) & 15) + (i & 1 ? 32 : 0);
+
+    for (j = 0; j < 32; j++) {
+        sum = 0;
+        for (i = 0; i < 16; i++)
+            sum = MLA64(sum, taps[i][j], window[32 * i + j]);
+
+        /* MP3_SPECTRUM_SHIFT + 16 fraction bits to 15 */
+        sample = (int32_t)((sum + (1 << (MP3_SPECTRUM_SHIFT))) >> (MP3_SPECTRUM_SHIFT + 1));
+        if (sample > 32767)
+            sample = 32767;
+        else if (sample < -32768)
+            sample = -32768;
+        pcm[2 * j] = (uint16_t)sample;
+    }
+}
+
+/* Decodes one whole frame (header included), returns 0 or -1 when it can not be decoded.
+   A frame whose bit reservoir reaches back before the frames decoded so far gives no PCM */
+int ICODE_ATTR_MP3 mp3_decode_frame(Mp3Context *m, const uint8_t *frame, unsigned long length)
+{
+    Mp3Bits b;
+    Mp3Granule *g;
+    int side_length, frame_length, main_length, keep, bits;
+    int gr, ch, t;
+    unsigned long end;
+
+    m->output_frames = 0;
+    m->output_index = 0;
+
+    side_length = read_side_info(m, frame, length, &frame_length);
+    if (side_length < 0 || (unsigned long)frame_length > length || frame_length < side_length)
+        return -1;
+    main_length = frame_length - side_length;
+
+    /* The end of the reservoir is kept and the main data of this frame put after it */
+    keep = m->main_data_size < 511 ? m->main_data_size : 511;
+    memmove(m->main_data, m->main_data + m->main_data_size - keep, keep);
+    if (main_length > MP3_MAIN_DATA_SIZE - keep)
+        main_length = MP3_MAIN_DATA_SIZE - keep;
+    memcpy(m->main_data + keep, frame + side_length, main_length);
+    m->main_data_size = keep + main_length;
+    memset(m->main_data + m->main_data_size, 0, 4);
+
+    if (m->main_data_begin > keep)
+        return -1;
+
+    /* The granules have to end inside the main data */
+    bits = 0;
+    for (gr = 0; gr < m->granules; gr++)
+        for (ch = 0; ch < m->channels; ch++)
+            bits += m->granule[gr][ch].part2_3_length;
+    if (bits > (m->main_data_begin + main_length) * 8)
+        return -1;
+
+    b.buffer = m->main_data + keep - m->main_data_begin;
+    b.position = 0;
+
+    for (gr = 0; gr < m->granules; gr++) {
+        for (ch = 0; ch < m->channels; ch++) {
+            g = &m->granule[gr][ch];
+            end = b.position + g->part2_3_length;
+
+            if (m->version == 1)
+                read_scalefactors(m, &b, gr, ch);
+            else
+                read_scalefactors_lsf(m, &b, ch);
+
+            if (b.position > end) {
+                memset(m->xr[ch], 0, 576 * sizeof(int32_t));
+                m->nonzero[ch] = 0;
+            } else {
+                m->nonzero[ch] = read_huffman(m, &b, g, m->xr[ch], end);
+            }
+            b.position = end;
+
+            dequantize(m, g, ch);
+        }
+
+        if (m->mode == 1 && m->channels == 2)
+            stereo(m, &m->granule[gr][1]);
+
+        for (ch = 0; ch < m->channels; ch++) {
+            g = &m->granule[gr][ch];
+            if (g->block_type == 2)
+                reorder(m, g, ch);
+            alias_reduce(m, g, ch);
+            hybrid(m, g, ch);
+
+            for (t = 0; t < 18; t++)
+                synthesis(m, ch, &m->work[32 * t], (m->synth_block - 1 - t) & 15, &m->pcm[2 * (576 * gr + 32 * t) + ch]);
+        }
+        m->synth_block = (m->synth_block - 18) & 15;
+    }
+
+    m->output_frames = 576 * m->granules;
+    return 0;
+}
+
+/* Copies up to frames of the last decoded frame as 16-bit stereo pairs,
+   returns the number written, 0 when the frame is used up */
+int ICODE_ATTR_MP3 mp3_read_pcm(Mp3Context *m, uint16_t *destination, int frames)
+{
+    const uint16_t *pcm = &m->pcm[2 * m->output_index];
+    int count = m->output_frames - m->output_index;
+    int i;
+
+    if (frames > count)
+        frames = count;
+
+    if (m->channels == 2) {
+        memcpy(destination, pcm, frames * 2 * sizeof(uint16_t));
+    } else {
+        for (i = 0; i < frames; i++)
+            destination[2 * i] = destination[2 * i + 1] = pcm[2 * i];
+    }
+
+    m->output_index += frames;
+    return frames;
+}
@@ -0,0 +1,127 @@
+/*
+Integer MPEG audio Layer III decoder for openHiFi
+
+Copyright (C) 2011 teho Labs/B. A. Bryce
+
+Written from ISO/IEC 11172-3 (MPEG-1) and 13818-3 (MPEG-2 half sample rates),
+MPEG-2.5 streams are decoded as well. Layer I and II are not supported.
+
+Please see project readme for more details on licenses
+*/
+
+#ifndef _MP3_DECODER_H
+#define _MP3_DECODER_H
+
+#include <inttypes.h>
+#include <stddef.h>
+
+#define MP3_MAX_CHANNELS 2		/* Maximum supported channels */
+#define MP3_MAX_FRAME 1441		/* Largest frame in bytes, MPEG-1 320 kbps at 32 kHz with padding */
+#define MP3_MAX_SAMPLES 1152		/* PCM frames in an MPEG-1 frame, MPEG-2 frames have 576 */
+#define MP3_MAIN_DATA_SIZE 2048		/* Bit reservoir (511 bytes back at most) and the main data of one frame */
+#define MP3_POW43_SIZE 1027		/* Entries of the i^(4/3) table, larger values are interpolated */
+#define MP3_SPECTRUM_SHIFT 24		/* Fraction bits of spectrum and subband values (1.0 = full scale) */
+
+/* Bytes of fast memory mp3_init needs */
+#define MP3_FAST_SIZE (MP3_MAIN_DATA_SIZE + 4 + 4 * (576 * (2 * MP3_MAX_CHANNELS + 1) \
+                       + 1024 * MP3_MAX_CHANNELS + 512 + MP3_POW43_SIZE + 1) + 2 * 2 * MP3_MAX_SAMPLES)
+
+/* The hot loops (Huffman decode, IMDCT, synthesis) can be placed in SRAM */
+/* by building with -DMP3_ICODE_SRAM, they are then copied there with .data (see link.ld) */
+#ifdef MP3_ICODE_SRAM
+#define ICODE_ATTR_MP3 __attribute__((section(".icode"), long_call, noinline))
+#else
+#define ICODE_ATTR_MP3
+#endif
+
+typedef struct Mp3Huffman {
+    const uint16_t *table;          /* See mp3tab.c, NULL for the tables that do not exist */
+    uint8_t bits;                   /* Width of the first level */
+    uint8_t linbits;
+} Mp3Huffman;
+
+typedef struct Mp3Granule {
+    int part2_3_length;             /* Bits of scalefactors and Huffman data */
+    int big_values;
+    int global_gain;
+    int scalefac_compress;
+    int block_type;                 /* 0 normal, 1 start, 2 short, 3 stop */
+    int mixed_block;
+    int table_select[3];
+    int subblock_gain[3];
+    int region1_start;              /* Lines */
+    int region2_start;
+    int preflag;
+    int scalefac_scale;
+    int count1_table;
+} Mp3Granule;
+
+typedef struct Mp3Context {
+    /* Header of the last frame */
+    int version;                    /* 1, 2 or 25 (MPEG-2.5) */
+    int channels;
+    unsigned long samplerate;
+    int mode;                       /* 0 stereo, 1 joint stereo, 2 dual channel, 3 mono */
+    int mode_extension;
+    int sfb;                        /* Row of the scalefactor band tables */
+    int granules;
+
+    /* Side information */
+    int main_data_begin;
+    uint8_t scfsi[MP3_MAX_CHANNELS];
+    Mp3Granule granule[2][MP3_MAX_CHANNELS];
+
+    /* Scalefactors, kept between granules for scfsi */
+    uint8_t scalefac_l[MP3_MAX_CHANNELS][22];
+    uint8_t scalefac_s[MP3_MAX_CHANNELS][13][3];
+    uint8_t illegal_l[22];          /* Intensity position of the right channel that means no intensity stereo */
+    uint8_t illegal_s[13];
+
+    /* Bit reservoir */
+    uint8_t *main_data;             /* MP3_MAIN_DATA_SIZE bytes and 4 for reading ahead */
+    int main_data_size;
+
+    /* Decode state */
+    int32_t *xr[MP3_MAX_CHANNELS];  /* 576 spectrum lines of the granule */
+    int nonzero[MP3_MAX_CHANNELS];  /* Lines from here on are zero */
+    int32_t *work;                  /* 576, reordering and then the subband samples of the granule */
+    int32_t *overlap[MP3_MAX_CHANNELS];     /* 576, second halves of the IMDCT outputs */
+    int32_t *synth[MP3_MAX_CHANNELS];       /* 16 blocks of 64, the V vector FIFO of the synthesis */
+    int synth_block;                /* Newest block in synth */
+    int32_t *window;                /* 512 synthesis window D[i] * 65536 */
+    uint32_t *pow43;                /* i^(4/3) in Q17 */
+    uint16_t *pcm;                  /* Decoded frame as 16-bit stereo pairs */
+    int output_frames;
+    int output_index;
+
+    /* Memory, all of it is fast (SRAM) */
+    uint8_t *fast_memory;
+    unsigned long fast_size, fast_used;
+} Mp3Context;
+
+int mp3_init(Mp3Context *m, void *fast_memory, unsigned long fast_size);
+int mp3_decode_frame(Mp3Context *m, const uint8_t *frame, unsigned long length) ICODE_ATTR_MP3;
+int mp3_read_pcm(Mp3Context *m, uint16_t *destination, int frames) ICODE_ATTR_MP3;
+
+/* mp3tab.c */
+extern const uint16_t mp3_sfb_long[9][23];
+extern const uint16_t mp3_sfb_short[9][14];
+extern const uint8_t mp3_pretab[22];
+extern const uint8_t mp3_slen[2][16];
+extern const uint8_t mp3_lsf_nsfb[6][3][4];
+extern const Mp3Huffman mp3_huffman[32];
+extern const Mp3Huffman mp3_count1[2];
+extern const int32_t mp3_imdct36[18][18];
+extern const int32_t mp3_imdct12[6][6];
+extern const int32_t mp3_window[4][36];
+extern const int32_t mp3_alias[8][2];
+extern const int32_t mp3_dct4_16[256];
+extern const int32_t mp3_dct4_8[64];
+extern const int32_t mp3_dct4_4[16];
+extern const int32_t mp3_dct4_2[4];
+extern const int32_t mp3_synth_window[257];
+extern const int32_t mp3_is_ratio[7][2];
+extern const int32_t mp3_lsf_is[2][16];
+extern const int32_t mp3_root4[4];
+
+#endif
@@ -0,0 +1,876 @@
+/*
+Tables of the openHiFi MP3 decoder
+
+Copyright (C) 2011 teho Labs/B. A. Bryce
+
+Huffman codes, scalefactor bands and the synthesis window are those of
+ISO/IEC 11172-3 and 13818-3. The cosine, window and stereo tables are Q31,
+the formula of each is given with it.
+
+Please see project readme for more details on licenses
+*/
+
+#include "mp3.h"
+
+/* Scalefactor band boundaries in lines for 44.1, 48, 32, 22.05, 24, 16, 11.025, 12 and 8 kHz */
+const uint16_t mp3_sfb_long[9][23] = {
+    {0, 4, 8, 12, 16, 20, 24, 30, 36, 44, 52, 62, 74, 90, 110, 134, 162, 196, 238, 288, 342, 418, 576},
+    {0, 4, 8, 12, 16, 20, 24, 30, 36, 42, 50, 60, 72, 88, 106, 128, 156, 190, 230, 276, 330, 384, 576},
+    {0, 4, 8, 12, 16, 20, 24, 30, 36, 44, 54, 66, 82, 102, 126, 156, 194, 240, 296, 364, 448, 550, 576},
+    {0, 6, 12, 18, 24, 30, 36, 44, 54, 66, 80, 96, 116, 140, 168, 200, 238, 284, 336, 396, 464, 522, 576},
+    {0, 6, 12, 18, 24, 30, 36, 44, 54, 66, 80, 96, 114, 136, 162, 194, 232, 278, 332, 394, 464, 540, 576},
+    {0, 6, 12, 18, 24, 30, 36, 44, 54, 66, 80, 96, 116, 140, 168, 200, 238, 284, 336, 396, 464, 522, 576},
+    {0, 6, 12, 18, 24, 30, 36, 44, 54, 66, 80, 96, 116, 140, 168, 200, 238, 284, 336, 396, 464, 522, 576},
+    {0, 6, 12, 18, 24, 30, 36, 44, 54, 66, 80, 96, 116, 140, 168, 200, 238, 284, 336, 396, 464, 522, 576},
+    {0, 12, 24, 36, 48, 60, 72, 88, 108, 132, 160, 192, 232, 280, 336, 400, 476, 566, 568, 570, 572, 574, 576}
+};
+
+/* Short block bands, in lines of one window */
+const uint16_t mp3_sfb_short[9][14] = {
+    {0, 4, 8, 12, 16, 22, 30, 40, 52, 66, 84, 106, 136, 192},
+    {0, 4, 8, 12, 16, 22, 28, 38, 50, 64, 80, 100, 126, 192},
+    {0, 4, 8, 12, 16, 22, 30, 42, 58, 78, 104, 138, 180, 192},
+    {0, 4, 8, 12, 18, 24, 32, 42, 56, 74, 100, 132, 174, 192},
+    {0, 4, 8, 12, 18, 26, 36, 48, 62, 80, 104, 136, 180, 192},
+    {0, 4, 8, 12, 18, 26, 36, 48, 62, 80, 104, 134, 174, 192},
+    {0, 4, 8, 12, 18, 26, 36, 48, 62, 80, 104, 134, 174, 192},
+    {0, 4, 8, 12, 18, 26, 36, 48, 62, 80, 104, 134, 174, 192},
+    {0, 8, 16, 24, 36, 52, 72, 96, 124, 160, 162, 164, 166, 192}
+};
+
+/* Added to the long block scalefactors when preflag is set */
+const uint8_t mp3_pretab[22] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 3, 3, 3, 2, 0};
+
+/* MPEG-1 scalefactor bit lengths (slen1, slen2) by scalefac_compress */
+const uint8_t mp3_slen[2][16] = {
+    {0, 0, 0, 0, 3, 1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4},
+    {0, 1, 2, 3, 0, 1, 2, 3, 1, 2, 3, 1, 2, 3, 2, 3}
+};
+
+/* MPEG-2 scalefactors in each of the 4 slen partitions, by scalefac_compress range and long, short or mixed block */
+const uint8_t mp3_lsf_nsfb[6][3][4] = {
+    {{6, 5, 5, 5}, {9, 9, 9, 9}, {6, 9, 9, 9}},
+    {{6, 5, 7, 3}, {9, 9, 12, 6}, {6, 9, 12, 6}},
+    {{11, 10, 0, 0}, {18, 18, 0, 0}, {15, 18, 0, 0}},
+    {{7, 7, 7, 0}, {12, 12, 12, 0}, {6, 15, 12, 0}},
+    {{6, 6, 6, 3}, {12, 9, 9, 6}, {6, 12, 9, 6}},
+    {{8, 8, 5, 0}, {15, 12, 9, 0}, {6, 18, 9, 0}}
+};
+
+/*
+Huffman decoding tables, one array for each code table of Table B.7. The
+first level is looked up with the next bits bits of the stream, an entry is
+    bit 15 clear: length << 8 | x << 4 | y, length is the bits used at this level
+    bit 15 set:   bits << 12 | offset of the next level (bits wide) in the array
+Count1 tables A and B hold v << 3 | w << 2 | x << 1 | y.
+*/
+static const uint16_t huffman_1[8] = {
+    0x0311, 0x0301, 0x0210, 0x0210, 0x0100, 0x0100, 0x0100, 0x0100
+};
+
+static const uint16_t huffman_2[64] = {
+    0x0622, 0x0602, 0x0512, 0x0512, 0x0521, 0x0521, 0x0520, 0x0520, 0x0311, 0x0311,
+    0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0301, 0x0301, 0x0301, 0x0301,
+    0x0301, 0x0301, 0x0301, 0x0301, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310,
+    0x0310, 0x0310, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100
+};
+
+static const uint16_t huffman_3[64] = {
+    0x0622, 0x0602, 0x0512, 0x0512, 0x0521, 0x0521, 0x0520, 0x0520, 0x0310, 0x0310,
+    0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0211, 0x0211, 0x0211, 0x0211,
+    0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211,
+    0x0211, 0x0211, 0x0201, 0x0201, 0x0201, 0x0201, 0x0201, 0x0201, 0x0201, 0x0201,
+    0x0201, 0x0201, 0x0201, 0x0201, 0x0201, 0x0201, 0x0201, 0x0201, 0x0200, 0x0200,
+    0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200,
+    0x0200, 0x0200, 0x0200, 0x0200
+};
+
+static const uint16_t huffman_5[256] = {
+    0x0833, 0x0823, 0x0732, 0x0732, 0x0631, 0x0631, 0x0631, 0x0631, 0x0713, 0x0713,
+    0x0703, 0x0703, 0x0730, 0x0730, 0x0722, 0x0722, 0x0612, 0x0612, 0x0612, 0x0612,
+    0x0621, 0x0621, 0x0621, 0x0621, 0x0602, 0x0602, 0x0602, 0x0602, 0x0620, 0x0620,
+    0x0620, 0x0620, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311,
+    0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311,
+    0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311,
+    0x0311, 0x0311, 0x0311, 0x0311, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301,
+    0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301,
+    0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301,
+    0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0310, 0x0310, 0x0310, 0x0310,
+    0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310,
+    0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310,
+    0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100
+};
+
+static const uint16_t huffman_6[128] = {
+    0x0733, 0x0703, 0x0623, 0x0623, 0x0632, 0x0632, 0x0630, 0x0630, 0x0513, 0x0513,
+    0x0513, 0x0513, 0x0531, 0x0531, 0x0531, 0x0531, 0x0522, 0x0522, 0x0522, 0x0522,
+    0x0502, 0x0502, 0x0502, 0x0502, 0x0412, 0x0412, 0x0412, 0x0412, 0x0412, 0x0412,
+    0x0412, 0x0412, 0x0421, 0x0421, 0x0421, 0x0421, 0x0421, 0x0421, 0x0421, 0x0421,
+    0x0420, 0x0420, 0x0420, 0x0420, 0x0420, 0x0420, 0x0420, 0x0420, 0x0301, 0x0301,
+    0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301,
+    0x0301, 0x0301, 0x0301, 0x0301, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211,
+    0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211,
+    0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211,
+    0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0310, 0x0310, 0x0310, 0x0310,
+    0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310,
+    0x0310, 0x0310, 0x0300, 0x0300, 0x0300, 0x0300, 0x0300, 0x0300, 0x0300, 0x0300,
+    0x0300, 0x0300, 0x0300, 0x0300, 0x0300, 0x0300, 0x0300, 0x0300
+};
+
+static const uint16_t huffman_7[268] = {
+    0xa100, 0x9104, 0x9106, 0x0815, 0x0851, 0x9108, 0x0850, 0x910a, 0x0824, 0x0842,
+    0x0714, 0x0714, 0x0741, 0x0741, 0x0740, 0x0740, 0x0804, 0x0823, 0x0832, 0x0803,
+    0x0713, 0x0713, 0x0731, 0x0731, 0x0730, 0x0730, 0x0722, 0x0722, 0x0612, 0x0612,
+    0x0612, 0x0612, 0x0521, 0x0521, 0x0521, 0x0521, 0x0521, 0x0521, 0x0521, 0x0521,
+    0x0602, 0x0602, 0x0602, 0x0602, 0x0620, 0x0620, 0x0620, 0x0620, 0x0411, 0x0411,
+    0x0411, 0x0411, 0x0411, 0x0411, 0x0411, 0x0411, 0x0411, 0x0411, 0x0411, 0x0411,
+    0x0411, 0x0411, 0x0411, 0x0411, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301,
+    0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301,
+    0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301,
+    0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0310, 0x0310, 0x0310, 0x0310,
+    0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310,
+    0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310,
+    0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0255, 0x0245, 0x0254, 0x0253,
+    0x0135, 0x0144, 0x0125, 0x0152, 0x0105, 0x0134, 0x0143, 0x0133
+};
+
+static const uint16_t huffman_8[274] = {
+    0xb100, 0xa108, 0x910c, 0x0815, 0x0851, 0x910e, 0x9110, 0x0824, 0x0842, 0x0814,
+    0x0741, 0x0741, 0x0804, 0x0840, 0x0823, 0x0832, 0x0813, 0x0831, 0x0803, 0x0830,
+    0x0622, 0x0622, 0x0622, 0x0622, 0x0602, 0x0602, 0x0602, 0x0602, 0x0620, 0x0620,
+    0x0620, 0x0620, 0x0412, 0x0412, 0x0412, 0x0412, 0x0412, 0x0412, 0x0412, 0x0412,
+    0x0412, 0x0412, 0x0412, 0x0412, 0x0412, 0x0412, 0x0412, 0x0412, 0x0421, 0x0421,
+    0x0421, 0x0421, 0x0421, 0x0421, 0x0421, 0x0421, 0x0421, 0x0421, 0x0421, 0x0421,
+    0x0421, 0x0421, 0x0421, 0x0421, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211,
+    0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211,
+    0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211,
+    0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211,
+    0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211,
+    0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211,
+    0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0211, 0x0301, 0x0301,
+    0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301,
+    0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301,
+    0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301,
+    0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310,
+    0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310,
+    0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310,
+    0x0310, 0x0310, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200,
+    0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200,
+    0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200,
+    0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200,
+    0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200,
+    0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200,
+    0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0355, 0x0354, 0x0245, 0x0245,
+    0x0153, 0x0153, 0x0153, 0x0153, 0x0235, 0x0244, 0x0125, 0x0125, 0x0152, 0x0105,
+    0x0134, 0x0143, 0x0150, 0x0133
+};
+
+static const uint16_t huffman_9[260] = {
+    0x9100, 0x0835, 0x0853, 0x9102, 0x0844, 0x0825, 0x0852, 0x0815, 0x0751, 0x0751,
+    0x0734, 0x0734, 0x0743, 0x0743, 0x0850, 0x0804, 0x0724, 0x0724, 0x0742, 0x0742,
+    0x0733, 0x0733, 0x0740, 0x0740, 0x0614, 0x0614, 0x0614, 0x0614, 0x0641, 0x0641,
+    0x0641, 0x0641, 0x0623, 0x0623, 0x0623, 0x0623, 0x0632, 0x0632, 0x0632, 0x0632,
+    0x0513, 0x0513, 0x0513, 0x0513, 0x0513, 0x0513, 0x0513, 0x0513, 0x0531, 0x0531,
+    0x0531, 0x0531, 0x0531, 0x0531, 0x0531, 0x0531, 0x0603, 0x0603, 0x0603, 0x0603,
+    0x0630, 0x0630, 0x0630, 0x0630, 0x0522, 0x0522, 0x0522, 0x0522, 0x0522, 0x0522,
+    0x0522, 0x0522, 0x0502, 0x0502, 0x0502, 0x0502, 0x0502, 0x0502, 0x0502, 0x0502,
+    0x0412, 0x0412, 0x0412, 0x0412, 0x0412, 0x0412, 0x0412, 0x0412, 0x0412, 0x0412,
+    0x0412, 0x0412, 0x0412, 0x0412, 0x0412, 0x0412, 0x0421, 0x0421, 0x0421, 0x0421,
+    0x0421, 0x0421, 0x0421, 0x0421, 0x0421, 0x0421, 0x0421, 0x0421, 0x0421, 0x0421,
+    0x0421, 0x0421, 0x0420, 0x0420, 0x0420, 0x0420, 0x0420, 0x0420, 0x0420, 0x0420,
+    0x0420, 0x0420, 0x0420, 0x0420, 0x0420, 0x0420, 0x0420, 0x0420, 0x0311, 0x0311,
+    0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311,
+    0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311,
+    0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311,
+    0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301,
+    0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301,
+    0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301,
+    0x0301, 0x0301, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310,
+    0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310,
+    0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310,
+    0x0310, 0x0310, 0x0310, 0x0310, 0x0300, 0x0300, 0x0300, 0x0300, 0x0300, 0x0300,
+    0x0300, 0x0300, 0x0300, 0x0300, 0x0300, 0x0300, 0x0300, 0x0300, 0x0300, 0x0300,
+    0x0300, 0x0300, 0x0300, 0x0300, 0x0300, 0x0300, 0x0300, 0x0300, 0x0300, 0x0300,
+    0x0300, 0x0300, 0x0300, 0x0300, 0x0300, 0x0300, 0x0155, 0x0145, 0x0154, 0x0105
+};
+
+static const uint16_t huffman_10[306] = {
+    0xb100, 0xa108, 0xb10c, 0x9114, 0xa116, 0xa11a, 0xa11e, 0x0817, 0x0871, 0x9122,
+    0xa124, 0xa128, 0x0816, 0x0861, 0x0860, 0x912c, 0x912e, 0x9130, 0x0814, 0x0841,
+    0x0840, 0x0823, 0x0832, 0x0803, 0x0713, 0x0713, 0x0731, 0x0731, 0x0730, 0x0730,
+    0x0722, 0x0722, 0x0612, 0x0612, 0x0612, 0x0612, 0x0621, 0x0621, 0x0621, 0x0621,
+    0x0602, 0x0602, 0x0602, 0x0602, 0x0620, 0x0620, 0x0620, 0x0620, 0x0411, 0x0411,
+    0x0411, 0x0411, 0x0411, 0x0411, 0x0411, 0x0411, 0x0411, 0x0411, 0x0411, 0x0411,
+    0x0411, 0x0411, 0x0411, 0x0411, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301,
+    0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301,
+    0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301,
+    0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0310, 0x0310, 0x0310, 0x0310,
+    0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310,
+    0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310,
+    0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0377, 0x0367, 0x0376, 0x0357,
+    0x0375, 0x0366, 0x0247, 0x0247, 0x0274, 0x0256, 0x0265, 0x0237, 0x0273, 0x0273,
+    0x0246, 0x0246, 0x0355, 0x0354, 0x0263, 0x0263, 0x0127, 0x0172, 0x0264, 0x0207,
+    0x0170, 0x0170, 0x0162, 0x0162, 0x0245, 0x0235, 0x0106, 0x0106, 0x0253, 0x0244,
+    0x0136, 0x0126, 0x0225, 0x0252, 0x0115, 0x0115, 0x0151, 0x0151, 0x0234, 0x0243,
+    0x0105, 0x0150, 0x0124, 0x0142, 0x0133, 0x0104
+};
+
+static const uint16_t huffman_11[286] = {
+    0xa100, 0xb104, 0xa10c, 0x9110, 0xa112, 0x0827, 0x0872, 0x9116, 0x0771, 0x0771,
+    0x0817, 0x0870, 0x0836, 0x0863, 0x0860, 0x9118, 0x911a, 0x0815, 0x0762, 0x0762,
+    0x0826, 0x0806, 0x0716, 0x0716, 0x0761, 0x0761, 0x0851, 0x0834, 0x0850, 0x911c,
+    0x0824, 0x0842, 0x0814, 0x0841, 0x0804, 0x0840, 0x0723, 0x0723, 0x0732, 0x0732,
+    0x0613, 0x0613, 0x0613, 0x0613, 0x0631, 0x0631, 0x0631, 0x0631, 0x0703, 0x0703,
+    0x0730, 0x0730, 0x0622, 0x0622, 0x0622, 0x0622, 0x0521, 0x0521, 0x0521, 0x0521,
+    0x0521, 0x0521, 0x0521, 0x0521, 0x0412, 0x0412, 0x0412, 0x0412, 0x0412, 0x0412,
+    0x0412, 0x0412, 0x0412, 0x0412, 0x0412, 0x0412, 0x0412, 0x0412, 0x0412, 0x0412,
+    0x0502, 0x0502, 0x0502, 0x0502, 0x0502, 0x0502, 0x0502, 0x0502, 0x0520, 0x0520,
+    0x0520, 0x0520, 0x0520, 0x0520, 0x0520, 0x0520, 0x0311, 0x0311, 0x0311, 0x0311,
+    0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311,
+    0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311,
+    0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0301, 0x0301,
+    0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301,
+    0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301,
+    0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301,
+    0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310,
+    0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310,
+    0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310,
+    0x0310, 0x0310, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200,
+    0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200,
+    0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200,
+    0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200,
+    0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200,
+    0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200,
+    0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0200, 0x0277, 0x0267, 0x0276, 0x0275,
+    0x0266, 0x0266, 0x0247, 0x0247, 0x0274, 0x0274, 0x0357, 0x0355, 0x0256, 0x0265,
+    0x0137, 0x0137, 0x0173, 0x0146, 0x0245, 0x0254, 0x0235, 0x0253, 0x0164, 0x0107,
+    0x0144, 0x0125, 0x0152, 0x0105, 0x0143, 0x0133
+};
+
+static const uint16_t huffman_12[272] = {
+    0xa100, 0x9104, 0x9106, 0x9108, 0x0856, 0x0837, 0x910a, 0x0827, 0x0872, 0x0846,
+    0x0864, 0x0817, 0x0871, 0x910c, 0x0836, 0x0863, 0x0845, 0x0854, 0x0844, 0x910e,
+    0x0726, 0x0726, 0x0762, 0x0762, 0x0761, 0x0761, 0x0816, 0x0860, 0x0835, 0x0853,
+    0x0825, 0x0852, 0x0715, 0x0715, 0x0751, 0x0751, 0x0734, 0x0734, 0x0743, 0x0743,
+    0x0850, 0x0804, 0x0724, 0x0724, 0x0742, 0x0742, 0x0714, 0x0714, 0x0633, 0x0633,
+    0x0633, 0x0633, 0x0641, 0x0641, 0x0641, 0x0641, 0x0623, 0x0623, 0x0623, 0x0623,
+    0x0632, 0x0632, 0x0632, 0x0632, 0x0740, 0x0740, 0x0703, 0x0703, 0x0630, 0x0630,
+    0x0630, 0x0630, 0x0513, 0x0513, 0x0513, 0x0513, 0x0513, 0x0513, 0x0513, 0x0513,
+    0x0531, 0x0531, 0x0531, 0x0531, 0x0531, 0x0531, 0x0531, 0x0531, 0x0522, 0x0522,
+    0x0522, 0x0522, 0x0522, 0x0522, 0x0522, 0x0522, 0x0412, 0x0412, 0x0412, 0x0412,
+    0x0412, 0x0412, 0x0412, 0x0412, 0x0412, 0x0412, 0x0412, 0x0412, 0x0412, 0x0412,
+    0x0412, 0x0412, 0x0421, 0x0421, 0x0421, 0x0421, 0x0421, 0x0421, 0x0421, 0x0421,
+    0x0421, 0x0421, 0x0421, 0x0421, 0x0421, 0x0421, 0x0421, 0x0421, 0x0502, 0x0502,
+    0x0502, 0x0502, 0x0502, 0x0502, 0x0502, 0x0502, 0x0520, 0x0520, 0x0520, 0x0520,
+    0x0520, 0x0520, 0x0520, 0x0520, 0x0400, 0x0400, 0x0400, 0x0400, 0x0400, 0x0400,
+    0x0400, 0x0400, 0x0400, 0x0400, 0x0400, 0x0400, 0x0400, 0x0400, 0x0400, 0x0400,
+    0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311,
+    0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311,
+    0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311,
+    0x0311, 0x0311, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301,
+    0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301,
+    0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301,
+    0x0301, 0x0301, 0x0301, 0x0301, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310,
+    0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310,
+    0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310,
+    0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0277, 0x0267, 0x0176, 0x0176,
+    0x0157, 0x0175, 0x0166, 0x0147, 0x0174, 0x0165, 0x0173, 0x0155, 0x0107, 0x0170,
+    0x0106, 0x0105
+};
+
+static const uint16_t huffman_13[586] = {
+    0xc100, 0xc110, 0xc120, 0xc130, 0xc140, 0xc150, 0xb160, 0xb168, 0xb170, 0xb178,
+    0xb180, 0xb188, 0x9190, 0xa192, 0xb196, 0x919e, 0xa1a0, 0xa1a4, 0xa1a8, 0xa1ac,
+    0x0881, 0x91b0, 0x91b2, 0x91b4, 0xa1b6, 0x91ba, 0x0815, 0x0851, 0x91bc, 0x91be,
+    0x91c0, 0x0814, 0x0741, 0x0741, 0x0804, 0x0840, 0x0823, 0x0832, 0x0713, 0x0713,
+    0x0731, 0x0731, 0x0703, 0x0703, 0x0730, 0x0730, 0x0722, 0x0722, 0x0612, 0x0612,
+    0x0612, 0x0612, 0x0621, 0x0621, 0x0621, 0x0621, 0x0602, 0x0602, 0x0602, 0x0602,
+    0x0620, 0x0620, 0x0620, 0x0620, 0x0411, 0x0411, 0x0411, 0x0411, 0x0411, 0x0411,
+    0x0411, 0x0411, 0x0411, 0x0411, 0x0411, 0x0411, 0x0411, 0x0411, 0x0411, 0x0411,
+    0x0401, 0x0401, 0x0401, 0x0401, 0x0401, 0x0401, 0x0401, 0x0401, 0x0401, 0x0401,
+    0x0401, 0x0401, 0x0401, 0x0401, 0x0401, 0x0401, 0x0310, 0x0310, 0x0310, 0x0310,
+    0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310,
+    0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310,
+    0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0xc1c2, 0xc1d2, 0xc1e2, 0xb1f2,
+    0xa1fa, 0xa1fe, 0xb202, 0xa20a, 0x920e, 0xa210, 0xa214, 0xa218, 0xa21c, 0xa220,
+    0x041f, 0x04f1, 0x04f0, 0x9224, 0x9226, 0x9228, 0x04e2, 0x922a, 0x041e, 0x04e1,
+    0x922c, 0x922e, 0x9230, 0x9232, 0x9234, 0x9236, 0x04c6, 0x043d, 0x9238, 0x042d,
+    0x04d2, 0x041d, 0x04b7, 0x923a, 0x923c, 0x04c3, 0x923e, 0x044b, 0x03d1, 0x03d1,
+    0x040d, 0x04d0, 0x048a, 0x04a8, 0x044c, 0x04c4, 0x046b, 0x04b6, 0x033c, 0x033c,
+    0x032c, 0x032c, 0x03c2, 0x03c2, 0x035b, 0x035b, 0x04b5, 0x0489, 0x031c, 0x031c,
+    0x03c1, 0x03c1, 0x0498, 0x040c, 0x03c0, 0x03c0, 0x04b4, 0x046a, 0x04a6, 0x0479,
+    0x033b, 0x033b, 0x03b3, 0x03b3, 0x0488, 0x045a, 0x032b, 0x032b, 0x04a5, 0x0469,
+    0x03a4, 0x03a4, 0x0478, 0x0487, 0x0394, 0x0394, 0x0477, 0x0476, 0x02b2, 0x02b2,
+    0x02b2, 0x02b2, 0x021b, 0x021b, 0x02b1, 0x02b1, 0x030b, 0x03b0, 0x0396, 0x034a,
+    0x033a, 0x03a3, 0x0359, 0x0395, 0x022a, 0x022a, 0x02a2, 0x02a2, 0x021a, 0x021a,
+    0x02a1, 0x02a1, 0x030a, 0x0368, 0x02a0, 0x02a0, 0x0386, 0x0349, 0x0293, 0x0293,
+    0x0339, 0x0358, 0x0385, 0x0367, 0x0229, 0x0229, 0x0292, 0x0292, 0x0357, 0x0375,
+    0x0238, 0x0238, 0x0283, 0x0283, 0x0366, 0x0347, 0x0374, 0x0356, 0x0365, 0x0373,
+    0x0119, 0x0191, 0x0209, 0x0290, 0x0248, 0x0284, 0x0272, 0x0272, 0x0346, 0x0364,
+    0x0128, 0x0128, 0x0128, 0x0128, 0x0182, 0x0118, 0x0237, 0x0227, 0x0117, 0x0117,
+    0x0171, 0x0171, 0x0255, 0x0207, 0x0270, 0x0236, 0x0263, 0x0245, 0x0254, 0x0226,
+    0x0262, 0x0235, 0x0108, 0x0180, 0x0116, 0x0161, 0x0106, 0x0160, 0x0253, 0x0244,
+    0x0125, 0x0125, 0x0152, 0x0105, 0x0134, 0x0143, 0x0150, 0x0124, 0x0142, 0x0133,
+    0xb240, 0x04ff, 0x04ef, 0x04df, 0x04ee, 0x04cf, 0x04de, 0x04bf, 0x04fb, 0x04ce,
+    0x04dc, 0x9248, 0x03ec, 0x03ec, 0x03dd, 0x03dd, 0x04fa, 0x04cd, 0x03be, 0x03be,
+    0x03eb, 0x03eb, 0x039f, 0x039f, 0x03f9, 0x03f9, 0x03ea, 0x03ea, 0x03bd, 0x03bd,
+    0x03db, 0x03db, 0x038f, 0x038f, 0x03f8, 0x03f8, 0x03cc, 0x03cc, 0x04ae, 0x049e,
+    0x038e, 0x038e, 0x047f, 0x047e, 0x02f7, 0x02f7, 0x02f7, 0x02f7, 0x02da, 0x02da,
+    0x03ad, 0x03bc, 0x03cb, 0x03f6, 0x026f, 0x026f, 0x02e8, 0x025f, 0x029d, 0x02d9,
+    0x02f5, 0x02e7, 0x02ac, 0x02bb, 0x024f, 0x024f, 0x02f4, 0x02f4, 0x03ca, 0x03e6,
+    0x02f3, 0x02f3, 0x013f, 0x013f, 0x028d, 0x02d8, 0x012f, 0x01f2, 0x026e, 0x029c,
+    0x010f, 0x010f, 0x02c9, 0x025e, 0x01ab, 0x01ab, 0x027d, 0x02d7, 0x014e, 0x014e,
+    0x02c8, 0x02d6, 0x013e, 0x013e, 0x01b9, 0x01b9, 0x029b, 0x02aa, 0x01ba, 0x01e5,
+    0x01e4, 0x018c, 0x016d, 0x01e3, 0x012e, 0x010e, 0x01e0, 0x015d, 0x01d5, 0x017c,
+    0x01c7, 0x014d, 0x018b, 0x01b8, 0x01d4, 0x019a, 0x01a9, 0x016c, 0x01d3, 0x017b,
+    0x015c, 0x01c5, 0x0199, 0x017a, 0x01a7, 0x0197, 0x03fe, 0x03fc, 0x02fd, 0x02fd,
+    0x01ed, 0x01ed, 0x01ed, 0x01ed, 0x01af, 0x01e9
+};
+
+static const uint16_t huffman_15[516] = {
+    0xc100, 0xc110, 0xc120, 0xc130, 0xc140, 0xb150, 0xb158, 0xc160, 0xb170, 0xb178,
+    0xb180, 0xb188, 0xa190, 0xb194, 0xb19c, 0xa1a4, 0xa1a8, 0xa1ac, 0xa1b0, 0xa1b4,
+    0xa1b8, 0xa1bc, 0xa1c0, 0xa1c4, 0x91c8, 0x91ca, 0x91cc, 0xa1ce, 0x91d2, 0x91d4,
+    0xa1d6, 0x91da, 0x91dc, 0x91de, 0x0891, 0x91e0, 0x91e2, 0x91e4, 0x91e6, 0x91e8,
+    0x0828, 0x0882, 0x0818, 0x0881, 0x91ea, 0x91ec, 0x91ee, 0x91f0, 0x0827, 0x0872,
+    0x0864, 0x0817, 0x0855, 0x0871, 0x91f2, 0x0836, 0x0863, 0x0845, 0x0854, 0x0826,
+    0x0862, 0x0816, 0x91f4, 0x0835, 0x0761, 0x0761, 0x0853, 0x0844, 0x0725, 0x0725,
+    0x0752, 0x0752, 0x0715, 0x0715, 0x0751, 0x0751, 0x0805, 0x0850, 0x0734, 0x0734,
+    0x0743, 0x0743, 0x0724, 0x0724, 0x0742, 0x0742, 0x0733, 0x0733, 0x0641, 0x0641,
+    0x0641, 0x0641, 0x0714, 0x0714, 0x0704, 0x0704, 0x0623, 0x0623, 0x0623, 0x0623,
+    0x0632, 0x0632, 0x0632, 0x0632, 0x0740, 0x0740, 0x0703, 0x0703, 0x0613, 0x0613,
+    0x0613, 0x0613, 0x0631, 0x0631, 0x0631, 0x0631, 0x0630, 0x0630, 0x0630, 0x0630,
+    0x0522, 0x0522, 0x0522, 0x0522, 0x0522, 0x0522, 0x0522, 0x0522, 0x0512, 0x0512,
+    0x0512, 0x0512, 0x0512, 0x0512, 0x0512, 0x0512, 0x0521, 0x0521, 0x0521, 0x0521,
+    0x0521, 0x0521, 0x0521, 0x0521, 0x0502, 0x0502, 0x0502, 0x0502, 0x0502, 0x0502,
+    0x0502, 0x0502, 0x0520, 0x0520, 0x0520, 0x0520, 0x0520, 0x0520, 0x0520, 0x0520,
+    0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311,
+    0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311,
+    0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311, 0x0311,
+    0x0311, 0x0311, 0x0401, 0x0401, 0x0401, 0x0401, 0x0401, 0x0401, 0x0401, 0x0401,
+    0x0401, 0x0401, 0x0401, 0x0401, 0x0401, 0x0401, 0x0401, 0x0401, 0x0410, 0x0410,
+    0x0410, 0x0410, 0x0410, 0x0410, 0x0410, 0x0410, 0x0410, 0x0410, 0x0410, 0x0410,
+    0x0410, 0x0410, 0x0410, 0x0410, 0x0300, 0x0300, 0x0300, 0x0300, 0x0300, 0x0300,
+    0x0300, 0x0300, 0x0300, 0x0300, 0x0300, 0x0300, 0x0300, 0x0300, 0x0300, 0x0300,
+    0x0300, 0x0300, 0x0300, 0x0300, 0x0300, 0x0300, 0x0300, 0x0300, 0x0300, 0x0300,
+    0x0300, 0x0300, 0x0300, 0x0300, 0x0300, 0x0300, 0x91f6, 0x91f8, 0x04ee, 0x91fa,
+    0x91fc, 0x91fe, 0x04fb, 0x9200, 0x04dd, 0x04af, 0x04fa, 0x04be, 0x04eb, 0x04cd,
+    0x04dc, 0x049f, 0x04f9, 0x04ea, 0x04bd, 0x04db, 0x048f, 0x04f8, 0x04cc, 0x049e,
+    0x04e9, 0x047f, 0x04f7, 0x04ad, 0x04da, 0x04bc, 0x046f, 0x9202, 0x03cb, 0x03cb,
+    0x03f6, 0x03f6, 0x048e, 0x04e8, 0x045f, 0x049d, 0x03f5, 0x03f5, 0x037e, 0x037e,
+    0x03e7, 0x03e7, 0x03ac, 0x03ac, 0x03ca, 0x03ca, 0x03bb, 0x03bb, 0x04d9, 0x048d,
+    0x034f, 0x034f, 0x03f4, 0x03f4, 0x033f, 0x033f, 0x03f3, 0x03f3, 0x03d8, 0x03d8,
+    0x03e6, 0x03e6, 0x032f, 0x032f, 0x03f2, 0x03f2, 0x046e, 0x04f0, 0x031f, 0x031f,
+    0x03f1, 0x03f1, 0x039c, 0x039c, 0x03c9, 0x03c9, 0x035e, 0x03ab, 0x03ba, 0x03e5,
+    0x037d, 0x03d7, 0x034e, 0x03e4, 0x038c, 0x03c8, 0x033e, 0x036d, 0x03d6, 0x03e3,
+    0x039b, 0x03b9, 0x032e, 0x032e, 0x03aa, 0x03aa, 0x03e2, 0x03e2, 0x031e, 0x031e,
+    0x03e1, 0x03e1, 0x040e, 0x04e0, 0x035d, 0x035d, 0x03d5, 0x03d5, 0x037c, 0x03c7,
+    0x034d, 0x038b, 0x02d4, 0x02d4, 0x03b8, 0x039a, 0x03a9, 0x036c, 0x03c6, 0x033d,
+    0x02d3, 0x02d3, 0x02d2, 0x02d2, 0x032d, 0x030d, 0x021d, 0x021d, 0x027b, 0x027b,
+    0x02b7, 0x02b7, 0x02d1, 0x02d1, 0x035c, 0x03d0, 0x02c5, 0x02c5, 0x028a, 0x028a,
+    0x02a8, 0x024c, 0x02c4, 0x026b, 0x02b6, 0x02b6, 0x0399, 0x030c, 0x023c, 0x023c,
+    0x02c3, 0x02c3, 0x027a, 0x027a, 0x02a7, 0x02a7, 0x02a6, 0x02a6, 0x03c0, 0x030b,
+    0x01c2, 0x01c2, 0x022c, 0x025b, 0x02b5, 0x021c, 0x0289, 0x0298, 0x02c1, 0x024b,
+    0x02b4, 0x026a, 0x023b, 0x0279, 0x01b3, 0x01b3, 0x0297, 0x0288, 0x022b, 0x025a,
+    0x01b2, 0x01b2, 0x02a5, 0x021b, 0x01b1, 0x01b1, 0x02b0, 0x0269, 0x0296, 0x024a,
+    0x02a4, 0x0278, 0x0287, 0x023a, 0x01a3, 0x01a3, 0x0159, 0x0195, 0x012a, 0x01a2,
+    0x011a, 0x01a1, 0x020a, 0x02a0, 0x0168, 0x0168, 0x0186, 0x0149, 0x0194, 0x0139,
+    0x0193, 0x0193, 0x0277, 0x0209, 0x0158, 0x0185, 0x0129, 0x0167, 0x0176, 0x0192,
+    0x0119, 0x0190, 0x0148, 0x0184, 0x0157, 0x0175, 0x0138, 0x0183, 0x0166, 0x0147,
+    0x0174, 0x0108, 0x0180, 0x0156, 0x0165, 0x0137, 0x0173, 0x0146, 0x0107, 0x0170,
+    0x0106, 0x0160, 0x01ff, 0x01ef, 0x01fe, 0x01df, 0x01fd, 0x01cf, 0x01fc, 0x01de,
+    0x01ed, 0x01bf, 0x01ce, 0x01ec, 0x01ae, 0x010f
+};
+
+static const uint16_t huffman_16[590] = {
+    0xb100, 0xb108, 0xa110, 0x08ff, 0xa114, 0x9118, 0xc11a, 0x08f2, 0x912a, 0x081f,
+    0x08f1, 0xc12c, 0xc13c, 0xc14c, 0xc15c, 0xc16c, 0xc17c, 0xb18c, 0xb194, 0xb19c,
+    0xb1a4, 0xb1ac, 0xb1b4, 0xb1bc, 0xa1c4, 0xa1c8, 0x91cc, 0xa1ce, 0xa1d2, 0x91d6,
+    0x0851, 0x91d8, 0x91da, 0x91dc, 0x91de, 0x0814, 0x0841, 0x91e0, 0x0823, 0x0832,
+    0x0713, 0x0713, 0x0731, 0x0731, 0x0803, 0x0830, 0x0722, 0x0722, 0x0612, 0x0612,
+    0x0612, 0x0612, 0x0621, 0x0621, 0x0621, 0x0621, 0x0602, 0x0602, 0x0602, 0x0602,
+    0x0620, 0x0620, 0x0620, 0x0620, 0x0411, 0x0411, 0x0411, 0x0411, 0x0411, 0x0411,
+    0x0411, 0x0411, 0x0411, 0x0411, 0x0411, 0x0411, 0x0411, 0x0411, 0x0411, 0x0411,
+    0x0401, 0x0401, 0x0401, 0x0401, 0x0401, 0x0401, 0x0401, 0x0401, 0x0401, 0x0401,
+    0x0401, 0x0401, 0x0401, 0x0401, 0x0401, 0x0401, 0x0310, 0x0310, 0x0310, 0x0310,
+    0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310,
+    0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310,
+    0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0310, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x03ef, 0x03fe, 0x03df, 0x03fd,
+    0x03cf, 0x03fc, 0x03bf, 0x03fb, 0x02af, 0x02af, 0x03fa, 0x039f, 0x03f9, 0x03f8,
+    0x028f, 0x028f, 0x027f, 0x02f7, 0x026f, 0x02f6, 0x025f, 0x02f5, 0x014f, 0x014f,
+    0x01f4, 0x01f3, 0x01f0, 0x01f0, 0x01f0, 0x01f0, 0x01f0, 0x01f0, 0x01f0, 0x01f0,
+    0x023f, 0x023f, 0x023f, 0x023f, 0xc1e2, 0xb1f2, 0xb1fa, 0xb202, 0x012f, 0x010f,
+    0xa20a, 0xa20e, 0xa212, 0x9216, 0xa218, 0xa21c, 0x9220, 0xa222, 0xa226, 0xa22a,
+    0xa22e, 0x04e3, 0x9232, 0x9234, 0x9236, 0x9238, 0x923a, 0x923c, 0x923e, 0x040d,
+    0x9240, 0x9242, 0x9244, 0x043c, 0x9246, 0x041c, 0x04c0, 0x9248, 0x03e2, 0x03e2,
+    0x042e, 0x041e, 0x04d3, 0x042d, 0x04d2, 0x04d1, 0x043b, 0x924a, 0x031d, 0x031d,
+    0x04c4, 0x046b, 0x04c3, 0x04a7, 0x032c, 0x032c, 0x04c2, 0x04b5, 0x04c1, 0x040c,
+    0x044b, 0x04b4, 0x046a, 0x04a6, 0x03b3, 0x03b3, 0x045a, 0x04a5, 0x032b, 0x032b,
+    0x03b2, 0x03b2, 0x031b, 0x031b, 0x03b1, 0x03b1, 0x040b, 0x04b0, 0x0469, 0x0496,
+    0x044a, 0x04a4, 0x0478, 0x0487, 0x03a3, 0x03a3, 0x043a, 0x0459, 0x032a, 0x032a,
+    0x0495, 0x0468, 0x03a1, 0x03a1, 0x0486, 0x0477, 0x0394, 0x0394, 0x0449, 0x0457,
+    0x0367, 0x0367, 0x02a2, 0x02a2, 0x02a2, 0x02a2, 0x021a, 0x021a, 0x030a, 0x03a0,
+    0x0339, 0x0393, 0x0358, 0x0385, 0x0229, 0x0229, 0x0292, 0x0292, 0x0376, 0x0309,
+    0x0219, 0x0219, 0x0291, 0x0291, 0x0390, 0x0348, 0x0384, 0x0375, 0x0338, 0x0383,
+    0x0366, 0x0328, 0x0282, 0x0282, 0x0347, 0x0374, 0x0218, 0x0218, 0x0281, 0x0281,
+    0x0280, 0x0280, 0x0308, 0x0356, 0x0237, 0x0237, 0x0273, 0x0273, 0x0365, 0x0346,
+    0x0227, 0x0227, 0x0272, 0x0272, 0x0364, 0x0355, 0x0207, 0x0207, 0x0117, 0x0117,
+    0x0117, 0x0117, 0x0171, 0x0171, 0x0270, 0x0236, 0x0263, 0x0245, 0x0254, 0x0226,
+    0x0162, 0x0116, 0x0161, 0x0161, 0x0206, 0x0260, 0x0153, 0x0153, 0x0235, 0x0244,
+    0x0125, 0x0152, 0x0115, 0x0105, 0x0134, 0x0143, 0x0150, 0x0124, 0x0142, 0x0133,
+    0x0104, 0x0140, 0x04ce, 0x924c, 0x03de, 0x03de, 0x03e9, 0x03e9, 0x04ea, 0x04d9,
+    0x02ee, 0x02ee, 0x02ee, 0x02ee, 0x03ed, 0x03ed, 0x03eb, 0x03eb, 0x02be, 0x02be,
+    0x02cd, 0x02cd, 0x03dc, 0x03db, 0x02ae, 0x02ae, 0x02cc, 0x02cc, 0x03ad, 0x03da,
+    0x037e, 0x03ac, 0x02ca, 0x02ca, 0x03c9, 0x037d, 0x025e, 0x025e, 0x01bd, 0x01bd,
+    0x01bd, 0x01bd, 0x019e, 0x019e, 0x02bc, 0x02cb, 0x028e, 0x02e8, 0x029d, 0x02e7,
+    0x02bb, 0x028d, 0x02d8, 0x026e, 0x01e6, 0x019c, 0x02ab, 0x02ba, 0x02e5, 0x02d7,
+    0x014e, 0x014e, 0x02e4, 0x028c, 0x01c8, 0x013e, 0x016d, 0x016d, 0x02d6, 0x029b,
+    0x02b9, 0x02aa, 0x01e1, 0x01e1, 0x01d4, 0x01d4, 0x02b8, 0x02a9, 0x017b, 0x017b,
+    0x02b7, 0x02d0, 0x010e, 0x01e0, 0x015d, 0x01d5, 0x017c, 0x01c7, 0x014d, 0x018b,
+    0x019a, 0x016c, 0x01c6, 0x013d, 0x015c, 0x01c5, 0x018a, 0x01a8, 0x0199, 0x014c,
+    0x01b6, 0x017a, 0x015b, 0x0189, 0x0198, 0x0179, 0x0197, 0x0188, 0x01ec, 0x01dd
+};
+
+static const uint16_t huffman_24[470] = {
+    0x08ef, 0x08fe, 0x08df, 0x08fd, 0x08cf, 0x08fc, 0x08bf, 0x08fb, 0x07fa, 0x07fa,
+    0x08af, 0x089f, 0x07f9, 0x07f9, 0x07f8, 0x07f8, 0x088f, 0x087f, 0x07f7, 0x07f7,
+    0x076f, 0x076f, 0x07f6, 0x07f6, 0x075f, 0x075f, 0x07f5, 0x07f5, 0x074f, 0x074f,
+    0x07f4, 0x07f4, 0x073f, 0x073f, 0x07f3, 0x07f3, 0x072f, 0x072f, 0x07f2, 0x07f2,
+    0x07f1, 0x07f1, 0x081f, 0x08f0, 0xb100, 0xb108, 0xb110, 0xb118, 0x04ff, 0x04ff,
+    0x04ff, 0x04ff, 0x04ff, 0x04ff, 0x04ff, 0x04ff, 0x04ff, 0x04ff, 0x04ff, 0x04ff,
+    0x04ff, 0x04ff, 0x04ff, 0x04ff, 0xc120, 0xb130, 0xb138, 0xb140, 0xa148, 0xa14c,
+    0xa150, 0xa154, 0xa158, 0xa15c, 0xa160, 0xa164, 0xa168, 0xb16c, 0xa174, 0xa178,
+    0xa17c, 0xb180, 0xa188, 0xb18c, 0x9194, 0xa196, 0xa19a, 0x919e, 0xa1a0, 0x91a4,
+    0x91a6, 0x91a8, 0x91aa, 0x91ac, 0x91ae, 0x91b0, 0x91b2, 0x91b4, 0x91b6, 0x91b8,
+    0x91ba, 0x91bc, 0x91be, 0x91c0, 0x91c2, 0x91c4, 0xa1c6, 0x91ca, 0xa1cc, 0x0873,
+    0x91d0, 0x0872, 0x0846, 0x0864, 0x0855, 0x0871, 0x0836, 0x0863, 0x0845, 0x0854,
+    0x0826, 0x0862, 0x0816, 0x0861, 0x91d2, 0x0835, 0x0853, 0x0844, 0x0825, 0x0852,
+    0x0815, 0x91d4, 0x0751, 0x0751, 0x0834, 0x0843, 0x0724, 0x0724, 0x0742, 0x0742,
+    0x0733, 0x0733, 0x0714, 0x0714, 0x0741, 0x0741, 0x0804, 0x0840, 0x0723, 0x0723,
+    0x0732, 0x0732, 0x0613, 0x0613, 0x0613, 0x0613, 0x0631, 0x0631, 0x0631, 0x0631,
+    0x0703, 0x0703, 0x0730, 0x0730, 0x0622, 0x0622, 0x0622, 0x0622, 0x0512, 0x0512,
+    0x0512, 0x0512, 0x0512, 0x0512, 0x0512, 0x0512, 0x0521, 0x0521, 0x0521, 0x0521,
+    0x0521, 0x0521, 0x0521, 0x0521, 0x0602, 0x0602, 0x0602, 0x0602, 0x0620, 0x0620,
+    0x0620, 0x0620, 0x0411, 0x0411, 0x0411, 0x0411, 0x0411, 0x0411, 0x0411, 0x0411,
+    0x0411, 0x0411, 0x0411, 0x0411, 0x0411, 0x0411, 0x0411, 0x0411, 0x0401, 0x0401,
+    0x0401, 0x0401, 0x0401, 0x0401, 0x0401, 0x0401, 0x0401, 0x0401, 0x0401, 0x0401,
+    0x0401, 0x0401, 0x0401, 0x0401, 0x0410, 0x0410, 0x0410, 0x0410, 0x0410, 0x0410,
+    0x0410, 0x0410, 0x0410, 0x0410, 0x0410, 0x0410, 0x0410, 0x0410, 0x0410, 0x0410,
+    0x0400, 0x0400, 0x0400, 0x0400, 0x0400, 0x0400, 0x0400, 0x0400, 0x0400, 0x0400,
+    0x0400, 0x0400, 0x0400, 0x0400, 0x0400, 0x0400, 0x010f, 0x010f, 0x010f, 0x010f,
+    0x03ee, 0x03de, 0x03ed, 0x03ce, 0x03ec, 0x03dd, 0x03be, 0x03eb, 0x03cd, 0x03dc,
+    0x03ae, 0x03ea, 0x03bd, 0x03db, 0x03cc, 0x039e, 0x03e9, 0x03ad, 0x03da, 0x03bc,
+    0x03cb, 0x038e, 0x03e8, 0x039d, 0x03d9, 0x037e, 0x03e7, 0x03ac, 0x03ca, 0x03ca,
+    0x03bb, 0x03bb, 0x038d, 0x038d, 0x03d8, 0x03d8, 0x040e, 0x04e0, 0x030d, 0x030d,
+    0x02e6, 0x02e6, 0x02e6, 0x02e6, 0x036e, 0x039c, 0x02c9, 0x02c9, 0x025e, 0x025e,
+    0x02ba, 0x02ba, 0x02e5, 0x02e5, 0x03ab, 0x037d, 0x02d7, 0x02d7, 0x02e4, 0x02e4,
+    0x028c, 0x028c, 0x02c8, 0x02c8, 0x034e, 0x032e, 0x023e, 0x023e, 0x026d, 0x02d6,
+    0x02e3, 0x029b, 0x02b9, 0x02aa, 0x02e2, 0x021e, 0x02e1, 0x025d, 0x02d5, 0x027c,
+    0x02c7, 0x024d, 0x028b, 0x02b8, 0x02d4, 0x029a, 0x02a9, 0x026c, 0x02c6, 0x023d,
+    0x02d3, 0x022d, 0x02d2, 0x021d, 0x027b, 0x02b7, 0x02d1, 0x025c, 0x02c5, 0x028a,
+    0x02a8, 0x0299, 0x024c, 0x02c4, 0x026b, 0x026b, 0x02b6, 0x02b6, 0x03d0, 0x030c,
+    0x023c, 0x023c, 0x02c3, 0x027a, 0x02a7, 0x022c, 0x02c2, 0x025b, 0x02b5, 0x021c,
+    0x0289, 0x0298, 0x02c1, 0x024b, 0x03c0, 0x030b, 0x023b, 0x023b, 0x03b0, 0x030a,
+    0x021a, 0x021a, 0x01b4, 0x01b4, 0x026a, 0x02a6, 0x0279, 0x0279, 0x0297, 0x0297,
+    0x03a0, 0x0309, 0x0290, 0x0290, 0x01b3, 0x0188, 0x022b, 0x025a, 0x01b2, 0x01b2,
+    0x02a5, 0x021b, 0x02b1, 0x0269, 0x0196, 0x01a4, 0x024a, 0x0278, 0x0187, 0x0187,
+    0x013a, 0x01a3, 0x0159, 0x0195, 0x012a, 0x01a2, 0x01a1, 0x0168, 0x0186, 0x0177,
+    0x0149, 0x0194, 0x0139, 0x0193, 0x0158, 0x0185, 0x0129, 0x0167, 0x0176, 0x0192,
+    0x0119, 0x0191, 0x0148, 0x0184, 0x0157, 0x0175, 0x0138, 0x0183, 0x0166, 0x0128,
+    0x0182, 0x0118, 0x0147, 0x0174, 0x0181, 0x0181, 0x0208, 0x0280, 0x0156, 0x0165,
+    0x0117, 0x0117, 0x0207, 0x0270, 0x0137, 0x0127, 0x0106, 0x0160, 0x0105, 0x0150
+};
+
+static const uint16_t huffman_a[64] = {
+    0x060b, 0x060f, 0x060d, 0x060e, 0x0607, 0x0605, 0x0509, 0x0509, 0x0506, 0x0506,
+    0x0503, 0x0503, 0x050a, 0x050a, 0x050c, 0x050c, 0x0402, 0x0402, 0x0402, 0x0402,
+    0x0401, 0x0401, 0x0401, 0x0401, 0x0404, 0x0404, 0x0404, 0x0404, 0x0408, 0x0408,
+    0x0408, 0x0408, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100
+};
+
+static const uint16_t huffman_b[16] = {
+    0x040f, 0x040e, 0x040d, 0x040c, 0x040b, 0x040a, 0x0409, 0x0408, 0x0407, 0x0406,
+    0x0405, 0x0404, 0x0403, 0x0402, 0x0401, 0x0400
+};
+
+const Mp3Huffman mp3_huffman[32] = {
+    {NULL, 0, 0}, {huffman_1, 3, 0}, {huffman_2, 6, 0}, {huffman_3, 6, 0},
+    {NULL, 0, 0}, {huffman_5, 8, 0}, {huffman_6, 7, 0}, {huffman_7, 8, 0},
+    {huffman_8, 8, 0}, {huffman_9, 8, 0}, {huffman_10, 8, 0}, {huffman_11, 8, 0},
+    {huffman_12, 8, 0}, {huffman_13, 8, 0}, {NULL, 0, 0}, {huffman_15, 8, 0},
+    {huffman_16, 8, 1}, {huffman_16, 8, 2}, {huffman_16, 8, 3}, {huffman_16, 8, 4},
+    {huffman_16, 8, 6}, {huffman_16, 8, 8}, {huffman_16, 8, 10}, {huffman_16, 8, 13},
+    {huffman_24, 8, 4}, {huffman_24, 8, 5}, {huffman_24, 8, 6}, {huffman_24, 8, 7},
+    {huffman_24, 8, 8}, {huffman_24, 8, 9}, {huffman_24, 8, 11}, {huffman_24, 8, 13}
+};
+
+const Mp3Huffman mp3_count1[2] = {{huffman_a, 6, 0}, {huffman_b, 4, 0}};
+
+/* cos(pi/72 (2i + 19)(2k + 1)) for the outputs i = 0..8 and 18..26 of the 36 point IMDCT */
+const int32_t mp3_imdct36[18][18] = {
+    {
+        1450818924, -1703713325, -1153842123, 1904841260, 821806413, -2048091557,
+        -464800532, 2129111628, 93671921, -2145439719, 280302863, 2096579711,
+        -645760787, -1984016189, 991597596, 1811169339, -1307305214, -1583291025
+    },
+    {
+        1307305214, -1984016189, -280302863, 2129111628, -821806413, -1703713325,
+        1703713325, 821806413, -2129111628, 280302863, 1984016189, -1307305214,
+        -1307305214, 1984016189, 280302863, -2129111628, 821806413, 1703713325
+    },
+    {
+        1153842123, -2129111628, 645760787, 1583291025, -1984016189, 93671921,
+        1904841260, -1703713325, -464800532, 2096579711, -1307305214, -991597596,
+        2145439719, -821806413, -1450818924, 2048091557, -280302863, -1811169339
+    },
+    {
+        991597596, -2129111628, 1450818924, 464800532, -1984016189, 1811169339,
+        -93671921, -1703713325, 2048091557, -645760787, -1307305214, 2145439719,
+        -1153842123, -821806413, 2096579711, -1583291025, -280302863, 1904841260
+    },
+    {
+        821806413, -1984016189, 1984016189, -821806413, -821806413, 1984016189,
+        -1984016189, 821806413, 821806413, -1984016189, 1984016189, -821806413,
+        -821806413, 1984016189, -1984016189, 821806413, 821806413, -1984016189
+    },
+    {
+        645760787, -1703713325, 2145439719, -1811169339, 821806413, 464800532,
+        -1583291025, 2129111628, -1904841260, 991597596, 280302863, -1450818924,
+        2096579711, -1984016189, 1153842123, 93671921, -1307305214, 2048091557
+    },
+    {
+        464800532, -1307305214, 1904841260, -2145439719, 1984016189, -1450818924,
+        645760787, 280302863, -1153842123, 1811169339, -2129111628, 2048091557,
+        -1583291025, 821806413, 93671921, -991597596, 1703713325, -2096579711
+    },
+    {
+        280302863, -821806413, 1307305214, -1703713325, 1984016189, -2129111628,
+        2129111628, -1984016189, 1703713325, -1307305214, 821806413, -280302863,
+        -280302863, 821806413, -1307305214, 1703713325, -1984016189, 2129111628
+    },
+    {
+        93671921, -280302863, 464800532, -645760787, 821806413, -991597596,
+        1153842123, -1307305214, 1450818924, -1583291025, 1703713325, -1811169339,
+        1904841260, -1984016189, 2048091557, -2096579711, 2129111628, -2145439719
+    },
+    {
+        -1583291025, 1307305214, 1811169339, -991597596, -1984016189, 645760787,
+        2096579711, -280302863, -2145439719, -93671921, 2129111628, 464800532,
+        -2048091557, -821806413, 1904841260, 1153842123, -1703713325, -1450818924
+    },
+    {
+        -1703713325, 821806413, 2129111628, 280302863, -1984016189, -1307305214,
+        1307305214, 1984016189, -280302863, -2129111628, -821806413, 1703713325,
+        1703713325, -821806413, -2129111628, -280302863, 1984016189, 1307305214
+    },
+    {
+        -1811169339, 280302863, 2048091557, 1450818924, -821806413, -2145439719,
+        -991597596, 1307305214, 2096579711, 464800532, -1703713325, -1904841260,
+        93671921, 1984016189, 1583291025, -645760787, -2129111628, -1153842123
+    },
+    {
+        -1904841260, -280302863, 1583291025, 2096579711, 821806413, -1153842123,
+        -2145439719, -1307305214, 645760787, 2048091557, 1703713325, -93671921,
+        -1811169339, -1984016189, -464800532, 1450818924, 2129111628, 991597596
+    },
+    {
+        -1984016189, -821806413, 821806413, 1984016189, 1984016189, 821806413,
+        -821806413, -1984016189, -1984016189, -821806413, 821806413, 1984016189,
+        1984016189, 821806413, -821806413, -1984016189, -1984016189, -821806413
+    },
+    {
+        -2048091557, -1307305214, -93671921, 1153842123, 1984016189, 2096579711,
+        1450818924, 280302863, -991597596, -1904841260, -2129111628, -1583291025,
+        -464800532, 821806413, 1811169339, 2145439719, 1703713325, 645760787
+    },
+    {
+        -2096579711, -1703713325, -991597596, -93671921, 821806413, 1583291025,
+        2048091557, 2129111628, 1811169339, 1153842123, 280302863, -645760787,
+        -1450818924, -1984016189, -2145439719, -1904841260, -1307305214, -464800532
+    },
+    {
+        -2129111628, -1984016189, -1703713325, -1307305214, -821806413, -280302863,
+        280302863, 821806413, 1307305214, 1703713325, 1984016189, 2129111628,
+        2129111628, 1984016189, 1703713325, 1307305214, 821806413, 280302863
+    },
+    {
+        -2145439719, -2129111628, -2096579711, -2048091557, -1984016189, -1904841260,
+        -1811169339, -1703713325, -1583291025, -1450818924, -1307305214, -1153842123,
+        -991597596, -821806413, -645760787, -464800532, -280302863, -93671921
+    }
+};
+
+/* cos(pi/24 (2i + 7)(2k + 1)) for the outputs i = 0..2 and 6..8 of the 12 point IMDCT */
+const int32_t mp3_imdct12[6][6] = {
+    {
+        1307305214, -1984016189, -280302863, 2129111628, -821806413, -1703713325
+    },
+    {
+        821806413, -1984016189, 1984016189, -821806413, -821806413, 1984016189
+    },
+    {
+        280302863, -821806413, 1307305214, -1703713325, 1984016189, -2129111628
+    },
+    {
+        -1703713325, 821806413, 2129111628, 280302863, -1984016189, -1307305214
+    },
+    {
+        -1984016189, -821806413, 821806413, 1984016189, 1984016189, 821806413
+    },
+    {
+        -2129111628, -1984016189, -1703713325, -1307305214, -821806413, -280302863
+    }
+};
+
+/* Windows of block types 0 to 3 from sin(pi/36 (i + 0.5)) and sin(pi/12 (i + 0.5)), type 2 is one short window */
+const int32_t mp3_window[4][36] = {
+    {
+        93671921, 280302863, 464800532, 645760787, 821806413, 991597596,
+        1153842123, 1307305214, 1450818924, 1583291025, 1703713325, 1811169339,
+        1904841260, 1984016189, 2048091557, 2096579711, 2129111628, 2145439719,
+        2145439719, 2129111628, 2096579711, 2048091557, 1984016189, 1904841260,
+        1811169339, 1703713325, 1583291025, 1450818924, 1307305214, 1153842123,
+        991597596, 821806413, 645760787, 464800532, 280302863, 93671921
+    },
+    {
+        93671921, 280302863, 464800532, 645760787, 821806413, 991597596,
+        1153842123, 1307305214, 1450818924, 1583291025, 1703713325, 1811169339,
+        1904841260, 1984016189, 2048091557, 2096579711, 2129111628, 2145439719,
+        2147483647, 2147483647, 2147483647, 2147483647, 2147483647, 2147483647,
+        2129111628, 1984016189, 1703713325, 1307305214, 821806413, 280302863,
+        0, 0, 0, 0, 0, 0
+    },
+    {
+        280302863, 821806413, 1307305214, 1703713325, 1984016189, 2129111628,
+        2129111628, 1984016189, 1703713325, 1307305214, 821806413, 280302863,
+        0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0
+    },
+    {
+        0, 0, 0, 0, 0, 0,
+        280302863, 821806413, 1307305214, 1703713325, 1984016189, 2129111628,
+        2147483647, 2147483647, 2147483647, 2147483647, 2147483647, 2147483647,
+        2145439719, 2129111628, 2096579711, 2048091557, 1984016189, 1904841260,
+        1811169339, 1703713325, 1583291025, 1450818924, 1307305214, 1153842123,
+        991597596, 821806413, 645760787, 464800532, 280302863, 93671921
+    }
+};
+
+/* Alias reduction butterflies cs = 1/sqrt(1 + c*c), ca = c/sqrt(1 + c*c) */
+const int32_t mp3_alias[8][2] = {
+    {1841452036, -1104871222},
+    {1893526521, -1013036689},
+    {2039311996, -672972959},
+    {2111652008, -390655622},
+    {2137858231, -203096532},
+    {2145680960, -87972919},
+    {2147267171, -30491194},
+    {2147468949, -7945635}
+};
+
+/* DCT-IV of 16 points, cos(pi (2k + 1)(2i + 1) / 64) at [k][i] */
+const int32_t mp3_dct4_16[256] = {
+    2144896910, 2124240380, 2083126254, 2021950484, 1941302225, 1841958164,
+    1724875040, 1591180426, 1442161874, 1279254516, 1104027237, 918167572,
+    723465451, 521795963, 315101295, 105372028, 2124240380, 1941302225,
+    1591180426, 1104027237, 521795963, -105372028, -723465451, -1279254516,
+    -1724875040, -2021950484, -2144896910, -2083126254, -1841958164, -1442161874,
+    -918167572, -315101295, 2083126254, 1591180426, 723465451, -315101295,
+    -1279254516, -1941302225, -2144896910, -1841958164, -1104027237, -105372028,
+    918167572, 1724875040, 2124240380, 2021950484, 1442161874, 521795963,
+    2021950484, 1104027237, -315101295, -1591180426, -2144896910, -1724875040,
+    -521795963, 918167572, 1941302225, 2083126254, 1279254516, -105372028,
+    -1442161874, -2124240380, -1841958164, -723465451, 1941302225, 521795963,
+    -1279254516, -2144896910, -1442161874, 315101295, 1841958164, 2021950484,
+    723465451, -1104027237, -2124240380, -1591180426, 105372028, 1724875040,
+    2083126254, 918167572, 1841958164, -105372028, -1941302225, -1724875040,
+    315101295, 2021950484, 1591180426, -521795963, -2083126254, -1442161874,
+    723465451, 2124240380, 1279254516, -918167572, -2144896910, -1104027237,
+    1724875040, -723465451, -2144896910, -521795963, 1841958164, 1591180426,
+    -918167572, -2124240380, -315101295, 1941302225, 1442161874, -1104027237,
+    -2083126254, -105372028, 2021950484, 1279254516, 1591180426, -1279254516,
+    -1841958164, 918167572, 2021950484, -521795963, -2124240380, 105372028,
+    2144896910, 315101295, -2083126254, -723465451, 1941302225, 1104027237,
+    -1724875040, -1442161874, 1442161874, -1724875040, -1104027237, 1941302225,
+    723465451, -2083126254, -315101295, 2144896910, -105372028, -2124240380,
+    521795963, 2021950484, -918167572, -1841958164, 1279254516, 1591180426,
+    1279254516, -2021950484, -105372028, 2083126254, -1104027237, -1442161874,
+    1941302225, 315101295, -2124240380, 918167572, 1591180426, -1841958164,
+    -521795963, 2144896910, -723465451, -1724875040, 1104027237, -2144896910,
+    918167572, 1279254516, -2124240380, 723465451, 1442161874, -2083126254,
+    521795963, 1591180426, -2021950484, 315101295, 1724875040, -1941302225,
+    105372028, 1841958164, 918167572, -2083126254, 1724875040, -105372028,
+    -1591180426, 2124240380, -1104027237, -723465451, 2021950484, -1841958164,
+    315101295, 1442161874, -2144896910, 1279254516, 521795963, -1941302225,
+    723465451, -1841958164, 2124240380, -1442161874, 105372028, 1279254516,
+    -2083126254, 1941302225, -918167572, -521795963, 1724875040, -2144896910,
+    1591180426, -315101295, -1104027237, 2021950484, 521795963, -1442161874,
+    2021950484, -2124240380, 1724875040, -918167572, -105372028, 1104027237,
+    -1841958164, 2144896910, -1941302225, 1279254516, -315101295, -723465451,
+    1591180426, -2083126254, 315101295, -918167572, 1442161874, -1841958164,
+    2083126254, -2144896910, 2021950484, -1724875040, 1279254516, -723465451,
+    105372028, 521795963, -1104027237, 1591180426, -1941302225, 2124240380,
+    105372028, -315101295, 521795963, -723465451, 918167572, -1104027237,
+    1279254516, -1442161874, 1591180426, -1724875040, 1841958164, -1941302225,
+    2021950484, -2083126254, 2124240380, -2144896910
+};
+
+/* DCT-IV of 8 points, cos(pi (2k + 1)(2i + 1) / 32) at [k][i] */
+const int32_t mp3_dct4_8[64] = {
+    2137142927, 2055013723, 1893911494, 1660027308, 1362349204, 1012316784,
+    623381598, 210490206, 2055013723, 1362349204, 210490206, -1012316784,
+    -1893911494, -2137142927, -1660027308, -623381598, 1893911494, 210490206,
+    -1660027308, -2055013723, -623381598, 1362349204, 2137142927, 1012316784,
+    1660027308, -1012316784, -2055013723, 210490206, 2137142927, 623381598,
+    -1893911494, -1362349204, 1362349204, -1893911494, -623381598, 2137142927,
+    -210490206, -2055013723, 1012316784, 1660027308, 1012316784, -2137142927,
+    1362349204, 623381598, -2055013723, 1660027308, 210490206, -1893911494,
+    623381598, -1660027308, 2137142927, -1893911494, 1012316784, 210490206,
+    -1362349204, 2055013723, 210490206, -623381598, 1012316784, -1362349204,
+    1660027308, -1893911494, 2055013723, -2137142927
+};
+
+/* DCT-IV of 4 points, cos(pi (2k + 1)(2i + 1) / 16) at [k][i] */
+const int32_t mp3_dct4_4[16] = {
+    2106220352, 1785567396, 1193077991, 418953276, 1785567396, -418953276,
+    -2106220352, -1193077991, 1193077991, -2106220352, 418953276, 1785567396,
+    418953276, -1193077991, 1785567396, -2106220352
+};
+
+/* DCT-IV of 2 points, cos(pi (2k + 1)(2i + 1) / 8) at [k][i] */
+const int32_t mp3_dct4_2[4] = {
+    1984016189, 821806413, 821806413, -1984016189
+};
+
+/* Synthesis window D[0..256] of Table 3-B.3 times 65536, D[512 - i] is the same magnitude */
+const int32_t mp3_synth_window[257] = {
+    0, -1, -1, -1, -1, -1, -1, -2, -2, -2,
+    -2, -3, -3, -4, -4, -5, -5, -6, -7, -7,
+    -8, -9, -10, -11, -13, -14, -16, -17, -19, -21,
+    -24, -26, -29, -31, -35, -38, -41, -45, -49, -53,
+    -58, -63, -68, -73, -79, -85, -91, -97, -104, -111,
+    -117, -125, -132, -139, -147, -154, -161, -169, -176, -183,
+    -190, -196, -202, -208, -213, -218, -222, -225, -227, -228,
+    -228, -227, -224, -221, -215, -208, -200, -189, -177, -163,
+    -146, -127, -106, -83, -57, -29, 2, 36, 72, 111,
+    153, 197, 244, 294, 347, 401, 459, 519, 581, 645,
+    711, 779, 848, 919, 991, 1064, 1137, 1210, 1283, 1356,
+    1428, 1498, 1567, 1634, 1698, 1759, 1817, 1870, 1919, 1962,
+    2001, 2032, 2057, 2075, 2085, 2087, 2080, 2063, 2037, 2000,
+    1952, 1893, 1822, 1739, 1644, 1535, 1414, 1280, 1131, 970,
+    794, 605, 402, 185, -45, -288, -545, -814, -1095, -1388,
+    -1692, -2006, -2330, -2663, -3004, -3351, -3705, -4063, -4425, -4788,
+    -5153, -5517, -5879, -6237, -6589, -6935, -7271, -7597, -7910, -8209,
+    -8491, -8755, -8998, -9219, -9416, -9585, -9727, -9838, -9916, -9959,
+    -9966, -9935, -9863, -9750, -9592, -9389, -9139, -8840, -8492, -8092,
+    -7640, -7134, -6574, -5959, -5288, -4561, -3776, -2935, -2037, -1082,
+    -70, 998, 2122, 3300, 4533, 5818, 7154, 8540, 9975, 11455,
+    12980, 14548, 16155, 17799, 19478, 21189, 22929, 24694, 26482, 28289,
+    30112, 31947, 33791, 35640, 37489, 39336, 41176, 43006, 44821, 46617,
+    48390, 50137, 51853, 53534, 55178, 56778, 58333, 59838, 61289, 62684,
+    64019, 65290, 66494, 67629, 68692, 69679, 70590, 71420, 72169, 72835,
+    73415, 73908, 74313, 74630, 74856, 74992, 75038
+};
+
+/* MPEG-1 intensity stereo, left and right gain tan(p)/(1 + tan(p)), 1/(1 + tan(p)) with p = is_pos pi/12 */
+const int32_t mp3_is_ratio[7][2] = {
+    {0, 2147483647},
+    {453816693, 1693666955},
+    {786033569, 1361450079},
+    {1073741824, 1073741824},
+    {1361450079, 786033569},
+    {1693666955, 453816693},
+    {2147483647, 0}
+};
+
+/* MPEG-2 intensity stereo gains 2^(-k/4) and 2^(-k/2) for intensity_scale 0 and 1 */
+const int32_t mp3_lsf_is[2][16] = {
+    {
+        2147483647, 1805811301, 1518500250, 1276901417, 1073741824, 902905651,
+        759250125, 638450708, 536870912, 451452825, 379625062, 319225354,
+        268435456, 225726413, 189812531, 159612677
+    },
+    {
+        2147483647, 1518500250, 1073741824, 759250125, 536870912, 379625062,
+        268435456, 189812531, 134217728, 94906266, 67108864, 47453133,
+        33554432, 23726566, 16777216, 11863283
+    }
+};
+
+/* 2^(r/4) / 2 for the quarter steps of the scale exponent */
+const int32_t mp3_root4[4] = {
+    1073741824, 1276901417, 1518500250, 1805811301
+};
@@ -52,12 +52,19 @@ Please see project readme for more details on licenses
 
 //Chan's FatFS
 #include "fatfs/src/ff.h"
+#include "fatfs/src/diskio.h"
+
+//SDRAM sector cache under FatFs
+#include "fat_usbmsc.h"
 
 //Chan's xprintf
 #include "xprintf.h"
 
 //FLAC related
 #include "flac/decoder.h"
+#include "vorbis/vorbis.h"
+#include "mp3/mp3.h"
+#include "alac/alac.h"
 
 //********************************
 //*********** Defines ************
@@ -76,11 +83,69 @@ Please see project readme for more details on licenses
 //It should be set to the largest value it ever needs to be (currently FLAC defined)
 #define decoderScatchSize MAX_FRAMESIZE + MAX_BLOCKSIZE*8
 
+//SDRAM at the end of the memory map for decoder tables too big for SRAM (Ogg packets, Vorbis codebooks, MP4 sample tables)
+#define decoderTableSize (2*1024*1024)
+
+//Cluster link map tables for FatFs fast seek, one for the playing track and one for index.txt (below the decoder tables)
+//Each holds a file of up to linkMapSize/8 - 1 fragments, more fragmented files fall back to walking the FAT
+#define linkMapSize (128*1024)
+
+//SDRAM sector cache between FatFs and the USB drive (below the link maps), 1-4 MB is sensible
+#define diskCacheSize (2*1024*1024)
+
+//Read-ahead ring for the playing track (below the sector cache), filled readAheadChunk bytes at a time
+//Both must be powers of two
+#define readAheadSize (1024*1024)
+#define readAheadChunk (32*1024)
+
+//index.txt is written through a buffer of this size in SDRAM (below the read-ahead ring), a multiple of
+//every FAT cluster size so the writes are whole clusters, and the file is grown indexReserveSize ahead of them
+#define indexWriteSize (64*1024)
+#define indexReserveSize (1024*1024)
+
+//index.txt is an indexHeader, a table of indexRecords and a pool of the strings they point to
+//The pool is put together in SDRAM while the index is built (below the walkFiles stack), each string is
+//stored once by looking it up in a hash table of indexHashSize pool offsets (a power of two, below the pool)
+//When the drive is mounted the whole of index.txt is loaded into the same indexPoolSize bytes (see loadIndex)
+#define indexMagic "OHIX"
+#define indexVersion 1
+#define indexPoolSize (4*1024*1024)
+#define indexHashSize (128*1024)
+
+//bench disk reads benchBytes at each transfer size and times benchRandomReads random 4K reads
+#define benchBytes (1024*1024)
+#define benchRandomReads 64
+
+//bench ogg counts cycles with the DWT cycle counter of the Cortex-M3 (enabled through TRCENA in DEMCR)
+#define DEMCR 0xE000EDFC
+#define DEMCR_TRCENA 0x01000000
+#define DWT_CTRL 0xE0001000
+#define DWT_CTRL_CYCCNTENA 0x00000001
+#define DWT_CYCCNT 0xE0001004
+
+//frag lists this many of the files with the most cluster runs
+#define fragWorstCount 10
+
+//Directory levels walkFiles can descend, a charLineSize path can not hold more (its stack is in SDRAM below the file handles)
+#define walkDepth (charLineSize/2)
+
+//Number of file handles in the pool in SDRAM (below the index.txt write buffer), see fileHandleGet
+//The playing track and index.txt hold one each for as long as the player runs
+#define fileHandles 8
+
 //Size in bytes for interupt character buffers
 #define charLineSize 128
 #define UARTRxBufferSize charLineSize
 
 
+//Audio formats found by probeFile
+#define FORMAT_UNKNOWN 0
+#define FORMAT_FLAC 1
+#define FORMAT_WAV 2
+#define FORMAT_OGG 3
+#define FORMAT_MP3 4
+#define FORMAT_MP4 5
+
 //CommandList:
 #define NO_COMMAND 0
 #define BAD_COMMAND 1
@@ -92,6 +157,137 @@ Please see project readme for more details on licenses
 #define SONGLIST_COMMAND 7
 #define SEARCH_PLAY_COMMAND 8
 #define END_QUEUE_COMMAND 9
+#define DISK_CACHE_COMMAND 10
+#define BENCH_COMMAND 11
+#define FRAG_COMMAND 12
+#define SEARCH_QUEUE_COMMAND 13
+
+//Structure for holding the PCM layout of a WAV file
+typedef struct
+{
+	unsigned long sampleRate;
+	unsigned short channels;
+	unsigned short bitsPerSample;
+	unsigned short blockAlign;
+	unsigned long dataOffset;
+	unsigned long dataLength;
+} wavFormat;
+
+//Structure for holding the stream layout of an MP3 file, taken from its first frame header
+typedef struct
+{
+	unsigned char header[4];
+	unsigned short version;		//1, 2 or 25 (MPEG-2.5)
+	unsigned short layer;
+	unsigned short channels;
+	unsigned long sampleRate;
+	unsigned long bitrate;		//kbps
+	unsigned long frameLength;
+	unsigned long samplesPerFrame;
+	unsigned long frameCount;	//From the Xing/Info header, 0 when there is none
+	unsigned long dataOffset;
+} mpegFormat;
+
+//Structure for holding the ALAC track of an MP4 file, the sample tables are in SDRAM so
+//frame lookup and seeking need no parsing (see mp4SeekSample)
+typedef struct
+{
+	unsigned char cookie[ALAC_COOKIE_SIZE];	//ALACSpecificConfig
+	int haveCookie;
+	int haveAAC;
+	int inAudioTrack;
+	unsigned char* tableMemory;
+	unsigned long tableSize;
+	unsigned long tableUsed;
+	unsigned long* sampleSizes;		//NULL when all samples are sampleSize bytes
+	unsigned long sampleSize;
+	unsigned long sampleCount;
+	unsigned long* chunkOffsets;
+	unsigned long chunkCount;
+	unsigned long* chunkMap;		//stsc entries: first chunk (from 1), samples per chunk, description
+	unsigned long chunkMapCount;
+	//Read position
+	unsigned long sample;
+	unsigned long chunk;
+	unsigned long chunkSample;
+	unsigned long mapIndex;
+	DWORD offset;
+} mp4Track;
+
+//Holds an open track and the first sector read from it by probeFile
+//Decoders read through trackRead so the probed bytes are not read from the drive twice
+//While playing, reads after the header are served from a read-ahead ring (see trackReadAheadStart)
+typedef struct
+{
+	FIL* file;
+	unsigned char header[_MAX_SS];
+	UINT headerLength;
+	UINT headerIndex;
+	int format;
+	unsigned char* ahead;
+	DWORD aheadSize;	//0 when reading straight from the file
+	DWORD aheadStart;	//File offset of the oldest byte still in the ring
+	DWORD aheadEnd;		//File offset the ring is filled to (always file.fptr)
+	DWORD aheadIndex;	//Read position in the file
+} trackStream;
+
+//One directory being read by walkFiles and the length of its path
+typedef struct
+{
+	DIR dir;
+	UINT pathLength;
+} walkLevel;
+
+//Called by walkFiles for each file and directory with its full path and its information in g_fileInfo
+//Anything but FR_OK stops the walk
+typedef FRESULT (*walkVisitor)(char* path, void* context);
+
+//A file found by frag and its number of cluster runs
+typedef struct
+{
+	DWORD runs;
+	DWORD size;
+	char path[charLineSize];
+} fragFile;
+
+//Collects index.txt records so the file is written a whole buffer at a time (see indexWriterAdd)
+typedef struct
+{
+	FIL* file;
+	unsigned char* buffer;
+	UINT length;
+	FRESULT res;		//First error, later records are dropped
+	DWORD trackCount;	//Records added by indexWriterAddTrack
+	DWORD poolSize;		//Bytes used in g_indexPool
+	DWORD strings;		//Strings in g_indexHash
+} indexWriter;
+
+//Start of index.txt, the file is only a valid index when all of it checks out (see indexReadHeader)
+typedef struct
+{
+	char magic[4];		//indexMagic
+	WORD version;		//indexVersion, an index of any other version is built again
+	WORD recordSize;	//sizeof(indexRecord)
+	DWORD trackCount;	//Records after the header
+	DWORD poolOffset;	//File offset of the string pool, right after the records
+	DWORD poolSize;
+	DWORD checksum;		//indexChecksum of the fields above
+} indexHeader;
+
+//A track in index.txt, the strings are offsets in the pool and the path is directory/name
+typedef struct
+{
+	DWORD directory;
+	DWORD name;
+	DWORD title;
+	DWORD artist;
+	DWORD album;
+	BYTE trackNumber;
+	BYTE reserved[3];
+} indexRecord;
+
+//Converts frames of WAV samples at source into 16-bit stereo pairs at destination
+typedef void (*wavConvertFunction)(unsigned char * source, unsigned short * destination, unsigned long frames);
 
 //********************************************
 //************ Prototype Functions ***********
@@ -102,14 +298,76 @@ void configureHW(void);
 void myDelay(unsigned long delay);
 void strToUppercase(char * string);
 void SysTickIntHandler(void);
-static FRESULT scan_files(char* path);
-static FRESULT buildFileIndex (char* path, FIL* openFile);
+static FRESULT scan_files(char* args);
+static FRESULT buildFileIndex (char* path, indexWriter* index);
+FRESULT walkFiles(char* path, int recurse, walkVisitor visit, void* context);
+static FRESULT lsVisit(char* path, void* context);
+static FRESULT indexVisit(char* path, void* context);
+static FRESULT fragVisit(char* path, void* context);
+char* fileInfoName(char* path);
+DWORD fileClusterRuns(FIL* file);
+void fragReport(char* path);
 
 //*********** Audio related ***********
 void I2SintHandler(void);
-int playWAV(char filePath[], unsigned char * scratchMemory, unsigned long scratchLength);
-int playFLAC(char filePath[], unsigned char * scratchMemory, unsigned long scratchLength, int gapless);
+int probeFile(trackStream* track, char filePath[]);
+FRESULT trackRead(trackStream* track, void* buffer, UINT length, UINT* bytesRead);
+FRESULT trackSeek(trackStream* track, DWORD position);
+DWORD trackTell(trackStream* track);
+void trackReadAheadStart(trackStream* track, unsigned char* ring, DWORD size);
+FRESULT trackFill(trackStream* track, UINT* bytesRead);
+UINT trackReadAhead(trackStream* track);
+void fileLinkMap(FIL* file, DWORD* table);
+FRESULT openIndexFile(FIL* file);
+FIL* indexFile(void);
+void closeIndexFile(void);
+FIL* fileHandleGet(void);
+void fileHandlePut(FIL* file);
+FRESULT indexReadHeader(FIL* file, indexHeader* header);
+void loadIndex(void);
+unsigned long indexTrackCount(void);
+void indexReadString(FIL* file, DWORD offset, char* string, UINT size);
+DWORD indexChecksum(const void* data, UINT length);
+FRESULT indexWriterOpen(indexWriter* writer, FIL* file, unsigned char* buffer);
+void indexWriterAdd(indexWriter* writer, void* record, UINT length);
+DWORD indexWriterString(indexWriter* writer, const char* string);
+void indexWriterAddTrack(indexWriter* writer);
+FRESULT indexWriterFlush(indexWriter* writer);
+FRESULT indexWriterClose(indexWriter* writer);
+void printDiskCacheStats(int clear);
+unsigned long benchMicroseconds(void);
+void bench(char* args);
+void benchDisk(char* path);
+void benchOgg(char* path);
+void benchMp3(char* path);
+int playTrack(char filePath[], int gapless);
+int playWAV(trackStream* track, unsigned char * scratchMemory, unsigned long scratchLength);
+int parceWAVheader(trackStream* track, wavFormat* format);
+int playFLAC(trackStream* track, unsigned char * scratchMemory, unsigned long scratchLength, int gapless);
+int playOGG(trackStream* track, unsigned char * scratchMemory, unsigned long scratchLength, int gapless);
+int parceOGGmetadata(trackStream* track, OggStream* stream, VorbisContext* context);
+void parceVorbisComment(unsigned char* block, unsigned long length);
+unsigned long oggReadTrack(void *handle, void *buffer, unsigned long length);
+int playMP3(trackStream* track, unsigned char * scratchMemory, unsigned long scratchLength, int gapless);
+int parceID3tag(trackStream* track);
+void copyID3text(char* destination, unsigned char* frame, unsigned long length);
+int parceMPEGheader(trackStream* track, mpegFormat* format);
+int parceMPEGframe(unsigned char* header, mpegFormat* format);
+int readMPEGframe(trackStream* track, mpegFormat* format, mpegFormat* frame, unsigned char* buffer);
+int playMP4(trackStream* track, unsigned char * scratchMemory, unsigned long scratchLength, int gapless);
+int parceMP4metadata(trackStream* track, mp4Track* mp4, unsigned char* tableMemory, unsigned long tableSize);
+int parceMP4atoms(trackStream* track, mp4Track* mp4, DWORD end);
+void parceMP4tag(trackStream* track, unsigned char* id, unsigned long length);
+void parceMP4sampleDescription(trackStream* track, mp4Track* mp4);
+int parceMP4sampleTable(trackStream* track, mp4Track* mp4, unsigned char* type);
+unsigned long* readMP4table(trackStream* track, mp4Track* mp4, unsigned long count, unsigned long entryWords);
+int mp4SeekSample(mp4Track* mp4, unsigned long sample);
+int mp4NextSample(mp4Track* mp4, DWORD* offset, unsigned long* length);
 void waveOut(void *Buffer, unsigned long numberOfBytes, unsigned int sampleSize);
+void waveBufferFull(void);
+unsigned char * waveOutGetFree(unsigned long * freeBytes);
+void waveOutCommit(unsigned long numberOfBytes);
+void setSampleRate(unsigned long sampleRate);
 
 //*********** xprintf related ***********
 void std_putchar(uint8_t c);
@@ -193,6 +451,15 @@ typedef struct
 } trackInfo;
 
 //A songlist is just an array of indexes into the master index file
+//Each entry also holds the start of the upper case title packed big endian into words (see songKeyMake),
+//so entries are ordered by comparing words and the titles are only compared when the words are equal
+#define songKeyWords 3
+
+typedef struct
+{
+	DWORD key[songKeyWords];
+	unsigned long songIndex;
+} songEntry;
 
 
 typedef struct librarySongNode_s
@@ -234,7 +501,13 @@ static volatile unsigned short *g_libraryDataBase;
 static volatile unsigned short *g_libraryDataCurrent;
 static volatile libraryArtistNode *g_libraryDataArtistHead;
 static volatile libraryAlbumNode *g_libraryDataAlbumHead;
-librarySongNode *g_libraryDataSongHead;
+
+//Song list sorted by title in the library data, see buildSongList
+static songEntry *g_songList;
+static unsigned long g_songCount = 0;
+
+//Current I2S sample rate (set in configureHW)
+unsigned long g_sampleRate = 44100;
 
 //g_playFlag is used to indicate if playing and which buffer is being read
 volatile short g_playFlag = 0;
@@ -252,23 +525,89 @@ volatile unsigned long g_playIndex;
 // Buffer for all decoders
 static unsigned char g_decoderScratch[decoderScatchSize];
 
+//Read-ahead ring for the playing track in SDRAM (readAheadSize bytes, set in configureHW)
+static unsigned char *g_readAheadBuffer;
+
+//Write buffer for index.txt in SDRAM (indexWriteSize bytes, set in configureHW)
+static unsigned char *g_indexWriteBuffer;
+
+//Decoder tables in SDRAM (decoderTableSize bytes, set in configureHW)
+static unsigned char *g_decoderTables;
+
+//File handles in SDRAM (fileHandles of them, set in configureHW) so their sector buffers are not in SRAM
+//Bit n of g_fileHandlesUsed is set while handle n is taken
+static FIL *g_fileHandles;
+static unsigned long g_fileHandlesUsed = 0;
+
+//Directory stack of walkFiles in SDRAM (walkDepth levels, set in configureHW)
+static walkLevel *g_walkStack;
+
+//String pool and its hash table for building index.txt in SDRAM (indexPoolSize bytes and indexHashSize
+//offsets, set in configureHW), a hash table entry is a pool offset + 1 so 0 is free
+static unsigned char *g_indexPool;
+static DWORD *g_indexHash;
+
+//index.txt loaded into g_indexPool by loadIndex, the records and the string pool (0 when it is not loaded)
+static indexRecord *g_indexRecords;
+static char *g_indexStrings;
+
+//Cluster link maps in SDRAM (linkMapSize bytes each, set in configureHW)
+static DWORD *g_trackLinkMap;
+static DWORD *g_indexLinkMap;
+
+//The index link map is kept between opens of index.txt, it is made again when the file changes
+//or the drive is mounted again (the mount id tells another drive with the same layout apart)
+static DWORD g_indexLinkMapCluster = 0;
+static DWORD g_indexLinkMapSize = 0;
+static WORD g_indexLinkMapMount = 0;
+
+//Kept between tracks so the Vorbis IMDCT tables are only rebuilt when the blocksizes change
+VorbisContext g_vorbisContext;
+
+Mp3Context g_mp3Context;
+
+ALACContext g_alacContext;
+
 
 //*********** FatFS Vars *********** 
 FATFS g_FatFs;
 DIR g_dirInfo;
 FILINFO g_fileInfo;
-FIL g_file1;
+#if _USE_LFN
+//Long name of the entry in g_fileInfo (set up in configureHW)
+char g_lfnName[_MAX_LFN + 1];
+#endif
+
+//index.txt is kept open for reading between commands so looking up a track is a seek and a read,
+//it is opened again after the drive is remounted and closed before the index is rebuilt
+FIL* g_indexFile;
+
+//Header of the open index.txt, it is all 0 (no tracks) when index.txt is missing or not a valid index
+indexHeader g_indexHeader;
+
+//Used by the build command to write index.txt
+indexWriter g_indexWriter;
+
+//The track being played or indexed
+trackStream g_track;
 
 //Used for ls command
 DWORD g_acc_size;		
 WORD g_acc_files, g_acc_dirs;
 
+//Used for frag command, g_fragWorst is kept with the most runs first
+fragFile g_fragWorst[fragWorstCount];
+DWORD g_fragFiles, g_fragFragmented, g_fragRuns, g_fragExtra;
+
 
 //*********** General Vars *********** 
 
 //counter for how many systicks have passed
 unsigned long g_sysTickSoftCount;
 
+//system clocks in a microsecond (set in configureHW)
+unsigned long g_clocksPerMicrosecond;
+
 //char array for reading commands on UART, etc
 char g_UART0RxBuffer[UARTRxBufferSize] = "";
 unsigned char g_UART0RxBufferIndex = 0;
@@ -277,7 +616,6 @@ int g_command = NO_COMMAND;
 char g_commandBuffer[UARTRxBufferSize];
 long g_advanceReverse = 0;
 
-char g_searchString[charLineSize];
 //**********************************
 //*********** Functions  *********** 
 //**********************************
@@ -288,248 +626,245 @@ void displayTrackInfo(trackInfo * currentInfo)
 
 
 }
+
+//Fills g_currentTrackInfo with track index (counted from 1) of index.txt, it is left empty when there is no such track
+//Once index.txt is loaded this does not read the drive
 void getTrackInfo(unsigned long index)
 {
-	UINT s1;	
-	f_open(&g_file1, "index.txt", FA_OPEN_EXISTING | FA_READ);
-	f_lseek(&g_file1, g_file1.fptr + (sizeof(g_currentTrackInfo)*(index-1)));
-	f_read(&g_file1, &g_currentTrackInfo, sizeof(g_currentTrackInfo), &s1);
-	f_close(&g_file1);
-
-}
+	indexRecord record;
+	UINT s1, length;
+	FIL* file = NULL;
 
-//looks though all file names for the closest alphabetic match and returns file index
-unsigned long searchSongs(librarySongNode * songListHead, char* searchString)
-{
-	librarySongNode *currentSongNode;
-	currentSongNode = songListHead;
+	memset(&g_currentTrackInfo, 0, sizeof(g_currentTrackInfo));
+	if(g_indexRecords == NULL) file = indexFile();
+	if(index < 1 || index > g_indexHeader.trackCount) return;
 
-	strToUppercase(searchString);
-	xprintf("searching...\n");
-	while(strcmp(searchString, currentSongNode->title) > 0)
+	if(g_indexRecords) record = g_indexRecords[index-1];
+	else
 	{
-		if(currentSongNode->next == NULL) break;
-		currentSongNode = currentSongNode->next;
+		f_lseek(file, sizeof(indexHeader) + sizeof(indexRecord)*(index-1));
+		if(f_read(file, &record, sizeof(record), &s1) != FR_OK || s1 != sizeof(record)) return;
 	}
 
-	return currentSongNode->songIndex;
-
+	indexReadString(file, record.directory, g_currentTrackInfo.path, charLineSize);
+	length = strlen(g_currentTrackInfo.path);
+	g_currentTrackInfo.path[length] = '/';
+	indexReadString(file, record.name, &g_currentTrackInfo.path[length + 1], charLineSize - length - 1);
+	indexReadString(file, record.title, g_currentTrackInfo.title, charLineSize);
+	indexReadString(file, record.artist, g_currentTrackInfo.artist, charLineSize);
+	indexReadString(file, record.album, g_currentTrackInfo.album, charLineSize);
+	g_currentTrackInfo.general[0] = record.trackNumber;
 }
 
-//Indexing will start from 1 into file!!!
-//This allows us to know if it is pointing to nothing
+//Title of track songIndex, from the loaded index or else read into g_currentTrackInfo
+char* songTitle(unsigned long songIndex)
+{
+	if(g_indexRecords) return &g_indexStrings[g_indexRecords[songIndex-1].title];
+
+	getTrackInfo(songIndex);
+	return g_currentTrackInfo.title;
+}
 
-void addTrackToSongList(librarySongNode * songListHead, unsigned long trackIndex)
+//strncmp of two strings as if both had been through strToUppercase
+int strncmpUppercase(const char* a, const char* b, unsigned long length)
 {
-	librarySongNode *currentSongNode, *nextNode, *previousNode;
-	currentSongNode = songListHead;
-	unsigned long seekAmount = 1;
-	unsigned long seekInteration = 0;
-	unsigned long listLength = 0;
-	
-	//xprintf("D");
-	getTrackInfo(trackIndex);
-	strcpy(g_searchString, g_currentTrackInfo.title);
-	strToUppercase(g_searchString);
+	unsigned char ca = 0, cb = 0;
 
-	while(currentSongNode->next != NULL)
+	while(length--)
 	{
-		listLength++;
-		currentSongNode = currentSongNode->next;
+		ca = *a++;
+		cb = *b++;
+		if(ca >= 'a' && ca <= 'z') ca -= 32;
+		if(cb >= 'a' && cb <= 'z') cb -= 32;
+		if(ca == 0 || ca != cb) break;
 	}
-	currentSongNode = songListHead;
 
-	//xprintf("A %d ", listLength);
-	
-	int count = 0;
+	return ca - cb;
+}
 
-	//inital starting point is in the middle of the list
-	seekAmount = listLength/2;
+//strcmp of two strings as if both had been through strToUppercase
+int strcmpUppercase(const char* a, const char* b)
+{
+	return strncmpUppercase(a, b, ~0UL);
+}
 
-	while(count< seekAmount)
-	{
-		if(currentSongNode->next == NULL)break;		
-		currentSongNode = currentSongNode->next;
-		count++;
-	}
-	count = 0;
-	
-	if(currentSongNode->songIndex != 0)
-	{
-		//getTrackInfo(currentSongNode->songIndex);
-		//strToUppercase(g_currentTrackInfo.title);
+//Packs the first songKeyWords*4 characters of the upper case title into the key of entry, 0 padded
+void songKeyMake(songEntry* entry, const char* title)
+{
+	DWORD word = 0;
+	unsigned char c;
+	int i;
 
-		//basically a binary search
-		do		
-		{
-			if(strcmp(g_searchString, currentSongNode->title) > 0)
-			{
-				seekInteration = 0;				
-				while(seekInteration < seekAmount)
-				{
-					if(currentSongNode->next == NULL)
-					{
-						seekAmount = seekInteration/2;
-						break;
-					}
-					currentSongNode = currentSongNode->next;
-					seekInteration++;
-				}
-				//getTrackInfo(currentSongNode->songIndex);
-				//strToUppercase(g_currentTrackInfo.title);
-				//xprintf("a %d", seekAmount);
-				//seekAmount *= 2;
-				//if(!(strcmp(g_searchString, g_currentTrackInfo.title) > 0))
-				seekAmount /= 2;
-			}
-			else
-			{
-				//seekAmount /= 4;
-				seekInteration = 0;				
-				while(seekInteration < seekAmount)
-				{
-					if(currentSongNode->previous == NULL)
-					{
-						seekAmount = seekInteration/2;
-						break;
-					}
-					currentSongNode = currentSongNode->previous;
-					seekInteration++;
-				}
-				//getTrackInfo(currentSongNode->songIndex);
-				//strToUppercase(g_currentTrackInfo.title);
-				//xprintf("c %d", seekAmount);
-				//seekAmount *= 2;
-				//if(seekAmount>2)seekAmount -= 2;
-				//if(strcmp(g_searchString, g_currentTrackInfo.title) > 0)
-				seekAmount /= 2;
-			}			
-			
-			count++;
-		}while(seekAmount);
+	for(i = 0; i < songKeyWords*4; i++)
+	{
+		c = *title;
+		if(c) title++;
+		if(c >= 'a' && c <= 'z') c -= 32;
 
-		//xprintf("%dB", count);
-		//seek backward
-		while(strcmp(g_searchString, currentSongNode->title) < 0)
+		word = (word << 8) | c;
+		if((i & 3) == 3)
 		{
-			if(currentSongNode->previous == NULL)break;
-			currentSongNode = currentSongNode->previous;
-			//getTrackInfo(currentSongNode->songIndex);
-			//strToUppercase(g_currentTrackInfo.title);
-			//xprintf("@");			
+			entry->key[i >> 2] = word;
+			word = 0;
 		}
+	}
+}
 
-		//seek forward
-		while(strcmp(g_searchString, currentSongNode->title) > 0)
-		{
-			//xprintf("!");
-			if(currentSongNode->next == NULL)break;
-			currentSongNode = currentSongNode->next;
-			//getTrackInfo(currentSongNode->songIndex);
-			//strToUppercase(g_currentTrackInfo.title);			
-		}
-		//Normal case is to insert before current node
-		//only not done when reached the end of list
-		if(currentSongNode->next != NULL)
-		{
-			
-			nextNode = currentSongNode;
-			previousNode = currentSongNode->previous;
-			if(currentSongNode == g_libraryDataSongHead)
-			{
-				currentSongNode = (librarySongNode*) g_libraryDataCurrent;
-				g_libraryDataSongHead = currentSongNode;
-			}
-			else currentSongNode = (librarySongNode*) g_libraryDataCurrent;
+//Orders two song list entries as strcmp of their upper case titles would
+//Titles that fill the whole key are told apart from the rest of their titles, which needs the loaded
+//index (otherwise they are left in track order)
+int songCompare(songEntry* a, songEntry* b)
+{
+	int i;
 
-			//move the memory pointer to the next free spot
-			g_libraryDataCurrent = (unsigned short *) &(currentSongNode[1]);
+	for(i = 0; i < songKeyWords; i++)
+	{
+		if(a->key[i] != b->key[i]) return a->key[i] < b->key[i] ? -1 : 1;
+	}
 
-			//Clear the memory in case the RAM is holding old data
-			memset(currentSongNode, 0, sizeof(librarySongNode));
+	if((a->key[songKeyWords-1] & 0xFF) == 0 || g_indexRecords == NULL) return 0;
+	return strcmpUppercase(songTitle(a->songIndex) + songKeyWords*4, songTitle(b->songIndex) + songKeyWords*4);
+}
 
+//Sorts count entries at list by title with a bottom up merge sort, temp has room for as many entries
+//Equal titles stay in track order, returns list or temp, whichever the sorted entries ended up in
+songEntry* songListSort(songEntry* list, songEntry* temp, unsigned long count)
+{
+	songEntry *source = list, *destination = temp, *swap;
+	unsigned long width, start, middle, end, i, j, k;
 
-			//insert node
-			if(previousNode != NULL)
+	for(width = 1; width < count; width *= 2)
+	{
+		for(start = 0; start < count; start += 2*width)
+		{
+			middle = start + width;
+			if(middle > count) middle = count;
+			end = middle + width;
+			if(end > count) end = count;
+
+			i = start;
+			j = middle;
+			k = start;
+			while(i < middle && j < end)
 			{
-				previousNode->next = currentSongNode;
-			}
-			if(nextNode != NULL)
-			{			
-				nextNode->previous = currentSongNode;
+				if(songCompare(&source[j], &source[i]) < 0) destination[k++] = source[j++];
+				else destination[k++] = source[i++];
 			}
-			currentSongNode->next = nextNode;
-			currentSongNode->previous = previousNode;
-
-			//add the trackIndex
-			currentSongNode->songIndex = trackIndex;
-			strcpy(currentSongNode->title, g_searchString);
-
+			while(i < middle) destination[k++] = source[i++];
+			while(j < end) destination[k++] = source[j++];
 		}
-		else
-		{
 
-			nextNode = currentSongNode->next;
-			previousNode = currentSongNode;
-			currentSongNode = (librarySongNode*) g_libraryDataCurrent;
+		swap = source;
+		source = destination;
+		destination = swap;
+	}
 
-			//move the memory pointer to the next free spot
-			g_libraryDataCurrent = (unsigned short *) &(currentSongNode[1]);
+	return source;
+}
 
-			//Clear the memory in case the RAM is holding old data
-			memset(currentSongNode, 0, sizeof(librarySongNode));
+//Builds the song list of every track in index.txt sorted by title
+//The list and the merge sort's second copy of it take the library data, up to the index hash table
+void buildSongList(void)
+{
+	songEntry* list = (songEntry*) g_libraryDataBase;
+	unsigned long count = indexTrackCount();
+	unsigned long i;
 
+	if(count > ((unsigned char*) g_indexHash - (unsigned char*) list) / (2*sizeof(songEntry)))
+	{
+		count = ((unsigned char*) g_indexHash - (unsigned char*) list) / (2*sizeof(songEntry));
+		xprintf("Only the first %lu tracks fit in the song list\n", count);
+	}
 
-			//insert node
-			if(previousNode != NULL)
-			{
-				previousNode->next = currentSongNode;
-			}
-			if(nextNode != NULL)
-			{			
-				nextNode->previous = currentSongNode;
-			}
-			currentSongNode->next = nextNode;
-			currentSongNode->previous = previousNode;
+	for(i = 0; i < count; i++)
+	{
+		list[i].songIndex = i + 1;
+		songKeyMake(&list[i], songTitle(i + 1));
+	}
 
-			//add the trackIndex
-			currentSongNode->songIndex = trackIndex;
-			strcpy(currentSongNode->title, g_searchString);
-		}
+	g_songList = songListSort(list, &list[count], count);
+	g_songCount = count;
+}
 
-	}
-	//Nothing in list yet
-	else
+//Binary search of the song list for the first position whose title compares above prefix in its first
+//length characters (after set) or at or above it (after clear)
+unsigned long songListBound(const char* prefix, unsigned long length, int after)
+{
+	unsigned long low = 0, high = g_songCount, middle;
+	int result;
+
+	while(low < high)
 	{
-		//add the trackIndex
-		currentSongNode->songIndex = trackIndex;
-		strcpy(currentSongNode->title, g_searchString);
-		g_libraryDataCurrent = (unsigned short *) &(currentSongNode[1]);
+		middle = low + (high - low)/2;
+		result = strncmpUppercase(songTitle(g_songList[middle].songIndex), prefix, length);
+		if(result < 0 || (after && result == 0)) low = middle + 1;
+		else high = middle;
 	}
 
-	//xprintf("*");
+	return low;
+}
+
+//Sets [*first, *last) to the positions in the song list of the titles starting with prefix, in any case
+//Titles sort the same as their prefixes do so both ends are binary searches, *first == *last when none match
+void searchSongRange(const char* prefix, unsigned long* first, unsigned long* last)
+{
+	unsigned long length = strlen(prefix);
 
+	*first = songListBound(prefix, length, 0);
+	*last = songListBound(prefix, length, 1);
 }
 
+//Finds the closest alphabetic match to the title, the first title at or after it, and returns its file index
+//(the last title if all come before it, 0 with no songs)
+unsigned long searchSongs(char* searchString)
+{
+	unsigned long position;
+
+	if(g_songCount == 0) return 0;
 
+	position = songListBound(searchString, strlen(searchString), 0);
+	if(position == g_songCount) position--;
 
+	return g_songList[position].songIndex;
+}
 
+//Prints the titles from position first up to last of the song list
+void printSongList(unsigned long first, unsigned long last)
+{
+	unsigned long i;
 
+	for(i = first; i < last; i++)
+	{
+		xprintf("%s\n", songTitle(g_songList[i].songIndex));
+	}
+}
 
-void printSongList(librarySongNode * songListHead)
+//Plays the queue from position first up to last, tracks of the song list when songs is set or else of index.txt
+//An a <x> moves the queue on, going past either end or an eq ends it
+void playQueue(unsigned long first, unsigned long last, int songs)
 {
-	librarySongNode* currentSongNode;
-	currentSongNode = songListHead;
-	while(currentSongNode->next != NULL)
+	unsigned long position = first;
+
+	while(position >= first && position < last)
 	{
-		//getTrackInfo(currentSongNode->songIndex);
-		//displayTrackInfo(&g_currentTrackInfo);
-		xprintf("%s\n", currentSongNode->title);
-		currentSongNode = currentSongNode->next;
+		getTrackInfo(songs ? g_songList[position].songIndex : position + 1);
+		displayTrackInfo(&g_currentTrackInfo);
+		xprintf("play: %s\n", g_currentTrackInfo.path);
+		if(g_advanceReverse != 0)
+		{
+			//skip to the track advanced to
+			position += g_advanceReverse;
+			g_advanceReverse = 0;
+		}
+		else
+		{
+			playTrack(g_currentTrackInfo.path, 1);
+			position++;
+		}
+
+		//end queue?
+		if(g_command == END_QUEUE_COMMAND)break;
 	}
-	xprintf("%s\n", currentSongNode->title);
-	//getTrackInfo(currentSongNode->songIndex);
-	//displayTrackInfo(&g_currentTrackInfo);
 }
 
 
@@ -552,7 +887,7 @@ void processCommand(char * commandBuffer)
 		strcpy(g_commandBuffer, command);
 		g_command = PLAY_COMMAND;
 	}
-	//ls <path> lists files/dirs in <path>
+	//ls [-r] <path> lists files/dirs in <path> (-r lists the sub-directories too)
 	else if(commandBuffer[0] == 'l' && commandBuffer[1] == 's')
 	{	
 		command = &g_UART0RxBuffer[2];
@@ -560,6 +895,21 @@ void processCommand(char * commandBuffer)
 		strcpy(g_commandBuffer, command);
 		g_command = LS_COMMAND;
 	}
+	//frag [path] reports how fragmented the files under path are
+	else if(strncmp(commandBuffer, "frag", 4) == 0)
+	{
+		command = &g_UART0RxBuffer[4];
+		if(command[0] == ' ')command = &g_UART0RxBuffer[5];
+		strcpy(g_commandBuffer, command);
+		g_command = FRAG_COMMAND;
+	}
+	//bench disk [file] times reads from the drive and through FatFs, bench ogg <file> and bench mp3 <file>
+	//time the Vorbis and MP3 decoders
+	else if(strncmp(commandBuffer, "bench", 5) == 0)
+	{
+		strcpy(g_commandBuffer, &g_UART0RxBuffer[5]);
+		g_command = BENCH_COMMAND;
+	}
 	//(b)uilds file index into index.txt in root of drive
 	else if(commandBuffer[0] == 'b')
 	{
@@ -597,8 +947,12 @@ void processCommand(char * commandBuffer)
 		xatoi(&convert, &g_advanceReverse);	
 		g_command = ADVANCE_COMMAND;
 	}
+	//s [prefix] lists the songs by title, only those starting with prefix if given
 	else if(commandBuffer[0] == 's' && (commandBuffer[1] == ' ' || commandBuffer[1] == '\0'))
 	{	
+		command = &g_UART0RxBuffer[1];
+		if(command[0] == ' ')command = &g_UART0RxBuffer[2];
+		strcpy(g_commandBuffer, command);
 		g_command = SONGLIST_COMMAND;
 	}
 
@@ -611,11 +965,28 @@ void processCommand(char * commandBuffer)
 		g_command = SEARCH_PLAY_COMMAND;
 	}
 
+	//sq <prefix> plays every song starting with prefix in title order
+	else if(commandBuffer[0] == 's' && commandBuffer[1] == 'q')
+	{	
+		command = &g_UART0RxBuffer[2];
+		if(command[0] == ' ')command = &g_UART0RxBuffer[3];
+		strcpy(g_commandBuffer, command);
+		//an a <x> sent while nothing was queued must not skip into the new queue
+		g_advanceReverse = 0;
+		g_command = SEARCH_QUEUE_COMMAND;
+	}
+
 	//ends playing the current queue
 	else if(commandBuffer[0] == 'e'&& commandBuffer[1] == 'q')
 	{		
 		g_command = END_QUEUE_COMMAND;
 	}
+	//dc [r] prints the disk cache counters (r clears them after)
+	else if(commandBuffer[0] == 'd' && commandBuffer[1] == 'c')
+	{
+		strcpy(g_commandBuffer, &g_UART0RxBuffer[2]);
+		g_command = DISK_CACHE_COMMAND;
+	}
 	//everything else is bad
 	else g_command = BAD_COMMAND;
 
@@ -650,6 +1021,7 @@ int main(void)
 			if(f_opendir(&g_dirInfo, "/") == FR_OK)
 			{
 				xprintf("Drive Mounted\n");
+				loadIndex();
 				//It worked to say the drive is ready								
 				g_usbDeviceState = DEVICE_READY;
 				xprintf("> ");	
@@ -660,26 +1032,15 @@ int main(void)
 		//We are here in normal player mode handles commands without interupting interupts
 		else if(g_usbDeviceState == DEVICE_READY)			
 		{
-			int length;
-			UINT s1;
-
-
-			unsigned long songCount;
+			unsigned long songFirst, songLast;
 			unsigned long songIndex;
+			FIL* file;
 
 			switch(g_command)
 			{
 				case PLAY_COMMAND:			
-				length = strlen(g_commandBuffer);				
-				xprintf("play: %s extension: %s\n", g_commandBuffer, &g_commandBuffer[length-3]);
-				if(memcmp(&g_commandBuffer[length-3], "FLA", 3) == 0)
-				{
-					playFLAC(g_commandBuffer,g_decoderScratch, decoderScatchSize, 0);
-				}
-				else if(memcmp(&g_commandBuffer[length-3], "WAV", 3) == 0)
-				{					
-					playWAV(g_commandBuffer,g_decoderScratch, decoderScatchSize);
-				}
+				xprintf("play: %s\n", g_commandBuffer);
+				playTrack(g_commandBuffer, 0);
 				xprintf("> ");
 				g_command = NO_COMMAND;
 				break;
@@ -691,80 +1052,55 @@ int main(void)
 				break;
 				
 				case BUILD_COMMAND:
-				f_open(&g_file1, "index.txt", FA_CREATE_ALWAYS | FA_WRITE);
-				buildFileIndex(g_commandBuffer, &g_file1);
-				f_close(&g_file1);
+				closeIndexFile();
+				g_indexLinkMapCluster = 0;
+				file = fileHandleGet();
+				if(file && indexWriterOpen(&g_indexWriter, file, g_indexWriteBuffer) == FR_OK)
+				{
+					buildFileIndex(g_commandBuffer, &g_indexWriter);
+					if(indexWriterClose(&g_indexWriter) != FR_OK) xprintf("Cannot write index.txt\n");
+				}
+				else xprintf("Cannot open: index.txt\n");
+				fileHandlePut(file);
+				loadIndex();
+				xprintf("%lu tracks indexed\n", indexTrackCount());
 				xprintf("> ");
 				g_command = NO_COMMAND;
 				break;
 
 				case PLAY_QUEUE_COMMAND:
-				songIndex = 1;
-				f_open(&g_file1, "index.txt", FA_OPEN_EXISTING | FA_READ);
-				f_read(&g_file1, &g_currentTrackInfo, sizeof(g_currentTrackInfo), &s1);
-				while(s1 > 0)
-				{	
-					displayTrackInfo(&g_currentTrackInfo);				
-					length = strlen(g_currentTrackInfo.path);				
-					xprintf("play: %s extension: %s\n", g_currentTrackInfo.path, &g_currentTrackInfo.path[length-3]);				if(g_advanceReverse != 0)
-					{
-						//correct offset						
-						g_advanceReverse-=1;						
-						while(g_advanceReverse != 0)
-						{					
-							if(g_advanceReverse > 0)
-							{
-								g_advanceReverse--;
-								f_lseek(&g_file1, g_file1.fptr + sizeof(g_currentTrackInfo));
-							}
-							else
-							{
-								g_advanceReverse++;
-								f_lseek(&g_file1, g_file1.fptr - sizeof(g_currentTrackInfo));
-							}
-						}
-					}
-					else if(memcmp(&g_currentTrackInfo.path[length-3], "FLA", 3) == 0)
-					{
-						playFLAC(g_currentTrackInfo.path,g_decoderScratch, decoderScatchSize, 1);
-					}
-					else if(memcmp(&g_currentTrackInfo.path[length-3], "WAV", 3) == 0)
-					{					
-						playWAV(g_currentTrackInfo.path,g_decoderScratch, decoderScatchSize);
-					}
-					f_read(&g_file1, &g_currentTrackInfo, sizeof(g_currentTrackInfo), &s1);
-
-					//end queue?
-					if(g_command == END_QUEUE_COMMAND)break;
-				}
-				f_close(&g_file1);
+				playQueue(0, indexTrackCount(), 0);
 				xprintf("> ");				
 				g_command = NO_COMMAND;
 				break;
 
 				case SONGLIST_COMMAND:
-				songIndex = 1;
-				g_libraryDataSongHead = (librarySongNode *) g_libraryDataCurrent;
-
-				//Make sure the inital node is blank
-				memset(g_libraryDataSongHead, 0, sizeof(librarySongNode));
-
-				f_open(&g_file1, "index.txt", FA_OPEN_EXISTING | FA_READ);
-				songCount = f_size(&g_file1)/sizeof(g_currentTrackInfo);
-				f_close(&g_file1);
+				//the list lasts until the index is loaded again
+				if(g_songCount == 0) buildSongList();
+				searchSongRange(g_commandBuffer, &songFirst, &songLast);
+				printSongList(songFirst, songLast);
+				xprintf("> ");
+				g_command = NO_COMMAND;
+				break;
 
-				while(songIndex <= songCount)
-				{
-					addTrackToSongList(g_libraryDataSongHead, songIndex);
-					songIndex++;
-				}
-				printSongList(g_libraryDataSongHead);
+				case SEARCH_QUEUE_COMMAND:
+				if(g_songCount == 0) buildSongList();
+				searchSongRange(g_commandBuffer, &songFirst, &songLast);
+				xprintf("%lu songs\n", songLast - songFirst);
+				playQueue(songFirst, songLast, 1);
 				xprintf("> ");
 				g_command = NO_COMMAND;
 				break;
 
 				case SEARCH_PLAY_COMMAND:
-				songIndex = searchSongs(g_libraryDataSongHead, g_commandBuffer);
+				if(g_songCount == 0) buildSongList();
+				songIndex = searchSongs(g_commandBuffer);
+				if(songIndex == 0)
+				{
+					xprintf("No songs\n> ");
+					g_command = NO_COMMAND;
+					break;
+				}
 				xprintf("Song Index: %d\n", songIndex);
 				getTrackInfo(songIndex);
 				displayTrackInfo(&g_currentTrackInfo);
@@ -772,6 +1108,24 @@ int main(void)
 				//xprintf("> ");
 				g_command = PLAY_COMMAND;
 				break;
+
+				case DISK_CACHE_COMMAND:
+				printDiskCacheStats(strchr(g_commandBuffer, 'r') != NULL);
+				xprintf("> ");
+				g_command = NO_COMMAND;
+				break;
+
+				case BENCH_COMMAND:
+				bench(g_commandBuffer);
+				xprintf("> ");
+				g_command = NO_COMMAND;
+				break;
+
+				case FRAG_COMMAND:
+				fragReport(g_commandBuffer);
+				xprintf("> ");
+				g_command = NO_COMMAND;
+				break;
 				
 				case BAD_COMMAND:
 				xprintf("> ");
@@ -793,304 +1147,1441 @@ int main(void)
 }
 
 
-//This function takes a PCM buffer pointer, the length of the buffer in bytes and the size of a sample in bits
-//Currently sampleSize is ignored and 16 bit audio only is supported
-void waveOut(void *Buffer, unsigned long numberOfBytes, unsigned int sampleSize)
+//Marks the wave buffer being filled as full and hands it over to the I2S interupt
+void waveBufferFull(void)
 {
-	unsigned long bytesLeft;
-	unsigned long chuckIndex = 0;
-	volatile int i = 0;
-	void * memPointer;
-	unsigned char * Chunk;
-
-	Chunk = (unsigned char *) Buffer;
-
-	bytesLeft = numberOfBytes;
+	g_waveBufferIndex = 0;
 
-	while (bytesLeft > ((waveBufferSize - g_waveBufferIndex)*2))
+	switch(g_bufferFlag)
 	{
-		switch(g_bufferFlag)
-		{
-			case 0:
-			memPointer = (void *) &g_waveBufferA[g_waveBufferIndex];
-			memcpy(memPointer, &Chunk[chuckIndex], ((waveBufferSize - g_waveBufferIndex)*2));
-			chuckIndex += ((waveBufferSize - g_waveBufferIndex)*2);
-			bytesLeft -= ((waveBufferSize - g_waveBufferIndex)*2);
-			g_waveBufferIndex = 0;
-			g_bufferFlag = 2;
-			g_playIndex = 0;	
-			g_playFlag = 1;
-			break;
-
-			case 1:
-			memPointer = (void *) &g_waveBufferA[g_waveBufferIndex];
-			memcpy(memPointer, &Chunk[chuckIndex], ((waveBufferSize - g_waveBufferIndex)*2));
-			chuckIndex += ((waveBufferSize - g_waveBufferIndex)*2);
-			bytesLeft -= ((waveBufferSize - g_waveBufferIndex)*2);
-			g_waveBufferIndex = 0;
-			g_bufferFlag = 3;
-			//xprintf("\nA Full");
-			break;
+		case 0:
+		g_bufferFlag = 2;
+		g_playIndex = 0;	
+		g_playFlag = 1;
+		break;
 
-			case 2:					
-			memPointer = (void *) &g_waveBufferB[g_waveBufferIndex];
-			memcpy(memPointer, &Chunk[chuckIndex], ((waveBufferSize - g_waveBufferIndex)*2));
-			chuckIndex += ((waveBufferSize - g_waveBufferIndex)*2);
-			bytesLeft -= ((waveBufferSize - g_waveBufferIndex)*2);
-			g_waveBufferIndex = 0;
-			g_bufferFlag = 3;
-			//xprintf("\nB Full");
-			break;
+		case 1:
+		case 2:
+		g_bufferFlag = 3;
+		break;
 
-			case 3:
-			//do nothing everything is full
-			break;
-			default:
-			break;
-		}
+		default:
+		break;
 	}
-	
+}
+
+//Returns a pointer to the free region of the wave buffer being filled, the size in bytes is put in freeBytes
+//Waits until a buffer is free if both are full
+//Decoders can write PCM straight into the region and then call waveOutCommit
+unsigned char * waveOutGetFree(unsigned long * freeBytes)
+{
+	volatile int i = 0;
+	volatile unsigned short * waveBuffer;
+
 	// Must wait for somewhere to put the data!
-	i = 0;
 	while(g_bufferFlag == 3)
 	{
 		if (i == 0) ROM_GPIOPinWrite(GPIO_PORTB_BASE, GPIO_PIN_5, 0xFF);	//LED toggle	
 		i++;
+
+		//Use the wait to read the playing track ahead
+		trackReadAhead(&g_track);
 	}
 	ROM_GPIOPinWrite(GPIO_PORTB_BASE, GPIO_PIN_5, 0x00);	//LED toggle
 
-	switch(g_bufferFlag)
-	{
-		case 0:
-		case 1:		
-		memPointer = (void *) &g_waveBufferA[g_waveBufferIndex];
-		memcpy(memPointer, &Chunk[chuckIndex], bytesLeft);
-		g_waveBufferIndex += bytesLeft/2;
-
-		break;
+	if(g_bufferFlag == 2) waveBuffer = g_waveBufferB;
+	else waveBuffer = g_waveBufferA;
 
-		case 2:		
-		memPointer = (void *) &g_waveBufferB[g_waveBufferIndex];
-		memcpy(memPointer, &Chunk[chuckIndex], bytesLeft);
-		g_waveBufferIndex += bytesLeft/2;
+	*freeBytes = (waveBufferSize - g_waveBufferIndex)*2;
 
-		break;
+	return (unsigned char *) &waveBuffer[g_waveBufferIndex];
+}
 
-		default:
-		break;
-	}
+//Adds numberOfBytes written to the region given by waveOutGetFree to the wave buffer
+void waveOutCommit(unsigned long numberOfBytes)
+{
+	g_waveBufferIndex += numberOfBytes/2;
 	
+	if(g_waveBufferIndex >= waveBufferSize) waveBufferFull();
+}
 
-
-} 
-
-//*********** DECODERS ***********
-
-//Very simple just dumps PCM samples to the waveOUT from a file assumes 16-bit at this time
-//TODO support other sample rates
-int playWAV(char filePath[], unsigned char * scratchMemory, unsigned long scratchLength)
+//Changes the I2S master clock to suit a new sample rate (MCLK = 256 * sample rate)
+void setSampleRate(unsigned long sampleRate)
 {
+	if(sampleRate == 0 || sampleRate == g_sampleRate) return;
 
+	SysCtlI2SMClkSet(0, sampleRate * 16 * 16);
+	g_sampleRate = sampleRate;
+}
 
-	UINT s1 = 0;
-	FRESULT res;
-	FIL file1;
-	unsigned char * Buff;
-	unsigned long readSize;
+//This function takes a PCM buffer pointer, the length of the buffer in bytes and the size of a sample in bits
+//Currently sampleSize is ignored and 16 bit audio only is supported
+void waveOut(void *Buffer, unsigned long numberOfBytes, unsigned int sampleSize)
+{
+	unsigned long bytesLeft, freeBytes;
+	unsigned long chuckIndex = 0;
+	unsigned char * memPointer;
+	unsigned char * Chunk;
 
-	Buff = scratchMemory;
-	g_endPlayBack = 0;
-	
-	if(scratchLength < 4096)
+	Chunk = (unsigned char *) Buffer;
+
+	bytesLeft = numberOfBytes;
+
+	while(bytesLeft)
 	{
-		readSize = scratchLength;
+		memPointer = waveOutGetFree(&freeBytes);
+		if(freeBytes > bytesLeft) freeBytes = bytesLeft;
+
+		memcpy(memPointer, &Chunk[chuckIndex], freeBytes);
+		waveOutCommit(freeBytes);
+
+		chuckIndex += freeBytes;
+		bytesLeft -= freeBytes;
 	}
-	else readSize = 4096;
+} 
 
-	res = f_open(&file1, filePath, FA_OPEN_EXISTING | FA_READ);
-	xprintf("Opening: %s\nPlaying...\n", filePath);
+//*********** DECODERS ***********
 
-	// read a whole file until done
-	g_playFlag = 0;
-	g_bufferFlag = 0;
-	//Read Header
-	res = f_read(&file1, Buff, 44, &s1);
+//Opens filePath and reads its first sector to find the audio format from the magic bytes
+//The file is left open in track for the decoder unless FORMAT_UNKNOWN is returned
+//There is no link map yet, indexing only reads the start of each file (playTrack makes one)
+int probeFile(trackStream* track, char filePath[])
+{
+	unsigned char* header;
+
+	track->format = FORMAT_UNKNOWN;
+	track->headerLength = 0;
+	track->headerIndex = 0;
+	track->aheadSize = 0;
 
-	if(s1 > 0 )
+	if(f_open(track->file, filePath, FA_OPEN_EXISTING | FA_READ) != FR_OK)
 	{
-		do
+		xprintf("Cannot open: %s\n", filePath);
+		return FORMAT_UNKNOWN;
+	}
+
+	//A whole sector goes straight into header without a copy through the FIL buffer
+	if(f_read(track->file, track->header, _MAX_SS, &track->headerLength) != FR_OK || track->headerLength < 4)
+	{
+		xprintf("Read failure\n");
+		f_close(track->file);
+		return FORMAT_UNKNOWN;
+	}
+
+	header = track->header;
+
+	if(memcmp(header, "fLaC", 4) == 0)
+	{
+		track->format = FORMAT_FLAC;
+	}
+	else if(memcmp(header, "RIFF", 4) == 0 && track->headerLength >= 12 && memcmp(&header[8], "WAVE", 4) == 0)
+	{
+		track->format = FORMAT_WAV;
+	}
+	else if(memcmp(header, "OggS", 4) == 0)
+	{
+		track->format = FORMAT_OGG;
+	}
+	//MP4 files start with an 'ftyp' atom
+	else if(track->headerLength >= 8 && memcmp(&header[4], "ftyp", 4) == 0)
+	{
+		track->format = FORMAT_MP4;
+	}
+	//ID3v2 tag or an MPEG audio frame sync (11 set bits, layer not reserved)
+	else if(memcmp(header, "ID3", 3) == 0 || (header[0] == 0xFF && (header[1] & 0xE0) == 0xE0 && (header[1] & 0x06) != 0))
+	{
+		track->format = FORMAT_MP3;
+	}
+	else
+	{
+		f_close(track->file);
+	}
+
+	return track->format;
+}
+
+//Reads from a probed track, bytes still in the probe header are used before reading the file
+FRESULT trackRead(trackStream* track, void* buffer, UINT length, UINT* bytesRead)
+{
+	UINT headerBytes = 0;
+	UINT s1 = 0;
+	FRESULT res = FR_OK;
+
+	if(track->headerIndex < track->headerLength)
+	{
+		headerBytes = track->headerLength - track->headerIndex;
+		if(headerBytes > length) headerBytes = length;
+
+		memcpy(buffer, &track->header[track->headerIndex], headerBytes);
+		track->headerIndex += headerBytes;
+	}
+
+	if(length > headerBytes && track->aheadSize)
+	{
+		unsigned char* destination = (unsigned char*) buffer + headerBytes;
+		UINT copyBytes, filled;
+		DWORD ringIndex;
+
+		length -= headerBytes;
+		while(s1 < length)
 		{
+			//Refill straight away if the idle time was not enough to stay ahead, after a seek the
+			//ring restarts on a sector boundary and the read position can still be past its end
+			if(track->aheadIndex >= track->aheadEnd)
+			{
+				res = trackFill(track, &filled);
+				if(res != FR_OK || filled == 0) break;
+				continue;
+			}
 
-			res = f_read(&file1, Buff, readSize, &s1);     // Read a chunk of src file
-			waveOut(Buff, s1, 16);
-	
-		} while((res || s1 != 0) && g_endPlayBack != 1);
-	}	
+			ringIndex = track->aheadIndex & (track->aheadSize - 1);
+			copyBytes = length - s1;
+			if(copyBytes > track->aheadEnd - track->aheadIndex) copyBytes = track->aheadEnd - track->aheadIndex;
+			if(copyBytes > track->aheadSize - ringIndex) copyBytes = track->aheadSize - ringIndex;
 
-	f_close(&file1);	
+			memcpy(&destination[s1], &track->ahead[ringIndex], copyBytes);
+			track->aheadIndex += copyBytes;
+			s1 += copyBytes;
+		}
+	}
+	else if(length > headerBytes)
+	{
+		res = f_read(track->file, (unsigned char*) buffer + headerBytes, length - headerBytes, &s1);
+	}
 
-	xprintf("\nClosing File, %d\n", res);
+	*bytesRead = headerBytes + s1;
+	return res;
+}
 
-	//Clear the buffers
-	int i;
-	for(i=0; i < readSize; i++)
+//Moves the read position of a probed track, positions inside the probe header need no file access
+FRESULT trackSeek(trackStream* track, DWORD position)
+{
+	if(position < track->headerLength)
 	{
-		Buff[i] = 0;
+		track->headerIndex = position;
+		position = track->headerLength;
 	}
-	for(i=0; i <=waveBufferSize*4; i += readSize)
+	else track->headerIndex = track->headerLength;
+
+	if(track->aheadSize)
 	{
-		waveOut(Buff, readSize, 16);
+		FRESULT res = FR_OK;
+
+		//Seeks inside what is still in the ring are free, anything else starts it again from the
+		//sector holding position, so the fills stay whole sectors that FatFs reads straight into the ring
+		if(position < track->aheadStart || position > track->aheadEnd)
+		{
+			if(position > track->file->fsize) position = track->file->fsize;
+			res = f_lseek(track->file, position & ~(DWORD)(_MAX_SS - 1));
+			track->aheadStart = track->aheadEnd = track->file->fptr;
+			if(res != FR_OK) position = track->file->fptr;
+		}
+		track->aheadIndex = position;
+		return res;
 	}
-	g_playFlag = 0;
-	g_waveBufferIndex = 0;
 
-	return 0;
+	if(track->file->fptr == position) return FR_OK;
+
+	return f_lseek(track->file, position);
 }
 
+//Returns the read position of a probed track
+DWORD trackTell(trackStream* track)
+{
+	if(track->headerIndex < track->headerLength) return track->headerIndex;
 
-//This function creates the FLACContext the file at filePath
-//Called by main FLAC decoder
-//See http://flac.sourceforge.net/format.html for FLAC format details
-//0 context is valid; 1 context is not valid
-int parceFLACmetadata(char filePath[], FLACContext* context)
+	if(track->aheadSize) return track->aheadIndex;
+
+	return track->file->fptr;
+}
+
+//Serves the reads of a probed track after its header from a ring of size bytes (a power of two,
+//a multiple of readAheadChunk), which trackReadAhead fills while the wave buffers are full
+//Can be started part way through the file, the ring then starts on the sector holding the read position
+void trackReadAheadStart(trackStream* track, unsigned char* ring, DWORD size)
+{
+	track->ahead = ring;
+	track->aheadIndex = track->file->fptr;
+	if(f_lseek(track->file, track->aheadIndex & ~(DWORD)(_MAX_SS - 1)) != FR_OK) track->aheadIndex = track->file->fptr;
+	track->aheadStart = track->aheadEnd = track->file->fptr;
+	track->aheadSize = size;
+}
+
+//Reads the track on to the next readAheadChunk boundary into the ring, dropping the oldest bytes
+//The ring starts on a sector boundary, so every fill but the last one of the file is whole sectors
+//Chunks are whole clusters for most drives, so with the link map and FatFs reading runs of
+//adjacent clusters in one go this is normally a single transfer with no FAT reads
+FRESULT trackFill(trackStream* track, UINT* bytesRead)
+{
+	FRESULT res;
+	UINT length;
+
+	length = readAheadChunk - (track->aheadEnd & (readAheadChunk - 1));
+	res = f_read(track->file, &track->ahead[track->aheadEnd & (track->aheadSize - 1)], length, bytesRead);
+
+	track->aheadEnd += *bytesRead;
+	if(track->aheadEnd - track->aheadStart > track->aheadSize) track->aheadStart = track->aheadEnd - track->aheadSize;
+
+	return res;
+}
+
+//Called while waiting for a free wave buffer, reads one more chunk of the playing track if the
+//ring has room for it without dropping bytes not read yet, returns the bytes read
+UINT trackReadAhead(trackStream* track)
 {
 	UINT s1 = 0;
-	FIL FLACfile;
-	int metaDataFlag = 1;
-	char metaDataChunk[128];	
-	unsigned long metaDataBlockLength = 0;
-	char* tagContents;
 
+	if(track->aheadSize == 0 || track->aheadEnd >= track->file->fsize || track->aheadIndex > track->aheadEnd) return 0;
+	if(track->aheadEnd - track->aheadIndex + readAheadChunk > track->aheadSize) return 0;
+
+	if(trackFill(track, &s1) != FR_OK) return 0;
+
+	return s1;
+}
+
+//Gives a file opened for reading a cluster link map table (linkMapSize bytes) so f_lseek and f_read find
+//clusters with a table lookup instead of following the FAT chain from the start cluster
+//The map is made by one walk of the chain, a file too fragmented for the table keeps normal seeking
+void fileLinkMap(FIL* file, DWORD* table)
+{
+	file->cltbl = table;
+	table[0] = linkMapSize / sizeof(DWORD);
+
+	if(f_lseek(file, CREATE_LINKMAP) != FR_OK) file->cltbl = 0;
+}
+
+//Opens index.txt for reading with its link map, which is only made again after the index is rebuilt
+FRESULT openIndexFile(FIL* file)
+{
+	FRESULT res;
 
-	if(f_open(&FLACfile, filePath, FA_READ) != FR_OK)
+	res = f_open(file, "index.txt", FA_OPEN_EXISTING | FA_READ);
+	if(res != FR_OK) return res;
+
+	if(g_indexLinkMapCluster == file->sclust && g_indexLinkMapSize == file->fsize && g_indexLinkMapMount == file->id)
 	{
-		xprintf("Could not open: %s\n", filePath);
-		return 1;
+		file->cltbl = g_indexLinkMap;
+		return FR_OK;
 	}
 
-	f_read(&FLACfile, metaDataChunk, 4, &s1);
-	
-	if(s1 != 4)
+	fileLinkMap(file, g_indexLinkMap);
+	if(file->cltbl)
 	{
-		xprintf("Read failure\n");
-		f_close(&FLACfile);
-		return 1;
+		g_indexLinkMapCluster = file->sclust;
+		g_indexLinkMapSize = file->fsize;
+		g_indexLinkMapMount = file->id;
 	}
+	else g_indexLinkMapCluster = 0;
 
-	if(memcmp(metaDataChunk, "fLaC", 4) != 0)
+	return FR_OK;
+}
+
+//Returns index.txt opened for reading, the open handle is reused until the drive is remounted
+//If index.txt can not be opened the handle is left invalid and reads from it fail
+//g_indexHeader is read with it and has no tracks when the file is not a valid index
+FIL* indexFile(void)
+{
+	if(g_indexFile->fs && g_FatFs.fs_type && g_indexFile->id == g_FatFs.id) return g_indexFile;
+
+	memset(&g_indexHeader, 0, sizeof(g_indexHeader));
+	if(openIndexFile(g_indexFile) == FR_OK && indexReadHeader(g_indexFile, &g_indexHeader) != FR_OK)
 	{
-		xprintf("Not a FLAC file\n");
-		f_close(&FLACfile);
-		return 1;
+		memset(&g_indexHeader, 0, sizeof(g_indexHeader));
+		xprintf("index.txt is from an older version or incomplete, build it again\n");
 	}
-	
-	// Now we are at the stream block
-	// Each block has metadata header of 4 bytes
-	do
+	return g_indexFile;
+}
+
+//Reads the header of index.txt, FR_INVALID_OBJECT when it is not a whole index of this version
+FRESULT indexReadHeader(FIL* file, indexHeader* header)
+{
+	FRESULT res;
+	UINT s1;
+
+	res = f_lseek(file, 0);
+	if(res == FR_OK) res = f_read(file, header, sizeof(indexHeader), &s1);
+	if(res != FR_OK) return res;
+
+	if(s1 != sizeof(indexHeader) || memcmp(header->magic, indexMagic, 4) != 0) return FR_INVALID_OBJECT;
+	if(header->checksum != indexChecksum(header, sizeof(indexHeader) - sizeof(header->checksum))) return FR_INVALID_OBJECT;
+	if(header->version != indexVersion || header->recordSize != sizeof(indexRecord)) return FR_INVALID_OBJECT;
+	if(header->poolOffset != sizeof(indexHeader) + header->trackCount * sizeof(indexRecord)) return FR_INVALID_OBJECT;
+	if(header->poolOffset + header->poolSize != f_size(file)) return FR_INVALID_OBJECT;
+
+	return FR_OK;
+}
+
+//Reads all of index.txt into g_indexPool with one f_read, after that track lookups, the song list, searches
+//and the play queue do not read the drive for track information
+//An index bigger than indexPoolSize is left to be read from the file
+void loadIndex(void)
+{
+	FIL* file;
+	DWORD size;
+	UINT s1;
+
+	g_indexRecords = NULL;
+	g_indexStrings = NULL;
+	g_songCount = 0;
+
+	file = indexFile();
+	if(g_indexHeader.trackCount == 0) return;
+
+	size = f_size(file);
+	if(size > indexPoolSize)
 	{
-		f_read(&FLACfile, metaDataChunk, 4, &s1);
-	
-		if(s1 != 4)
-		{
-			xprintf("Read failure\n");
-			f_close(&FLACfile);
-			return 1;
-		}
+		xprintf("index.txt is too big to load, tracks are read from the drive\n");
+		return;
+	}
 
-		//Check if last chunk
-		if(metaDataChunk[0] & 0x80) metaDataFlag = 0;
+	if(f_lseek(file, 0) != FR_OK || f_read(file, g_indexPool, size, &s1) != FR_OK || s1 != size) return;
+	if(memcmp(g_indexPool, &g_indexHeader, sizeof(indexHeader)) != 0) return;
 
-		metaDataBlockLength = (metaDataChunk[1] << 16) | (metaDataChunk[2] << 8) | metaDataChunk[3];
+	g_indexRecords = (indexRecord *) &g_indexPool[sizeof(indexHeader)];
+	g_indexStrings = (char *) &g_indexPool[g_indexHeader.poolOffset];
+	xprintf("Library: %lu tracks\n", g_indexHeader.trackCount);
+}
 
-		//STREAMINFO block
-		if((metaDataChunk[0] & 0x7F) == 0)
+//Number of tracks in index.txt
+unsigned long indexTrackCount(void)
+{
+	if(g_indexRecords == NULL) indexFile();
+	return g_indexHeader.trackCount;
+}
+
+//Copies the string at offset in the pool of index.txt into string (size bytes), cut to fit
+//It is read from file when the index is not loaded
+void indexReadString(FIL* file, DWORD offset, char* string, UINT size)
+{
+	UINT s1 = 0;
+
+	if(g_indexStrings)
+	{
+		while(s1 < size - 1 && g_indexStrings[offset + s1])
 		{
-						
-			if(metaDataBlockLength > 128)
-			{
-				xprintf("Metadata buffer too small\n");
-				f_close(&FLACfile);
-				return 1;
-			}
+			string[s1] = g_indexStrings[offset + s1];
+			s1++;
+		}
+	}
+	else if(f_lseek(file, g_indexHeader.poolOffset + offset) == FR_OK) f_read(file, string, size - 1, &s1);
+	string[s1] = '\0';
+}
 
-			f_read(&FLACfile, metaDataChunk, metaDataBlockLength, &s1);
+//FNV-1a hash of length bytes at data, checks the index header and spreads the pool strings over g_indexHash
+DWORD indexChecksum(const void* data, UINT length)
+{
+	const unsigned char* bytes = (const unsigned char*) data;
+	DWORD hash = 2166136261UL;
 
-			if(s1 != metaDataBlockLength)
-			{
-				xprintf("Read failure\n");
-				f_close(&FLACfile);
-				return 1;
-			}
-			/* 
-			<bits> Field in STEAMINFO
-			<16> min block size (samples)
-			<16> max block size (samples)
-			<24> min frams size (bytes)
-			<24> max frams size (bytes)
-			<20> Sample rate (Hz)
-			<3> (number of channels)-1
-			<5> (bits per sample)-1. 
-			<36> Total samples in stream. 
-			<128> MD5 signature of the unencoded audio data.
-			*/
-			
-			context->min_blocksize = (metaDataChunk[0] << 8) | metaDataChunk[1];
-			context->max_blocksize = (metaDataChunk[2] << 8) | metaDataChunk[3];
-			context->min_framesize = (metaDataChunk[4] << 16) | (metaDataChunk[5] << 8) | metaDataChunk[6];
-			context->max_framesize = (metaDataChunk[7] << 16) | (metaDataChunk[8] << 8) | metaDataChunk[9];
-			context->samplerate = (metaDataChunk[10] << 12) | (metaDataChunk[11] << 4) | ((metaDataChunk[12] & 0xf0) >> 4);
-			context->channels = ((metaDataChunk[12] & 0x0e) >> 1) + 1;
-			context->bps = (((metaDataChunk[12] & 0x01) << 4) | ((metaDataChunk[13] & 0xf0)>>4) ) + 1;
-			
-			//This field in FLAC context is limited to 32-bits
-			context->totalsamples = (metaDataChunk[14] << 24) | (metaDataChunk[15] << 16) | (metaDataChunk[16] << 8) | metaDataChunk[17];
+	while(length--)
+	{
+		hash ^= *bytes++;
+		hash *= 16777619UL;
+	}
 
-			
+	return hash;
+}
 
-		}
-		//Vorbis comment
-		else if((metaDataChunk[0] & 0x7F) == 4)
+//Closes index.txt before it is written again, the loaded copy is dropped as the build uses its memory
+void closeIndexFile(void)
+{
+	if(g_indexFile->fs) f_close(g_indexFile);
+	g_indexFile->fs = 0;
+	g_indexRecords = NULL;
+	g_indexStrings = NULL;
+	memset(&g_indexHeader, 0, sizeof(g_indexHeader));
+}
+
+//Takes a free handle from the pool in SDRAM, returns 0 when all fileHandles are taken
+//The handle is not open, give it back with fileHandlePut after f_close
+FIL* fileHandleGet(void)
+{
+	int i;
+
+	for(i = 0; i < fileHandles; i++)
+	{
+		if(!(g_fileHandlesUsed & (1 << i)))
 		{
-			unsigned long fieldLength, commentListLength;			
-			unsigned long readCount;
-			unsigned long totalReadCount = 0;
-			unsigned long currentCommentNumber = 0;
-			int readAmount;
+			g_fileHandlesUsed |= 1 << i;
+			g_fileHandles[i].fs = 0;
+			return &g_fileHandles[i];
+		}
+	}
 
-			f_read(&FLACfile, &fieldLength, 4, &s1);
-			totalReadCount +=s1;
+	return 0;
+}
 
-			//Read vendor info
-			readCount = 0;
-			readAmount = 128;
-			while(readCount < fieldLength)
-			{
-				if(fieldLength-readCount < readAmount) readAmount = fieldLength-readCount;
-				if(readAmount> metaDataBlockLength-totalReadCount)
-				{
-					xprintf("Malformed metadata aborting\n");
-					f_close(&FLACfile);
-					return 1;
-				
-				}
-				f_read(&FLACfile, metaDataChunk, readAmount, &s1);
-				readCount += s1;
-				totalReadCount +=s1;
-				//terminate the string								
-				metaDataChunk[s1] = '\0';
-				//xprintf("%s\n",metaDataChunk);
+//Gives a handle taken by fileHandleGet back to the pool (0 is ignored)
+void fileHandlePut(FIL* file)
+{
+	if(file) g_fileHandlesUsed &= ~(1 << (file - g_fileHandles));
+}
 
-			}
+//Creates index.txt in file to be written through buffer (indexWriteSize bytes)
+//The header is left blank until indexWriterClose so an index that is not finished is never valid
+FRESULT indexWriterOpen(indexWriter* writer, FIL* file, unsigned char* buffer)
+{
+	indexHeader header;
 
-			f_read(&FLACfile, &commentListLength, 4, &s1);
-			totalReadCount +=s1;
+	writer->file = file;
+	writer->buffer = buffer;
+	writer->length = 0;
+	writer->trackCount = 0;
+	writer->poolSize = 0;
+	writer->strings = 0;
+	writer->res = f_open(file, "index.txt", FA_CREATE_ALWAYS | FA_WRITE);
 
+	memset(g_indexHash, 0, indexHashSize * sizeof(DWORD));
+	memset(&header, 0, sizeof(header));
+	indexWriterAdd(writer, &header, sizeof(header));
 
-			while(currentCommentNumber < commentListLength)
-			{
-				f_read(&FLACfile, &fieldLength, 4, &s1);
-				totalReadCount +=s1;
-				readCount = 0;
+	return writer->res;
+}
+
+//Adds a record to index.txt, it is only written to the file once the buffer is full
+void indexWriterAdd(indexWriter* writer, void* record, UINT length)
+{
+	unsigned char* source = (unsigned char*) record;
+	UINT copyBytes;
+
+	while(length && writer->res == FR_OK)
+	{
+		copyBytes = indexWriteSize - writer->length;
+		if(copyBytes > length) copyBytes = length;
+
+		memcpy(&writer->buffer[writer->length], source, copyBytes);
+		writer->length += copyBytes;
+		source += copyBytes;
+		length -= copyBytes;
+
+		if(writer->length == indexWriteSize) writer->res = indexWriterFlush(writer);
+	}
+}
+
+//Returns the pool offset of string, it is added to the pool when it is not there already
+//Once g_indexHash is 3/4 full new strings are still added but no longer shared
+DWORD indexWriterString(indexWriter* writer, const char* string)
+{
+	UINT length = strlen(string) + 1;
+	DWORD slot = indexChecksum(string, length) & (indexHashSize - 1);
+	DWORD offset;
+
+	while(g_indexHash[slot])
+	{
+		offset = g_indexHash[slot] - 1;
+		if(strcmp((char*) &g_indexPool[offset], string) == 0) return offset;
+		slot = (slot + 1) & (indexHashSize - 1);
+	}
+
+	if(writer->poolSize + length > indexPoolSize)
+	{
+		writer->res = FR_DENIED;
+		return 0;
+	}
+
+	offset = writer->poolSize;
+	memcpy(&g_indexPool[offset], string, length);
+	writer->poolSize += length;
+
+	if(writer->strings < indexHashSize / 4 * 3)
+	{
+		g_indexHash[slot] = offset + 1;
+		writer->strings++;
+	}
+
+	return offset;
+}
+
+//Adds g_currentTrackInfo to the index, its strings go to the pool and its record to index.txt
+//The path is split at its last '/' (walkFiles paths always have one) so tracks share their directory
+void indexWriterAddTrack(indexWriter* writer)
+{
+	indexRecord record;
+	char* name = strrchr(g_currentTrackInfo.path, '/');
+
+	if(name == NULL) return;
+
+	memset(&record, 0, sizeof(record));
+	*name = '\0';
+	record.directory = indexWriterString(writer, g_currentTrackInfo.path);
+	*name = '/';
+	record.name = indexWriterString(writer, name + 1);
+	record.title = indexWriterString(writer, g_currentTrackInfo.title);
+	record.artist = indexWriterString(writer, g_currentTrackInfo.artist);
+	record.album = indexWriterString(writer, g_currentTrackInfo.album);
+	record.trackNumber = g_currentTrackInfo.general[0];
+
+	if(writer->res != FR_OK) return;
+	indexWriterAdd(writer, &record, sizeof(record));
+	writer->trackCount++;
+}
+
+//Writes the buffered records, the file is first grown indexReserveSize past them when they go beyond
+//its end, so its clusters are allocated in runs and FatFs writes the whole clusters straight from the buffer
+FRESULT indexWriterFlush(indexWriter* writer)
+{
+	FRESULT res;
+	DWORD position = writer->file->fptr;
+	UINT s1;
+
+	if(writer->length == 0) return FR_OK;
+
+	if(position + writer->length > writer->file->fsize)
+	{
+		res = f_lseek(writer->file, position + writer->length + indexReserveSize);
+		if(res == FR_OK) res = f_lseek(writer->file, position);
+		if(res != FR_OK) return res;
+	}
+
+	res = f_write(writer->file, writer->buffer, writer->length, &s1);
+	if(res == FR_OK && s1 != writer->length) res = FR_DENIED;
+	writer->length = 0;
+
+	return res;
+}
+
+//Writes the rest of the records and the string pool, cuts the reserved space off index.txt and then
+//writes the header, which makes it a valid index. The directory entry is only updated here
+FRESULT indexWriterClose(indexWriter* writer)
+{
+	indexHeader header;
+	FRESULT res;
+	UINT s1;
+
+	memcpy(header.magic, indexMagic, 4);
+	header.version = indexVersion;
+	header.recordSize = sizeof(indexRecord);
+	header.trackCount = writer->trackCount;
+	header.poolOffset = sizeof(indexHeader) + writer->trackCount * sizeof(indexRecord);
+	header.poolSize = writer->poolSize;
+	header.checksum = indexChecksum(&header, sizeof(header) - sizeof(header.checksum));
+
+	indexWriterAdd(writer, g_indexPool, writer->poolSize);
+
+	res = writer->res;
+	if(res == FR_OK) res = indexWriterFlush(writer);
+	if(res == FR_OK) res = f_truncate(writer->file);
+	if(res == FR_OK) res = f_lseek(writer->file, 0);
+	if(res == FR_OK) res = f_write(writer->file, &header, sizeof(header), &s1);
+	if(res == FR_OK && s1 != sizeof(header)) res = FR_DENIED;
+	if(f_close(writer->file) != FR_OK && res == FR_OK) res = FR_DISK_ERR;
+
+	return res;
+}
+
+//Prints the sector cache use and hit rate, clear starts the counters again
+void printDiskCacheStats(int clear)
+{
+	DISK_CACHE_STATS stats;
+	unsigned long lookups;
+
+	disk_cache_stats(&stats, clear);
+	lookups = stats.hits + stats.misses;
+
+	xprintf("Disk cache: %lu of %lu sectors used, %lu pinned\n", stats.used, stats.sectors, stats.pinned);
+	xprintf("Hits: %lu Misses: %lu Hit rate: %lu%%\n", stats.hits, stats.misses, lookups ? stats.hits * 100 / lookups : 0);
+	xprintf("Uncached reads: %lu Writes: %lu Evictions: %lu\n", stats.bypassed, stats.writes, stats.evictions);
+}
+
+//Microseconds counted by the system tick, wraps after about 71 minutes
+unsigned long benchMicroseconds(void)
+{
+	unsigned long ticks, value;
+
+	//Read again if the tick interupt came in between
+	do
+	{
+		ticks = g_sysTickSoftCount;
+		value = SysTickValueGet();
+	}
+	while(ticks != g_sysTickSoftCount);
+
+	return ticks * (1000000 / SYSTICK_HZ) + (SysTickPeriodGet() - 1 - value) / g_clocksPerMicrosecond;
+}
+
+//Runs the benchmark named in args
+void bench(char* args)
+{
+	while(*args == ' ') args++;
+
+	if(strncmp(args, "disk", 4) == 0)
+	{
+		args = &args[4];
+		while(*args == ' ') args++;
+		benchDisk(*args == '\0' ? "index.txt" : args);
+	}
+	else if(strncmp(args, "ogg", 3) == 0 && args[3] == ' ')
+	{
+		args = &args[3];
+		while(*args == ' ') args++;
+		benchOgg(args);
+	}
+	else if(strncmp(args, "mp3", 3) == 0 && args[3] == ' ')
+	{
+		args = &args[3];
+		while(*args == ' ') args++;
+		benchMp3(args);
+	}
+	else
+	{
+		xprintf("bench disk [file] | bench ogg <file> | bench mp3 <file>\n");
+	}
+}
+
+//bench disk [file] prints tables of disk_read throughput at several transfer sizes, random 4K read
+//latency and f_read throughput of file (index.txt if none is given), for picking drives and buffer sizes
+//Reads go to the read-ahead ring, which is registered to skip the sector cache so the drive itself is timed
+//host/diskbench prints the same tables for a drive plugged into a PC
+void benchDisk(char* path)
+{
+	static const BYTE sectorCounts[] = {1, 8, 32, 64, 128, 255};
+	static const UINT readSizes[] = {512, 4096, 32768, 65536};
+	BYTE* buffer = g_readAheadBuffer;
+	DWORD first, length, sector, total, seed;
+	unsigned long start, elapsed, readTime, best, worst, reads, i, k;
+	FIL* file;
+	UINT s1;
+
+	//Mounts the drive, the reads stay inside the data area of the volume
+	if(f_opendir(&g_dirInfo, "/") != FR_OK)
+	{
+		xprintf("Drive not ready\n");
+		return;
+	}
+	first = g_FatFs.database;
+	length = (g_FatFs.n_fatent - 2) * g_FatFs.csize;
+
+	total = benchBytes / _MAX_SS;
+	if(total > length) total = length;
+
+	xprintf("Sequential disk_read\n Sectors    KB/s  us/read\n");
+	for(k = 0; k < sizeof(sectorCounts); k++)
+	{
+		//Each size reads a new span so the drive can not answer from its own buffer
+		sector = first + k * total;
+		if(sector + total > first + length) sector = first;
+
+		reads = total / sectorCounts[k];
+		start = benchMicroseconds();
+		for(i = 0; i < reads; i++)
+		{
+			if(disk_read(0, buffer, sector, sectorCounts[k]) != RES_OK)
+			{
+				xprintf("Read error at sector %lu\n", sector);
+				return;
+			}
+			sector += sectorCounts[k];
+		}
+		elapsed = benchMicroseconds() - start;
+		if(elapsed == 0) elapsed = 1;
+
+		xprintf("%8u %7lu %8lu\n", sectorCounts[k], reads * sectorCounts[k] / 2 * 1000000 / elapsed, elapsed / reads);
+	}
+
+	seed = g_sysTickSoftCount;
+	best = 0xFFFFFFFF;
+	worst = 0;
+	elapsed = 0;
+	for(i = 0; i < benchRandomReads; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		sector = first + ((seed >> 8) % (length / 8)) * 8;
+
+		start = benchMicroseconds();
+		if(disk_read(0, buffer, sector, 8) != RES_OK)
+		{
+			xprintf("Read error at sector %lu\n", sector);
+			return;
+		}
+		readTime = benchMicroseconds() - start;
+
+		elapsed += readTime;
+		if(readTime < best) best = readTime;
+		if(readTime > worst) worst = readTime;
+	}
+	xprintf("Random 4K disk_read (%u reads)\n     Avg      Min      Max (us)\n%8lu %8lu %8lu\n", benchRandomReads, elapsed / benchRandomReads, best, worst);
+
+	file = fileHandleGet();
+	if(file == 0 || f_open(file, path, FA_OPEN_EXISTING | FA_READ) != FR_OK)
+	{
+		xprintf("Cannot open: %s\n", path);
+		fileHandlePut(file);
+		return;
+	}
+	fileLinkMap(file, g_trackLinkMap);
+
+	total = f_size(file) < benchBytes ? f_size(file) : benchBytes;
+	xprintf("f_read %s (%lu KB)\n   Bytes    KB/s\n", path, total / 1024);
+	for(k = 0; k < sizeof(readSizes) / sizeof(readSizes[0]) && total; k++)
+	{
+		f_lseek(file, 0);
+		start = benchMicroseconds();
+		for(i = 0; i < total; i += s1)
+		{
+			if(f_read(file, buffer, readSizes[k], &s1) != FR_OK || s1 == 0) break;
+		}
+		elapsed = benchMicroseconds() - start;
+		if(elapsed == 0) elapsed = 1;
+
+		xprintf("%8u %7lu\n", readSizes[k], i / 1024 * 1000000 / elapsed);
+	}
+	f_close(file);
+	fileHandlePut(file);
+}
+
+//bench ogg <file> decodes file without playing it and prints the cycles each packet took in vorbis_decode_packet
+//and vorbis_read_pcm, against the cycles the audio of the packet lasts
+//host/vorbisbench times the same span on a PC, the board average over the host average is the scale it needs
+void benchOgg(char* path)
+{
+	OggStream stream;
+	unsigned char* packet;
+	unsigned long packetLength, start, cycles, average, worst, packets, samples, budget;
+	uint64_t total;
+	int frames;
+
+	if(*path == '\0' || probeFile(&g_track, path) == FORMAT_UNKNOWN)
+	{
+		xprintf("bench ogg <file>\n");
+		return;
+	}
+	if(g_track.format != FORMAT_OGG)
+	{
+		xprintf("Not an Ogg file: %s\n", path);
+		f_close(g_track.file);
+		return;
+	}
+
+	vorbis_init(&g_vorbisContext, g_decoderScratch, decoderScatchSize, &g_decoderTables[VORBIS_MAX_PACKET], decoderTableSize - VORBIS_MAX_PACKET);
+	if(parceOGGmetadata(&g_track, &stream, &g_vorbisContext) != 0)
+	{
+		f_close(g_track.file);
+		return;
+	}
+
+	HWREG(DEMCR) |= DEMCR_TRCENA;
+	HWREG(DWT_CTRL) |= DWT_CTRL_CYCCNTENA;
+
+	total = worst = packets = samples = 0;
+	while(ogg_read_packet(&stream, &packet, &packetLength) == 0)
+	{
+		//The PCM goes to the read-ahead ring, nothing is playing
+		start = HWREG(DWT_CYCCNT);
+		if(vorbis_decode_packet(&g_vorbisContext, packet, packetLength) < 0) continue;
+		while((frames = vorbis_read_pcm(&g_vorbisContext, (unsigned short*) g_readAheadBuffer, readAheadSize/4)) > 0)
+		{
+			samples += frames;
+		}
+		cycles = HWREG(DWT_CYCCNT) - start;
+
+		total += cycles;
+		if(cycles > worst) worst = cycles;
+		packets++;
+	}
+	f_close(g_track.file);
+
+	if(packets == 0 || samples == 0)
+	{
+		xprintf("No audio packets\n");
+		return;
+	}
+
+	//Cycles the audio of an average packet lasts
+	average = (unsigned long) (total / packets);
+	budget = samples / packets * (SysCtlClockGet() / g_vorbisContext.samplerate);
+
+	xprintf("%s: %d channels, %lu Hz, blocksizes %d/%d\n", path, g_vorbisContext.channels, g_vorbisContext.samplerate, g_vorbisContext.blocksize[0], g_vorbisContext.blocksize[1]);
+	xprintf("%lu packets, %lu samples\nper packet        average      worst\n", packets, samples);
+	xprintf("cycles       %12lu %10lu\nbudget       %12lu\n", average, worst, budget);
+	xprintf("%lu%% of the budget\n", average * 100 / budget);
+}
+
+//bench mp3 <file> decodes file without playing it and prints the cycles each frame took in mp3_decode_frame
+//and mp3_read_pcm, against the cycles the audio of the frame lasts
+//host/mp3bench times the same span on a PC, the board average over the host average is the scale it needs
+void benchMp3(char* path)
+{
+	mpegFormat format, frame;
+	unsigned long start, cycles, average, worst, frameCount, samples, budget;
+	uint64_t total;
+	int frames;
+
+	if(*path == '\0' || probeFile(&g_track, path) == FORMAT_UNKNOWN)
+	{
+		xprintf("bench mp3 <file>\n");
+		return;
+	}
+	if(g_track.format != FORMAT_MP3)
+	{
+		xprintf("Not an MP3 file: %s\n", path);
+		f_close(g_track.file);
+		return;
+	}
+
+	if(parceID3tag(&g_track) != 0 || parceMPEGheader(&g_track, &format) != 0 || format.layer != 3)
+	{
+		xprintf("No Layer III stream\n");
+		f_close(g_track.file);
+		return;
+	}
+	mp3_init(&g_mp3Context, g_decoderScratch, decoderScatchSize);
+
+	HWREG(DEMCR) |= DEMCR_TRCENA;
+	HWREG(DWT_CTRL) |= DWT_CTRL_CYCCNTENA;
+
+	total = worst = frameCount = samples = 0;
+	while(readMPEGframe(&g_track, &format, &frame, g_decoderTables) == 0)
+	{
+		//The PCM goes to the read-ahead ring, nothing is playing
+		start = HWREG(DWT_CYCCNT);
+		if(mp3_decode_frame(&g_mp3Context, g_decoderTables, frame.frameLength) < 0) continue;
+		while((frames = mp3_read_pcm(&g_mp3Context, (unsigned short*) g_readAheadBuffer, readAheadSize/4)) > 0)
+		{
+			samples += frames;
+		}
+		cycles = HWREG(DWT_CYCCNT) - start;
+
+		total += cycles;
+		if(cycles > worst) worst = cycles;
+		frameCount++;
+	}
+	f_close(g_track.file);
+
+	if(frameCount == 0 || samples == 0)
+	{
+		xprintf("No audio frames\n");
+		return;
+	}
+
+	//Cycles the audio of an average frame lasts
+	average = (unsigned long) (total / frameCount);
+	budget = samples / frameCount * (SysCtlClockGet() / format.sampleRate);
+
+	xprintf("%s: MPEG-%s Layer III, %d channels, %lu Hz, %lu kbps\n", path, (format.version == 1) ? "1" : (format.version == 2) ? "2" : "2.5",
+		format.channels, format.sampleRate, format.bitrate);
+	xprintf("%lu frames, %lu samples\nper frame         average      worst\n", frameCount, samples);
+	xprintf("cycles       %12lu %10lu\nbudget       %12lu\n", average, worst, budget);
+	xprintf("%lu%% of the budget\n", average * 100 / budget);
+}
+
+//Probes filePath and plays it with the matching decoder
+//gapless is passed on to decoders that support it
+int playTrack(char filePath[], int gapless)
+{
+	int result = 1;
+
+	//The link map walks the whole cluster chain, so it is only made for a file that is played
+	//Playback reads go through the read-ahead ring, except WAV which decides for itself (see playWAV)
+	if(probeFile(&g_track, filePath) != FORMAT_UNKNOWN)
+	{
+		fileLinkMap(g_track.file, g_trackLinkMap);
+		if(g_track.format != FORMAT_WAV) trackReadAheadStart(&g_track, g_readAheadBuffer, readAheadSize);
+	}
+
+	switch(g_track.format)
+	{
+		case FORMAT_FLAC:
+		result = playFLAC(&g_track, g_decoderScratch, decoderScatchSize, gapless);
+		break;
+
+		case FORMAT_WAV:
+		result = playWAV(&g_track, g_decoderScratch, decoderScatchSize);
+		break;
+
+		case FORMAT_OGG:
+		result = playOGG(&g_track, g_decoderScratch, decoderScatchSize, gapless);
+		break;
+
+		case FORMAT_MP3:
+		result = playMP3(&g_track, g_decoderScratch, decoderScatchSize, gapless);
+		break;
+
+		case FORMAT_MP4:
+		result = playMP4(&g_track, g_decoderScratch, decoderScatchSize, gapless);
+		break;
+
+		case FORMAT_UNKNOWN:
+		xprintf("Unknown format: %s\n", filePath);
+		return 1;
+
+		default:
+		xprintf("Format not supported: %s\n", filePath);
+		break;
+	}
+
+	g_track.aheadSize = 0;
+	f_close(g_track.file);
+
+	return result;
+}
+
+//WAV sample conversion kernels, one is picked per file by playWAV
+//Each turns frames of samples into 16-bit stereo pairs (left first) for the wave buffers
+//16-bit stereo does not need one, it is read straight into the wave buffers
+
+//8-bit samples are unsigned
+void wavConvert8Mono(unsigned char * source, unsigned short * destination, unsigned long frames)
+{
+	unsigned short sample;
+
+	while(frames--)
+	{
+		sample = (source[0] ^ 0x80) << 8;
+		destination[0] = sample;
+		destination[1] = sample;
+		source += 1;
+		destination += 2;
+	}
+}
+
+void wavConvert8Stereo(unsigned char * source, unsigned short * destination, unsigned long frames)
+{
+	while(frames--)
+	{
+		destination[0] = (source[0] ^ 0x80) << 8;
+		destination[1] = (source[1] ^ 0x80) << 8;
+		source += 2;
+		destination += 2;
+	}
+}
+
+void wavConvert16Mono(unsigned char * source, unsigned short * destination, unsigned long frames)
+{
+	unsigned short sample;
+
+	while(frames--)
+	{
+		sample = source[0] | (source[1] << 8);
+		destination[0] = sample;
+		destination[1] = sample;
+		source += 2;
+		destination += 2;
+	}
+}
+
+//24 and 32-bit samples keep their upper 16 bits
+void wavConvert24Mono(unsigned char * source, unsigned short * destination, unsigned long frames)
+{
+	unsigned short sample;
+
+	while(frames--)
+	{
+		sample = source[1] | (source[2] << 8);
+		destination[0] = sample;
+		destination[1] = sample;
+		source += 3;
+		destination += 2;
+	}
+}
+
+void wavConvert24Stereo(unsigned char * source, unsigned short * destination, unsigned long frames)
+{
+	while(frames--)
+	{
+		destination[0] = source[1] | (source[2] << 8);
+		destination[1] = source[4] | (source[5] << 8);
+		source += 6;
+		destination += 2;
+	}
+}
+
+void wavConvert32Mono(unsigned char * source, unsigned short * destination, unsigned long frames)
+{
+	unsigned short sample;
+
+	while(frames--)
+	{
+		sample = source[2] | (source[3] << 8);
+		destination[0] = sample;
+		destination[1] = sample;
+		source += 4;
+		destination += 2;
+	}
+}
+
+void wavConvert32Stereo(unsigned char * source, unsigned short * destination, unsigned long frames)
+{
+	while(frames--)
+	{
+		destination[0] = source[2] | (source[3] << 8);
+		destination[1] = source[6] | (source[7] << 8);
+		source += 8;
+		destination += 2;
+	}
+}
+
+//Walks the RIFF chunks of a WAV file to find the fmt and data chunks
+//Any other chunks (LIST, fact, etc) are skipped, the file pointer is left at the first sample
+//See http://www-mmsp.ece.mcgill.ca/Documents/AudioFormats/WAVE/WAVE.html for WAV format details
+//0 format is valid; 1 format is not valid
+int parceWAVheader(trackStream* track, wavFormat* format)
+{
+	UINT s1 = 0;
+	unsigned char chunk[40];
+	unsigned long chunkLength, chunkPad, readLength;
+	unsigned short formatTag;
+	int fmtFound = 0;
+
+	trackRead(track, chunk, 12, &s1);
+
+	if(s1 != 12 || memcmp(chunk, "RIFF", 4) != 0 || memcmp(&chunk[8], "WAVE", 4) != 0)
+	{
+		xprintf("Not a WAV file\n");
+		return 1;
+	}
+
+	// Each chunk has a header of 4 byte ID and 4 byte length
+	while(1)
+	{
+		trackRead(track, chunk, 8, &s1);
+
+		if(s1 != 8)
+		{
+			xprintf("No data chunk found\n");
+			return 1;
+		}
+
+		chunkLength = chunk[4] | (chunk[5] << 8) | (chunk[6] << 16) | (chunk[7] << 24);
+		//Chunks are padded to an even length, the pad byte is not counted in the length
+		chunkPad = chunkLength & 1;
+
+		if(memcmp(chunk, "fmt ", 4) == 0)
+		{
+			/*
+			<bytes> Field in fmt
+			<2> Format tag (1 = PCM, 0xFFFE = extensible)
+			<2> Channels
+			<4> Sample rate (Hz)
+			<4> Bytes per second
+			<2> Block align (bytes per frame)
+			<2> Bits per sample
+			extensible only:
+			<2> Extension size
+			<2> Valid bits per sample
+			<4> Channel mask
+			<16> Sub format GUID (first 2 bytes are the format tag)
+			*/
+
+			if(chunkLength < 16)
+			{
+				xprintf("Malformed fmt chunk\n");
+				return 1;
+			}
+
+			readLength = chunkLength;
+			if(readLength > 40) readLength = 40;
+
+			trackRead(track, chunk, readLength, &s1);
+
+			if(s1 != readLength)
+			{
+				xprintf("Read failure\n");
+				return 1;
+			}
+
+			formatTag = chunk[0] | (chunk[1] << 8);
+			if(formatTag == 0xFFFE && readLength >= 26) formatTag = chunk[24] | (chunk[25] << 8);
+
+			if(formatTag != 1)
+			{
+				xprintf("Unsupported WAV format: %d\n", formatTag);
+				return 1;
+			}
+
+			format->channels = chunk[2] | (chunk[3] << 8);
+			format->sampleRate = chunk[4] | (chunk[5] << 8) | (chunk[6] << 16) | (chunk[7] << 24);
+			format->blockAlign = chunk[12] | (chunk[13] << 8);
+			format->bitsPerSample = chunk[14] | (chunk[15] << 8);
+
+			if(format->channels < 1 || format->channels > 2 || format->blockAlign != format->channels * (format->bitsPerSample / 8))
+			{
+				xprintf("Unsupported WAV layout: %d channels, %d bit\n", format->channels, format->bitsPerSample);
+				return 1;
+			}
+
+			fmtFound = 1;
+			
+			//Skip the rest of a long fmt chunk
+			chunkLength -= readLength;
+		}
+		else if(memcmp(chunk, "data", 4) == 0)
+		{
+			if(fmtFound == 0)
+			{
+				xprintf("No fmt chunk before data\n");
+				return 1;
+			}
+
+			format->dataOffset = trackTell(track);
+			format->dataLength = chunkLength;
+
+			//Streamed files can have an unset data length
+			if(format->dataLength > f_size(track->file) - format->dataOffset) format->dataLength = f_size(track->file) - format->dataOffset;
+
+			return 0;
+		}
+
+		if(trackSeek(track, trackTell(track) + chunkLength + chunkPad) != FR_OK)
+		{
+			xprintf("File Seek Failed\n");
+			return 1;
+		}
+	}
+}
+
+//Plays the PCM samples of a WAV file
+//16-bit stereo samples are read straight from the file into the wave buffers (no copy through scratchMemory
+//or the read-ahead ring, whole sectors go from the drive to SDRAM with no copy at all)
+//All other layouts are read ahead into the ring, then into scratchMemory and converted by a kernel chosen
+//once from the fmt chunk
+//The track is opened and closed by the caller (see playTrack)
+int playWAV(trackStream* track, unsigned char * scratchMemory, unsigned long scratchLength)
+{
+
+
+	UINT s1 = 0;
+	FRESULT res;
+	wavFormat format;
+	wavConvertFunction convert;
+	unsigned char * Buff;
+	unsigned char * waveRegion;
+	unsigned long readSize, freeBytes, sectorOffset, frames;
+	unsigned long dataLeft;
+
+	Buff = scratchMemory;
+	g_endPlayBack = 0;
+	
+	if(scratchLength < 4096)
+	{
+		readSize = scratchLength;
+	}
+	else readSize = 4096;
+
+	if(parceWAVheader(track, &format) != 0)
+	{
+		return 1;
+	}
+
+	//Pick the conversion kernel, NULL is the straight copy path
+	switch((format.bitsPerSample << 4) | format.channels)
+	{
+		case (8 << 4) | 1: convert = wavConvert8Mono; break;
+		case (8 << 4) | 2: convert = wavConvert8Stereo; break;
+		case (16 << 4) | 1: convert = wavConvert16Mono; break;
+		case (16 << 4) | 2: convert = NULL; break;
+		case (24 << 4) | 1: convert = wavConvert24Mono; break;
+		case (24 << 4) | 2: convert = wavConvert24Stereo; break;
+		case (32 << 4) | 1: convert = wavConvert32Mono; break;
+		case (32 << 4) | 2: convert = wavConvert32Stereo; break;
+		default:
+		xprintf("Unsupported WAV sample size: %d bit\n", format.bitsPerSample);
+		return 1;
+	}
+
+	//The ring only pays off when the samples have to be copied anyway
+	if(convert != NULL) trackReadAheadStart(track, g_readAheadBuffer, readAheadSize);
+
+	xprintf("Playing...\n");
+	xprintf("%d Hz, %d bit, %d channel(s)\n", format.sampleRate, format.bitsPerSample, format.channels);
+
+	// read a whole file until done
+	g_playFlag = 0;
+	g_bufferFlag = 0;
+	setSampleRate(format.sampleRate);
+
+	dataLeft = format.dataLength;
+	res = FR_OK;
+
+	while(dataLeft && g_endPlayBack != 1)
+	{
+		waveRegion = waveOutGetFree(&freeBytes);
+
+		if(convert == NULL)
+		{
+			if(freeBytes > dataLeft) freeBytes = dataLeft;
+
+			//Only whole sectors are read once the file pointer is on a sector boundary
+			//This lets FatFs put them straight into the wave buffer with multi-sector reads
+			sectorOffset = trackTell(track) % _MAX_SS;
+			if(sectorOffset != 0)
+			{
+				if(freeBytes > _MAX_SS - sectorOffset) freeBytes = _MAX_SS - sectorOffset;
+			}
+			else if(freeBytes >= _MAX_SS)
+			{
+				freeBytes -= freeBytes % _MAX_SS;
+			}
+
+			res = trackRead(track, waveRegion, freeBytes, &s1);
+			waveOutCommit(s1);
+		}
+		else
+		{
+			//Each frame becomes a 4 byte sample pair in the wave buffer
+			frames = freeBytes / 4;
+			if(frames > readSize / format.blockAlign) frames = readSize / format.blockAlign;
+			if(frames > dataLeft / format.blockAlign) frames = dataLeft / format.blockAlign;
+
+			res = trackRead(track, Buff, frames * format.blockAlign, &s1);
+			frames = s1 / format.blockAlign;
+
+			convert(Buff, (unsigned short *) waveRegion, frames);
+			waveOutCommit(frames * 4);
+		}
+
+		if(res != FR_OK || s1 == 0) break;
+		dataLeft -= s1;
+	}
+
+	xprintf("\nClosing File, %d\n", res);
+
+	//Clear the buffers
+	int i;
+	for(i=0; i < readSize; i++)
+	{
+		Buff[i] = 0;
+	}
+	for(i=0; i <=waveBufferSize*4; i += readSize)
+	{
+		waveOut(Buff, readSize, 16);
+	}
+	g_playFlag = 0;
+	g_waveBufferIndex = 0;
+
+	return 0;
+}
+
+
+//This function creates the FLACContext for a probed track
+//Called by main FLAC decoder and buildFileIndex, the track is left at the start of the first frame
+//See http://flac.sourceforge.net/format.html for FLAC format details
+//0 context is valid; 1 context is not valid
+int parceFLACmetadata(trackStream* track, FLACContext* context)
+{
+	UINT s1 = 0;
+	int metaDataFlag = 1;
+	char metaDataChunk[128];	
+	unsigned long metaDataBlockLength = 0;
+	char* tagContents;
+
+
+	trackRead(track, metaDataChunk, 4, &s1);
+	
+	if(s1 != 4)
+	{
+		xprintf("Read failure\n");
+		return 1;
+	}
+
+	if(memcmp(metaDataChunk, "fLaC", 4) != 0)
+	{
+		xprintf("Not a FLAC file\n");
+		return 1;
+	}
+	
+	// Now we are at the stream block
+	// Each block has metadata header of 4 bytes
+	do
+	{
+		trackRead(track, metaDataChunk, 4, &s1);
+	
+		if(s1 != 4)
+		{
+			xprintf("Read failure\n");
+			return 1;
+		}
+
+		//Check if last chunk
+		if(metaDataChunk[0] & 0x80) metaDataFlag = 0;
+
+		metaDataBlockLength = (metaDataChunk[1] << 16) | (metaDataChunk[2] << 8) | metaDataChunk[3];
+
+		//STREAMINFO block
+		if((metaDataChunk[0] & 0x7F) == 0)
+		{
+						
+			if(metaDataBlockLength > 128)
+			{
+				xprintf("Metadata buffer too small\n");
+				return 1;
+			}
+
+			trackRead(track, metaDataChunk, metaDataBlockLength, &s1);
+
+			if(s1 != metaDataBlockLength)
+			{
+				xprintf("Read failure\n");
+				return 1;
+			}
+			/* 
+			<bits> Field in STEAMINFO
+			<16> min block size (samples)
+			<16> max block size (samples)
+			<24> min frams size (bytes)
+			<24> max frams size (bytes)
+			<20> Sample rate (Hz)
+			<3> (number of channels)-1
+			<5> (bits per sample)-1. 
+			<36> Total samples in stream. 
+			<128> MD5 signature of the unencoded audio data.
+			*/
+			
+			context->min_blocksize = (metaDataChunk[0] << 8) | metaDataChunk[1];
+			context->max_blocksize = (metaDataChunk[2] << 8) | metaDataChunk[3];
+			context->min_framesize = (metaDataChunk[4] << 16) | (metaDataChunk[5] << 8) | metaDataChunk[6];
+			context->max_framesize = (metaDataChunk[7] << 16) | (metaDataChunk[8] << 8) | metaDataChunk[9];
+			context->samplerate = (metaDataChunk[10] << 12) | (metaDataChunk[11] << 4) | ((metaDataChunk[12] & 0xf0) >> 4);
+			context->channels = ((metaDataChunk[12] & 0x0e) >> 1) + 1;
+			context->bps = (((metaDataChunk[12] & 0x01) << 4) | ((metaDataChunk[13] & 0xf0)>>4) ) + 1;
+			
+			//This field in FLAC context is limited to 32-bits
+			context->totalsamples = (metaDataChunk[14] << 24) | (metaDataChunk[15] << 16) | (metaDataChunk[16] << 8) | metaDataChunk[17];
+
+			
+
+		}
+		//Vorbis comment
+		else if((metaDataChunk[0] & 0x7F) == 4)
+		{
+			unsigned long fieldLength, commentListLength;			
+			unsigned long readCount;
+			unsigned long totalReadCount = 0;
+			unsigned long currentCommentNumber = 0;
+			int readAmount;
+
+			trackRead(track, &fieldLength, 4, &s1);
+			totalReadCount +=s1;
+
+			//Read vendor info
+			readCount = 0;
+			readAmount = 128;
+			while(readCount < fieldLength)
+			{
+				if(fieldLength-readCount < readAmount) readAmount = fieldLength-readCount;
+				if(readAmount> metaDataBlockLength-totalReadCount)
+				{
+					xprintf("Malformed metadata aborting\n");
+					return 1;
+				
+				}
+				trackRead(track, metaDataChunk, readAmount, &s1);
+				readCount += s1;
+				totalReadCount +=s1;
+				//terminate the string								
+				metaDataChunk[s1] = '\0';
+				//xprintf("%s\n",metaDataChunk);
+
+			}
+
+			trackRead(track, &commentListLength, 4, &s1);
+			totalReadCount +=s1;
+
+
+			while(currentCommentNumber < commentListLength)
+			{
+				trackRead(track, &fieldLength, 4, &s1);
+				totalReadCount +=s1;
+				readCount = 0;
 				readAmount = 128;
 				while(readCount < fieldLength)
 				{
@@ -1098,11 +2589,10 @@ int parceFLACmetadata(char filePath[], FLACContext* context)
 					if(readAmount> metaDataBlockLength-totalReadCount)
 					{
 						xprintf("Malformed metadata aborting\n");
-						f_close(&FLACfile);
 						return 1;
 					
 					}
-					f_read(&FLACfile, metaDataChunk, readAmount, &s1);
+					trackRead(track, metaDataChunk, readAmount, &s1);
 					readCount += s1;
 					totalReadCount +=s1;
 					//terminate the string
@@ -1114,137 +2604,1117 @@ int parceFLACmetadata(char filePath[], FLACContext* context)
 					tagContents = &tagContents[1];
 					strToUppercase(metaDataChunk);
 
-					//xprintf("%s: %s\n",metaDataChunk, tagContents);
-			
-					if(strcmp(metaDataChunk, "ARTIST") == 0)
-					{		
-						strcpy(g_currentTrackInfo.artist, tagContents);
-					}
-					else if(strcmp(metaDataChunk, "TITLE") == 0)
-					{	
-						strcpy(g_currentTrackInfo.title, tagContents);
-					}
-					else if(strcmp(metaDataChunk, "ALBUM") == 0)
-					{		
-						strcpy(g_currentTrackInfo.album, tagContents);
-					}
-					//Uses general feild first character
-					else if(strcmp(metaDataChunk, "TRACKNUMBER") == 0)
-					{	
-						long long_trackNumber;
-						char trackNumber;
-						xatoi(&tagContents, &long_trackNumber);
-						trackNumber = (char) long_trackNumber;
-						g_currentTrackInfo.general[0] = trackNumber;					
-						
-					}					
+					//xprintf("%s: %s\n",metaDataChunk, tagContents);
+			
+					if(strcmp(metaDataChunk, "ARTIST") == 0)
+					{		
+						strcpy(g_currentTrackInfo.artist, tagContents);
+					}
+					else if(strcmp(metaDataChunk, "TITLE") == 0)
+					{	
+						strcpy(g_currentTrackInfo.title, tagContents);
+					}
+					else if(strcmp(metaDataChunk, "ALBUM") == 0)
+					{		
+						strcpy(g_currentTrackInfo.album, tagContents);
+					}
+					//Uses general feild first character
+					else if(strcmp(metaDataChunk, "TRACKNUMBER") == 0)
+					{	
+						long long_trackNumber;
+						char trackNumber;
+						xatoi(&tagContents, &long_trackNumber);
+						trackNumber = (char) long_trackNumber;
+						g_currentTrackInfo.general[0] = trackNumber;					
+						
+					}					
+
+				}
+				currentCommentNumber++;
+			}
+
+			if(trackSeek(track, trackTell(track) + metaDataBlockLength-totalReadCount) != FR_OK)
+			{
+				xprintf("File Seek Failed\n");
+				return 1;
+			}
+
+
+		}
+		//TODO handle other metadata
+		else
+		{
+			if(trackSeek(track, trackTell(track) + metaDataBlockLength) != FR_OK)
+			{
+				xprintf("File Seek Failed\n");
+				return 1;
+			}
+		}		
+		
+
+
+	} while(metaDataFlag);
+
+
+	// track length in ms
+	context->length = (context->totalsamples / context->samplerate) * 1000; 
+	// file size in bytes
+	context->filesize = f_size(track->file);					
+	// current offset is end of metadata in bytes
+	context->metadatalength = trackTell(track);
+	// bitrate of file				
+	context->bitrate = ((context->filesize - context->metadatalength) * 8) / context->length;
+
+	return 0;	
+
+}
+
+
+
+//Just a dummy function for the flac_decode_frame
+void yield() 
+{
+	//Do nothing
+}
+
+//FLAC decoder
+//The track is opened and closed by the caller (see playTrack)
+int playFLAC(trackStream* track, unsigned char* scratchMemory, unsigned long scratchLength, int gapless) 
+{
+	UINT bytesLeft, bytesUsed, s1;
+	int i;
+
+	FLACContext context;
+	int sampleShift;
+	int16_t samplePair[2];
+
+	//Pointers to memory chuncks in scratchMemory for decode
+	//fileChunk currently can't be in EPI as it needs byte access
+	unsigned char* bytePointer;
+	unsigned char* fileChunk;
+	int32_t* decodedSamplesLeft;
+	int32_t* decodedSamplesRight;
+
+	//Setup the pointers, the defines are in decoder.h
+	bytePointer = (unsigned char*) scratchMemory;
+	fileChunk = bytePointer;
+	decodedSamplesLeft = (int32_t*) &bytePointer[MAX_FRAMESIZE];
+	decodedSamplesRight = (int32_t*) &bytePointer[MAX_FRAMESIZE+4*MAX_BLOCKSIZE];
+
+	g_endPlayBack = 0;
+
+	//Get the metadata we need to play the file
+	//The track is left at the start of the stream
+	if(parceFLACmetadata(track, &context) != 0)
+	{
+		xprintf("Failed to get FLAC context\n");
+		return 1;
+	}
+
+	xprintf("Playing...\n");
+
+	setSampleRate(context.samplerate);
+
+	//The decoder has sample size defined by FLAC_OUTPUT_DEPTH (currently 29 bit)
+	//Shift for lower bitrate to align MSB correctly
+	sampleShift = FLAC_OUTPUT_DEPTH-context.bps;
+
+	//Fill up fileChunk completely (MAX_FRAMSIZE = valid size of memory fileChunk points to)
+	trackRead(track, fileChunk, MAX_FRAMESIZE, &bytesLeft);
+	
+	//If not gapless or playing first track
+	if(gapless == 0 || g_playFlag == 0)
+	{
+		g_playFlag = 0;
+		g_bufferFlag = 0;
+	}
+
+	while (bytesLeft) 
+	{
+		if(flac_decode_frame(&context, decodedSamplesLeft, decodedSamplesRight, fileChunk, bytesLeft, yield) < 0) 
+		{
+			xprintf("FLAC Decode Failed\n");
+			break;
+		}		
+
+		//Dump the block to the waveOut
+		i = 0;
+		while(i < context.blocksize) 
+		{
+			//Left Channel
+			samplePair[0] = (uint16_t) (decodedSamplesLeft[i]>>sampleShift);
+
+			if (context.channels==2) 
+			{
+				//Right Channel
+				samplePair[1] = (uint16_t) (decodedSamplesRight[i]>>sampleShift);
+			}
+			else
+			{
+				//Repeat Left channel if mono
+				samplePair[1] = (uint16_t) (decodedSamplesLeft[i]>>sampleShift);
+
+			}
+
+			//Sample pair is 4 bytes, 16-bit mode
+			waveOut(samplePair, 4, 16);
+
+			i++;
+		}
+
+		//calculate the number of valid bytes left in the fileChunk buffer
+		bytesUsed = context.gb.index/8;
+		bytesLeft -= bytesUsed;
+
+		//shift the unused stuff to the front of the fileChunk buffer
+		memmove(fileChunk, &fileChunk[bytesUsed], bytesLeft);
+
+		//Refill the fileChunk buffer
+		trackRead(track, &fileChunk[bytesLeft], MAX_FRAMESIZE - bytesLeft, &s1);
+		
+		//add however many were read
+		bytesLeft += s1;
+
+		if(g_endPlayBack)break;
+	}
+
+	if(gapless == 0 || g_endPlayBack)
+	{
+		//Clear the buffers
+		int i1;
+
+		for(i1=0; i1 < 4096; i1++)
+		{
+			fileChunk[i1] = 0;
+		}
+		for(i1=0; i1 <=waveBufferSize*4; i1 += 4096)
+		{
+			waveOut(fileChunk, 4096, 16);
+		}
+		g_playFlag = 0;
+		g_waveBufferIndex = 0;
+	}
+
+	return 0;
+}
+
+//Read callback for the Ogg layer, all reads go through the probed track
+unsigned long oggReadTrack(void *handle, void *buffer, unsigned long length)
+{
+	UINT s1 = 0;
+
+	trackRead((trackStream*) handle, buffer, length, &s1);
+
+	return s1;
+}
+
+//Fills g_currentTrackInfo from a Vorbis comment block (the same layout FLAC uses)
+void parceVorbisComment(unsigned char* block, unsigned long length)
+{
+	unsigned long index, fieldLength, commentCount, copyLength;
+	char comment[charLineSize];
+	char* tagContents;
+
+	if(length < 8) return;
+
+	//Skip the vendor string
+	fieldLength = block[0] | (block[1] << 8) | (block[2] << 16) | (block[3] << 24);
+	if(fieldLength > length - 8) return;
+	index = 4 + fieldLength;
+
+	commentCount = block[index] | (block[index+1] << 8) | (block[index+2] << 16) | (block[index+3] << 24);
+	index += 4;
+
+	while(commentCount-- && index + 4 <= length)
+	{
+		fieldLength = block[index] | (block[index+1] << 8) | (block[index+2] << 16) | (block[index+3] << 24);
+		index += 4;
+		if(fieldLength > length - index) return;
+
+		//Long comments are cut to what fits in trackInfo
+		copyLength = fieldLength;
+		if(copyLength > charLineSize-1) copyLength = charLineSize-1;
+		memcpy(comment, &block[index], copyLength);
+		comment[copyLength] = '\0';
+		index += fieldLength;
+
+		//Make another with just contents
+		tagContents = strchr(comment, '=');
+		if(tagContents == NULL) continue;
+		tagContents[0] = '\0';
+		tagContents = &tagContents[1];
+		strToUppercase(comment);
+
+		if(strcmp(comment, "ARTIST") == 0)
+		{
+			strcpy(g_currentTrackInfo.artist, tagContents);
+		}
+		else if(strcmp(comment, "TITLE") == 0)
+		{
+			strcpy(g_currentTrackInfo.title, tagContents);
+		}
+		else if(strcmp(comment, "ALBUM") == 0)
+		{
+			strcpy(g_currentTrackInfo.album, tagContents);
+		}
+		//Uses general feild first character
+		else if(strcmp(comment, "TRACKNUMBER") == 0)
+		{
+			long long_trackNumber;
+			xatoi(&tagContents, &long_trackNumber);
+			g_currentTrackInfo.general[0] = (char) long_trackNumber;
+		}
+	}
+}
+
+//Reads the three Vorbis headers at the start of an Ogg stream, the comments go to g_currentTrackInfo
+//With context NULL only the comments are read (file index), otherwise context is ready to decode
+int parceOGGmetadata(trackStream* track, OggStream* stream, VorbisContext* context)
+{
+	unsigned char* packet;
+	unsigned long packetLength;
+	int header;
+	int result;
+
+	//Packets are assembled at the start of the decoder tables
+	ogg_init(stream, oggReadTrack, track, g_decoderTables);
+
+	for(header = 1; header <= 5; header += 2)
+	{
+		result = ogg_read_packet(stream, &packet, &packetLength);
+
+		//A comment header bigger than the packet buffer (cover art) is skipped
+		if(result < 0 && header == 3)
+		{
+			if(context == NULL) return 0;
+			continue;
+		}
+
+		if(result != 0)
+		{
+			xprintf("Read failure\n");
+			return 1;
+		}
+
+		if(packetLength < 7 || packet[0] != header || memcmp(&packet[1], "vorbis", 6) != 0)
+		{
+			xprintf("Not a Vorbis stream\n");
+			return 1;
+		}
+
+		if(header == 3)
+		{
+			parceVorbisComment(&packet[7], packetLength - 7);
+			if(context == NULL) return 0;
+		}
+
+		if(context != NULL && vorbis_decode_header(context, packet, packetLength) < 0)
+		{
+			xprintf("Unsupported Vorbis stream\n");
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+int playOGG(trackStream* track, unsigned char* scratchMemory, unsigned long scratchLength, int gapless)
+{
+	OggStream stream;
+	unsigned char* packet;
+	unsigned long packetLength;
+	unsigned long freeBytes;
+	unsigned short* freeBuffer;
+	int64_t decodedSamples = 0;
+	int frames, wantedFrames;
+
+	g_endPlayBack = 0;
+
+	//Working vectors in scratchMemory, codebooks and tables after the packet buffer in SDRAM
+	vorbis_init(&g_vorbisContext, scratchMemory, scratchLength, &g_decoderTables[VORBIS_MAX_PACKET], decoderTableSize - VORBIS_MAX_PACKET);
+
+	//Get the headers we need to play the file
+	if(parceOGGmetadata(track, &stream, &g_vorbisContext) != 0)
+	{
+		xprintf("Failed to get Vorbis context\n");
+		return 1;
+	}
+
+	xprintf("Playing...\n");
+
+	setSampleRate(g_vorbisContext.samplerate);
+
+	//If not gapless or playing first track
+	if(gapless == 0 || g_playFlag == 0)
+	{
+		g_playFlag = 0;
+		g_bufferFlag = 0;
+	}
+
+	while(ogg_read_packet(&stream, &packet, &packetLength) == 0)
+	{
+		//Bad packets are dropped, the next one decodes normally
+		if(vorbis_decode_packet(&g_vorbisContext, packet, packetLength) < 0) continue;
+
+		//The granule position of the last page trims the padding of the last block
+		if(stream.eos && stream.granule >= 0)
+		{
+			vorbis_limit_pcm(&g_vorbisContext, (int) (stream.granule - decodedSamples));
+		}
+
+		//Overlap-add straight into the wave buffers
+		do
+		{
+			freeBuffer = (unsigned short*) waveOutGetFree(&freeBytes);
+			wantedFrames = freeBytes/4;
+			frames = vorbis_read_pcm(&g_vorbisContext, freeBuffer, wantedFrames);
+			waveOutCommit(frames*4);
+			decodedSamples += frames;
+		} while(frames == wantedFrames);
+
+		if(g_endPlayBack)break;
+	}
+
+	if(gapless == 0 || g_endPlayBack)
+	{
+		//Clear the buffers
+		int i1;
+
+		for(i1=0; i1 < 4096; i1++)
+		{
+			scratchMemory[i1] = 0;
+		}
+		for(i1=0; i1 <=waveBufferSize*4; i1 += 4096)
+		{
+			waveOut(scratchMemory, 4096, 16);
+		}
+		g_playFlag = 0;
+		g_waveBufferIndex = 0;
+	}
+
+	return 0;
+}
+
+//MPEG audio bitrates in kbps by [table][bitrate index], the table comes from the version and layer
+static const unsigned short g_mpegBitrates[5][15] =
+{
+	{0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448},	//MPEG-1 Layer I
+	{0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384},	//MPEG-1 Layer II
+	{0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320},		//MPEG-1 Layer III
+	{0, 32, 48, 56, 64, 80, 96, 112, 128, 144, 160, 176, 192, 224, 256},	//MPEG-2/2.5 Layer I
+	{0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160}			//MPEG-2/2.5 Layer II and III
+};
+
+static const unsigned short g_mpegSampleRates[3] = {44100, 48000, 32000};
+
+//Decodes a 4 byte MPEG audio frame header into format
+//0 header is valid; 1 header is not valid (free format bitrate is treated as not valid)
+int parceMPEGframe(unsigned char* header, mpegFormat* format)
+{
+	unsigned int version, layer, bitrateIndex, rateIndex, padding;
+
+	if(header[0] != 0xFF || (header[1] & 0xE0) != 0xE0) return 1;
+
+	version = (header[1] >> 3) & 3;	//0 MPEG-2.5; 1 reserved; 2 MPEG-2; 3 MPEG-1
+	layer = 4 - ((header[1] >> 1) & 3);
+	bitrateIndex = header[2] >> 4;
+	rateIndex = (header[2] >> 2) & 3;
+	padding = (header[2] >> 1) & 1;
+
+	if(version == 1 || layer == 4 || bitrateIndex == 0 || bitrateIndex == 15 || rateIndex == 3) return 1;
+
+	format->version = (version == 3) ? 1 : (version == 2) ? 2 : 25;
+	format->layer = layer;
+	format->channels = ((header[3] >> 6) == 3) ? 1 : 2;
+	format->sampleRate = g_mpegSampleRates[rateIndex] >> ((version == 3) ? 0 : (version == 2) ? 1 : 2);
+
+	if(version == 3) format->bitrate = g_mpegBitrates[layer - 1][bitrateIndex];
+	else format->bitrate = g_mpegBitrates[(layer == 1) ? 3 : 4][bitrateIndex];
+
+	//Layer I slots are 4 bytes, MPEG-2/2.5 Layer III frames carry half the samples
+	if(layer == 1)
+	{
+		format->samplesPerFrame = 384;
+		format->frameLength = (12000 * format->bitrate / format->sampleRate + padding) * 4;
+	}
+	else if(layer == 3 && version != 3)
+	{
+		format->samplesPerFrame = 576;
+		format->frameLength = 72000 * format->bitrate / format->sampleRate + padding;
+	}
+	else
+	{
+		format->samplesPerFrame = 1152;
+		format->frameLength = 144000 * format->bitrate / format->sampleRate + padding;
+	}
+
+	return 0;
+}
+
+//Copies an ID3v2 text frame into a trackInfo field, text is ended by the first NUL
+//UTF-16 characters outside ASCII become '?', ISO-8859-1 and UTF-8 bytes are kept as they are
+void copyID3text(char* destination, unsigned char* frame, unsigned long length)
+{
+	unsigned long index, out = 0;
+	unsigned int encoding, character;
+	int bigEndian = 1;
+
+	if(length < 1) return;
+	encoding = frame[0];
+	index = 1;
+
+	if(encoding == 1 || encoding == 2)
+	{
+		//Byte order mark, UTF-16BE (encoding 2) has none
+		if(encoding == 1 && index + 2 <= length)
+		{
+			if(frame[1] == 0xFF && frame[2] == 0xFE) bigEndian = 0;
+			if((frame[1] == 0xFF && frame[2] == 0xFE) || (frame[1] == 0xFE && frame[2] == 0xFF)) index += 2;
+		}
 
+		for(; index + 2 <= length && out < charLineSize-1; index += 2)
+		{
+			character = bigEndian ? ((frame[index] << 8) | frame[index+1]) : (frame[index] | (frame[index+1] << 8));
+			if(character == 0) break;
+			destination[out++] = (character < 0x80) ? (char) character : '?';
+		}
+	}
+	else
+	{
+		for(; index < length && out < charLineSize-1 && frame[index] != 0; index++)
+		{
+			destination[out++] = frame[index];
+		}
+	}
+
+	destination[out] = '\0';
+}
+
+//Reads the ID3v2 tag at the start of an MP3 file into g_currentTrackInfo (TIT2, TPE1, TALB, TRCK)
+//Versions 2.2 to 2.4 are read, the track is left at the first byte after the tag
+//See http://id3.org/id3v2.4.0-structure for ID3v2 format details
+//0 a tag was read or there is none; 1 read failure
+int parceID3tag(trackStream* track)
+{
+	UINT s1 = 0;
+	unsigned char header[10];
+	unsigned char frame[charLineSize*2 + 2];
+	unsigned long framesEnd, tagEnd, frameLength, readLength;
+	unsigned int majorVersion, headerLength, flags;
+	char* field;
+	char trackNumber[charLineSize];
+	unsigned int digit;
+	unsigned char number;
+
+	trackSeek(track, 0);
+	trackRead(track, header, 10, &s1);
+	if(s1 != 10) return 1;
+
+	if(memcmp(header, "ID3", 3) != 0)
+	{
+		trackSeek(track, 0);
+		return 0;
+	}
+
+	//Tag size is syncsafe (7 bits a byte) and does not include the header or footer
+	majorVersion = header[3];
+	framesEnd = 10 + ((header[6] & 0x7F) << 21 | (header[7] & 0x7F) << 14 | (header[8] & 0x7F) << 7 | (header[9] & 0x7F));
+	tagEnd = framesEnd;
+	if(majorVersion == 4 && (header[5] & 0x10)) tagEnd += 10;
+
+	//Frames of an unknown version, or unsynchronised before 2.4, cannot be read in place
+	if(majorVersion < 2 || majorVersion > 4 || (majorVersion < 4 && (header[5] & 0x80)))
+	{
+		return trackSeek(track, tagEnd) != FR_OK;
+	}
+
+	//Extended header, 2.3 size excludes its own length field, 2.4 size is syncsafe and includes it
+	if(majorVersion > 2 && (header[5] & 0x40))
+	{
+		trackRead(track, header, 4, &s1);
+		if(s1 != 4) return 1;
+
+		if(majorVersion == 3) frameLength = 4 + (header[0] << 24 | header[1] << 16 | header[2] << 8 | header[3]);
+		else frameLength = (header[0] & 0x7F) << 21 | (header[1] & 0x7F) << 14 | (header[2] & 0x7F) << 7 | (header[3] & 0x7F);
+
+		trackSeek(track, 10 + frameLength);
+	}
+
+	//Version 2.2 has 3 character IDs and 3 byte sizes, no flags
+	headerLength = (majorVersion == 2) ? 6 : 10;
+
+	while(trackTell(track) + headerLength <= framesEnd)
+	{
+		trackRead(track, header, headerLength, &s1);
+
+		//Padding after the last frame
+		if(s1 != headerLength || header[0] == 0) break;
+
+		flags = 0;
+		if(majorVersion == 2) frameLength = header[3] << 16 | header[4] << 8 | header[5];
+		else if(majorVersion == 3) frameLength = header[4] << 24 | header[5] << 16 | header[6] << 8 | header[7];
+		else frameLength = (header[4] & 0x7F) << 21 | (header[5] & 0x7F) << 14 | (header[6] & 0x7F) << 7 | (header[7] & 0x7F);
+		if(majorVersion > 2) flags = header[9];
+
+		if(frameLength > framesEnd - trackTell(track)) break;
+
+		field = NULL;
+		if(memcmp(header, "TIT2", 4) == 0 || memcmp(header, "TT2", 3) == 0) field = g_currentTrackInfo.title;
+		else if(memcmp(header, "TPE1", 4) == 0 || memcmp(header, "TP1", 3) == 0) field = g_currentTrackInfo.artist;
+		else if(memcmp(header, "TALB", 4) == 0 || memcmp(header, "TAL", 3) == 0) field = g_currentTrackInfo.album;
+		else if(memcmp(header, "TRCK", 4) == 0 || memcmp(header, "TRK", 3) == 0) field = trackNumber;
+
+		//Compressed, encrypted or unsynchronised frames, and 2.4 data length indicators, are skipped
+		if(majorVersion == 3 && (flags & 0xE0)) field = NULL;
+		if(majorVersion == 4 && (flags & 0x0F)) field = NULL;
+
+		if(field != NULL)
+		{
+			readLength = frameLength;
+			if(readLength > sizeof(frame)) readLength = sizeof(frame);
+
+			trackRead(track, frame, readLength, &s1);
+			if(s1 != readLength) return 1;
+
+			copyID3text(field, frame, readLength);
+			frameLength -= readLength;
+
+			//Uses general feild first character, "03/12" reads as track 3
+			if(field == trackNumber)
+			{
+				number = 0;
+				for(digit = 0; trackNumber[digit] >= '0' && trackNumber[digit] <= '9'; digit++)
+				{
+					number = number * 10 + (trackNumber[digit] - '0');
 				}
-				currentCommentNumber++;
+				g_currentTrackInfo.general[0] = number;
 			}
+		}
+
+		if(frameLength) trackSeek(track, trackTell(track) + frameLength);
+	}
+
+	return trackSeek(track, tagEnd) != FR_OK;
+}
+
+//Finds the first MPEG audio frame from the current position of track, a Xing or Info header gives the frame count
+//The track is left at the first frame with audio, which is after the Xing/Info frame when there is one
+//A sync is only taken when another frame header of the same stream follows it (data can look like a sync)
+//The search reads a block at a time and looks for the sync in memory
+//0 format is valid; 1 no MPEG audio found
+int parceMPEGheader(trackStream* track, mpegFormat* format)
+{
+	UINT s1 = 0;
+	UINT frameBytes, blockBytes, i;
+	unsigned char block[256];
+	unsigned char frame[48];
+	unsigned char* xing;
+	mpegFormat next;
+	DWORD blockStart = trackTell(track);
+	DWORD searchEnd = blockStart + 4096;
+	DWORD position;
+
+	//Blocks overlap by 3 bytes so every header is whole in one of them
+	for(; blockStart < searchEnd; blockStart += blockBytes - 3)
+	{
+		trackSeek(track, blockStart);
+		trackRead(track, block, sizeof(block), &blockBytes);
+		if(blockBytes < 4) break;
+
+		for(i = 0; i + 4 <= blockBytes && blockStart + i < searchEnd; i++)
+		{
+			if(parceMPEGframe(&block[i], format) != 0) continue;
+
+			position = blockStart + i;
+			trackSeek(track, position + format->frameLength);
+			trackRead(track, next.header, 4, &s1);
 
-			if(f_lseek(&FLACfile, FLACfile.fptr + metaDataBlockLength-totalReadCount) != FR_OK)
+			//The last frame of a short file has nothing after it
+			if(s1 == 4 && (parceMPEGframe(next.header, &next) != 0 || next.version != format->version
+				|| next.layer != format->layer || next.sampleRate != format->sampleRate)) continue;
+
+			trackSeek(track, position);
+			trackRead(track, frame, sizeof(frame), &frameBytes);
+			memcpy(format->header, frame, 4);
+			format->dataOffset = position;
+			format->frameCount = 0;
+
+			//Xing/Info header follows the side information of the first Layer III frame
+			if(format->layer == 3)
 			{
-				xprintf("File Seek Failed\n");
-				f_close(&FLACfile);
-				return 1;
+				if(format->version == 1) xing = &frame[(format->channels == 1) ? 21 : 36];
+				else xing = &frame[(format->channels == 1) ? 13 : 21];
+
+				//The Xing/Info frame itself holds silence
+				if(xing + 12 <= &frame[frameBytes] && (memcmp(xing, "Xing", 4) == 0 || memcmp(xing, "Info", 4) == 0))
+				{
+					format->dataOffset = position + format->frameLength;
+					if(xing[7] & 1) format->frameCount = xing[8] << 24 | xing[9] << 16 | xing[10] << 8 | xing[11];
+				}
 			}
 
+			trackSeek(track, format->dataOffset);
+			return 0;
+		}
+
+		//End of the file
+		if(blockBytes < sizeof(block)) break;
+	}
+
+	xprintf("No MPEG audio found\n");
+	return 1;
+}
+
+//Reads the next frame of the stream found by parceMPEGheader into buffer (MP3_MAX_FRAME bytes), frame gets its header
+//Bytes that do not start a frame of the stream (damaged data, an ID3v1 tag at the end) are skipped one at a time
+//0 a frame was read; 1 end of the file
+int readMPEGframe(trackStream* track, mpegFormat* format, mpegFormat* frame, unsigned char* buffer)
+{
+	UINT s1 = 0;
+
+	for(;;)
+	{
+		trackRead(track, buffer, 4, &s1);
+		if(s1 != 4) return 1;
+
+		if(parceMPEGframe(buffer, frame) == 0 && frame->layer == format->layer && frame->sampleRate == format->sampleRate
+			&& frame->frameLength <= MP3_MAX_FRAME) break;
+
+		trackSeek(track, trackTell(track) - 3);
+	}
+
+	trackRead(track, &buffer[4], frame->frameLength - 4, &s1);
+
+	return s1 != frame->frameLength - 4;
+}
+
+//Plays the Layer III stream of an MP3 file with mp3/mp3.c, the ID3v2 tag gives the track info
+//Frames are read whole into the decoder tables, the PCM of each goes straight into the wave buffers
+int playMP3(trackStream* track, unsigned char* scratchMemory, unsigned long scratchLength, int gapless)
+{
+	mpegFormat format, frame;
+	unsigned long freeBytes, seconds;
+	unsigned short* freeBuffer;
+	int frames, wantedFrames;
+
+	g_endPlayBack = 0;
+
+	if(parceID3tag(track) != 0 || parceMPEGheader(track, &format) != 0)
+	{
+		return 1;
+	}
+
+	if(format.frameCount) seconds = format.frameCount * format.samplesPerFrame / format.sampleRate;
+	else seconds = (track->file->fsize - format.dataOffset) / (format.bitrate * 125);
+
+	xprintf("MPEG-%s Layer %d, %d Hz, %d channels, %d kbps, %d:%02d\n", (format.version == 1) ? "1" : (format.version == 2) ? "2" : "2.5",
+		format.layer, format.sampleRate, format.channels, format.bitrate, seconds / 60, seconds % 60);
+
+	if(format.layer != 3)
+	{
+		xprintf("Only Layer III is supported\n");
+		return 1;
+	}
+
+	//Bit reservoir, spectra, synthesis and PCM of a frame in scratchMemory
+	if(mp3_init(&g_mp3Context, scratchMemory, scratchLength) != 0)
+	{
+		xprintf("Failed to get MP3 context\n");
+		return 1;
+	}
+
+	xprintf("Playing...\n");
+
+	setSampleRate(format.sampleRate);
+
+	//If not gapless or playing first track
+	if(gapless == 0 || g_playFlag == 0)
+	{
+		g_playFlag = 0;
+		g_bufferFlag = 0;
+	}
+
+	while(readMPEGframe(track, &format, &frame, g_decoderTables) == 0)
+	{
+		//A frame whose bit reservoir was in a skipped or damaged frame gives no PCM
+		if(mp3_decode_frame(&g_mp3Context, g_decoderTables, frame.frameLength) < 0) continue;
+
+		do
+		{
+			freeBuffer = (unsigned short*) waveOutGetFree(&freeBytes);
+			wantedFrames = freeBytes/4;
+			frames = mp3_read_pcm(&g_mp3Context, freeBuffer, wantedFrames);
+			waveOutCommit(frames*4);
+		} while(frames == wantedFrames);
+
+		if(g_endPlayBack)break;
+	}
+
+	if(gapless == 0 || g_endPlayBack)
+	{
+		//Clear the buffers
+		int i1;
+
+		for(i1=0; i1 < 4096; i1++)
+		{
+			scratchMemory[i1] = 0;
+		}
+		for(i1=0; i1 <=waveBufferSize*4; i1 += 4096)
+		{
+			waveOut(scratchMemory, 4096, 16);
+		}
+		g_playFlag = 0;
+		g_waveBufferIndex = 0;
+	}
+
+	return 0;
+}
+
+//Copies one item of an MP4 'ilst' atom (iTunes tags) into g_currentTrackInfo
+//The value is in a 'data' atom: length, 'data', type, locale, then the text or number
+void parceMP4tag(trackStream* track, unsigned char* id, unsigned long length)
+{
+	UINT s1 = 0;
+	unsigned char data[charLineSize + 16];
+	unsigned long dataLength;
+	char* field = NULL;
+
+	if(length > sizeof(data)) length = sizeof(data);
+	trackRead(track, data, length, &s1);
+	if(s1 != length || length < 16 || memcmp(&data[4], "data", 4) != 0) return;
+
+	dataLength = data[0] << 24 | data[1] << 16 | data[2] << 8 | data[3];
+	if(dataLength > length) dataLength = length;
+	if(dataLength < 16) return;
+	dataLength -= 16;
+
+	if(memcmp(id, "\251nam", 4) == 0) field = g_currentTrackInfo.title;
+	else if(memcmp(id, "\251ART", 4) == 0) field = g_currentTrackInfo.artist;
+	else if(memcmp(id, "\251alb", 4) == 0) field = g_currentTrackInfo.album;
+	//Uses general feild first character, trkn is 2 zero bytes then 16-bit track and total
+	else if(memcmp(id, "trkn", 4) == 0)
+	{
+		if(dataLength >= 4) g_currentTrackInfo.general[0] = data[16+3];
+		return;
+	}
+
+	if(field == NULL) return;
+
+	if(dataLength > charLineSize-1) dataLength = charLineSize-1;
+	memcpy(field, &data[16], dataLength);
+	field[dataLength] = '\0';
+}
+
+//Reads the first entry of an MP4 'stsd' atom, an ALAC entry gives mp4 its ALACSpecificConfig
+//Entry: length, codec, 6 reserved, data reference, 20 bytes of sound description, then the 'alac' atom
+//holding version, flags and the config
+void parceMP4sampleDescription(trackStream* track, mp4Track* mp4)
+{
+	UINT s1 = 0;
+	unsigned char entry[48];
+
+	trackRead(track, entry, 48, &s1);
+	if(s1 < 8) return;
+
+	if(memcmp(&entry[4], "mp4a", 4) == 0) mp4->haveAAC = 1;
+
+	if(s1 != 48 || memcmp(&entry[4], "alac", 4) != 0 || memcmp(&entry[40], "alac", 4) != 0 || mp4->haveCookie) return;
+
+	trackRead(track, mp4->cookie, ALAC_COOKIE_SIZE, &s1);
+	if(s1 != ALAC_COOKIE_SIZE) return;
+
+	mp4->haveCookie = 1;
+	mp4->inAudioTrack = 1;
+}
+
+//Reads count entries of entryWords 32-bit big endian words into the table memory of mp4
+unsigned long* readMP4table(trackStream* track, mp4Track* mp4, unsigned long count, unsigned long entryWords)
+{
+	UINT s1 = 0;
+	unsigned long words = count * entryWords;
+	unsigned long* table;
+	unsigned char* bytes;
+	unsigned long i1;
+
+	if(count > (mp4->tableSize - mp4->tableUsed) / (4 * entryWords))
+	{
+		xprintf("MP4 tables too big\n");
+		return NULL;
+	}
+
+	table = (unsigned long*) &mp4->tableMemory[mp4->tableUsed];
+	bytes = (unsigned char*) table;
+
+	trackRead(track, table, words * 4, &s1);
+	if(s1 != words * 4) return NULL;
+
+	for(i1 = 0; i1 < words; i1++)
+	{
+		table[i1] = bytes[4*i1] << 24 | bytes[4*i1+1] << 16 | bytes[4*i1+2] << 8 | bytes[4*i1+3];
+	}
+
+	mp4->tableUsed += words * 4;
+	return table;
+}
+
+//Reads one of the sample tables of the ALAC track into the table memory of mp4
+//stsz sample sizes, stsc chunk map, stco/co64 chunk offsets (co64 is cut to 32 bits, a FAT file cannot be bigger)
+//0 table is valid; 1 table is not valid
+int parceMP4sampleTable(trackStream* track, mp4Track* mp4, unsigned char* type)
+{
+	UINT s1 = 0;
+	unsigned char header[8];
+	unsigned long count, i1;
+
+	//Version and flags, then the entry count (stsz has a size for all samples before it)
+	trackRead(track, header, 8, &s1);
+	if(s1 != 8) return 1;
+	count = header[4] << 24 | header[5] << 16 | header[6] << 8 | header[7];
+
+	if(memcmp(type, "stsz", 4) == 0)
+	{
+		mp4->sampleSize = count;
+
+		trackRead(track, header, 4, &s1);
+		if(s1 != 4) return 1;
+		mp4->sampleCount = header[0] << 24 | header[1] << 16 | header[2] << 8 | header[3];
+
+		if(mp4->sampleSize == 0)
+		{
+			mp4->sampleSizes = readMP4table(track, mp4, mp4->sampleCount, 1);
+			if(mp4->sampleSizes == NULL) return 1;
+		}
+	}
+	else if(memcmp(type, "stsc", 4) == 0)
+	{
+		mp4->chunkMap = readMP4table(track, mp4, count, 3);
+		if(mp4->chunkMap == NULL || count == 0 || mp4->chunkMap[0] != 1) return 1;
+		mp4->chunkMapCount = count;
+	}
+	else if(memcmp(type, "stco", 4) == 0)
+	{
+		mp4->chunkOffsets = readMP4table(track, mp4, count, 1);
+		if(mp4->chunkOffsets == NULL) return 1;
+		mp4->chunkCount = count;
+	}
+	else
+	{
+		mp4->chunkOffsets = readMP4table(track, mp4, count, 2);
+		if(mp4->chunkOffsets == NULL) return 1;
+		mp4->chunkCount = count;
+
+		for(i1 = 0; i1 < count; i1++)
+		{
+			if(mp4->chunkOffsets[2*i1] != 0) return 1;
+			mp4->chunkOffsets[i1] = mp4->chunkOffsets[2*i1+1];
+		}
+		mp4->tableUsed -= count * 4;
+	}
+
+	return 0;
+}
+
+//Walks the MP4 atoms from the current position of track up to end, descending into the containers
+//on the way to the sample description, sample tables and tags
+//Sample tables are only read when mp4 has table memory, only those of the first ALAC track are kept
+//0 atoms are valid; 1 atoms are not valid
+int parceMP4atoms(trackStream* track, mp4Track* mp4, DWORD end)
+{
+	UINT s1 = 0;
+	unsigned char atom[16];
+	unsigned long atomLength;
+	DWORD atomStart, atomEnd;
+
+	while(trackTell(track) + 8 <= end)
+	{
+		atomStart = trackTell(track);
+		trackRead(track, atom, 8, &s1);
+		if(s1 != 8) return 1;
+
+		//Length 1 is a 64-bit length after the type, 0 runs to the end
+		atomLength = atom[0] << 24 | atom[1] << 16 | atom[2] << 8 | atom[3];
+		if(atomLength == 1)
+		{
+			trackRead(track, &atom[8], 8, &s1);
+			if(s1 != 8 || (atom[8] | atom[9] | atom[10] | atom[11]) != 0) return 1;
+			atomLength = atom[12] << 24 | atom[13] << 16 | atom[14] << 8 | atom[15];
+		}
+		else if(atomLength == 0) atomLength = end - atomStart;
+
+		atomEnd = atomStart + atomLength;
+		if(atomLength < 8 || atomEnd > end || atomEnd < atomStart) return 1;
+
+		if(memcmp(&atom[4], "moov", 4) == 0 || memcmp(&atom[4], "mdia", 4) == 0 || memcmp(&atom[4], "minf", 4) == 0
+			|| memcmp(&atom[4], "stbl", 4) == 0 || memcmp(&atom[4], "udta", 4) == 0 || memcmp(&atom[4], "ilst", 4) == 0)
+		{
+			if(parceMP4atoms(track, mp4, atomEnd) != 0) return 1;
+		}
+		else if(memcmp(&atom[4], "trak", 4) == 0)
+		{
+			mp4->inAudioTrack = 0;
+			if(parceMP4atoms(track, mp4, atomEnd) != 0) return 1;
+			mp4->inAudioTrack = 0;
+		}
+		else if(memcmp(&atom[4], "meta", 4) == 0)
+		{
+			//iTunes meta has version and flags before its children, QuickTime meta does not
+			trackRead(track, atom, 4, &s1);
+			if(s1 != 4) return 1;
+			if((atom[0] | atom[1] | atom[2] | atom[3]) != 0) trackSeek(track, atomStart + 8);
 
+			if(parceMP4atoms(track, mp4, atomEnd) != 0) return 1;
 		}
-		//TODO handle other metadata
-		else
+		else if(memcmp(&atom[4], "stsd", 4) == 0)
 		{
-			if(f_lseek(&FLACfile, FLACfile.fptr + metaDataBlockLength) != FR_OK)
-			{
-				xprintf("File Seek Failed\n");
-				f_close(&FLACfile);
-				return 1;
-			}
-		}		
-		
+			//Version, flags and entry count
+			trackSeek(track, atomStart + 16);
+			parceMP4sampleDescription(track, mp4);
+		}
+		else if(memcmp(&atom[4], "stsz", 4) == 0 || memcmp(&atom[4], "stsc", 4) == 0
+			|| memcmp(&atom[4], "stco", 4) == 0 || memcmp(&atom[4], "co64", 4) == 0)
+		{
+			if(mp4->inAudioTrack && mp4->tableMemory != NULL && parceMP4sampleTable(track, mp4, &atom[4]) != 0) return 1;
+		}
+		else if(memcmp(&atom[4], "\251nam", 4) == 0 || memcmp(&atom[4], "\251ART", 4) == 0
+			|| memcmp(&atom[4], "\251alb", 4) == 0 || memcmp(&atom[4], "trkn", 4) == 0)
+		{
+			parceMP4tag(track, &atom[4], atomLength - 8);
+		}
 
+		//mdat and everything else is skipped
+		if(trackSeek(track, atomEnd) != FR_OK) return 1;
+	}
 
-	} while(metaDataFlag);
+	return 0;
+}
 
+//Finds the ALAC track of an MP4 file, its tags go to g_currentTrackInfo
+//With tableMemory NULL only the tags and ALACSpecificConfig are read (file index), otherwise the sample tables
+//are read into tableMemory too and mp4 is ready for mp4SeekSample
+//0 file has an ALAC track; 1 it does not
+int parceMP4metadata(trackStream* track, mp4Track* mp4, unsigned char* tableMemory, unsigned long tableSize)
+{
+	memset(mp4, 0, sizeof(mp4Track));
+	mp4->tableMemory = tableMemory;
+	mp4->tableSize = tableSize;
 
-	// track length in ms
-	context->length = (context->totalsamples / context->samplerate) * 1000; 
-	// file size in bytes
-	context->filesize = f_size(&FLACfile);					
-	// current offset is end of metadata in bytes
-	context->metadatalength = FLACfile.fptr;
-	// bitrate of file				
-	context->bitrate = ((context->filesize - context->metadatalength) * 8) / context->length;
+	trackSeek(track, 0);
+	if(parceMP4atoms(track, mp4, track->file->fsize) != 0)
+	{
+		xprintf("Bad MP4 atoms\n");
+		return 1;
+	}
 
-	f_close(&FLACfile);
-	return 0;	
+	if(mp4->haveCookie == 0)
+	{
+		if(mp4->haveAAC) xprintf("AAC not supported\n");
+		else xprintf("No ALAC track\n");
+		return 1;
+	}
+
+	if(tableMemory != NULL && (mp4->sampleCount == 0 || mp4->chunkCount == 0 || mp4->chunkMapCount == 0))
+	{
+		xprintf("No MP4 sample tables\n");
+		return 1;
+	}
 
+	return 0;
 }
 
+//Moves the read position of mp4 to sample, from the tables alone
+//0 sample exists; 1 sample is past the end
+int mp4SeekSample(mp4Track* mp4, unsigned long sample)
+{
+	unsigned long map, chunks, samplesPerChunk, first = 0, i1;
 
+	if(sample >= mp4->sampleCount) return 1;
 
-//Just a dummy function for the flac_decode_frame
-void yield() 
-{
-	//Do nothing
+	//Each chunk map entry is the first chunk (from 1) of a run of chunks with the same number of samples
+	for(map = 0; map < mp4->chunkMapCount; map++)
+	{
+		samplesPerChunk = mp4->chunkMap[3*map+1];
+		if(map + 1 < mp4->chunkMapCount) chunks = mp4->chunkMap[3*(map+1)] - mp4->chunkMap[3*map];
+		else chunks = mp4->chunkCount + 1 - mp4->chunkMap[3*map];
+
+		if(samplesPerChunk == 0) continue;
+		if(sample - first < chunks * samplesPerChunk) break;
+		first += chunks * samplesPerChunk;
+	}
+
+	if(map == mp4->chunkMapCount) return 1;
+
+	mp4->mapIndex = map;
+	mp4->chunk = mp4->chunkMap[3*map] - 1 + (sample - first) / samplesPerChunk;
+	mp4->chunkSample = (sample - first) % samplesPerChunk;
+	mp4->sample = sample;
+
+	if(mp4->chunk >= mp4->chunkCount) return 1;
+
+	mp4->offset = mp4->chunkOffsets[mp4->chunk];
+	for(i1 = sample - mp4->chunkSample; i1 < sample; i1++)
+	{
+		mp4->offset += mp4->sampleSizes ? mp4->sampleSizes[i1] : mp4->sampleSize;
+	}
+
+	return 0;
 }
 
-//FLAC decoder
-int playFLAC(char filePath[], unsigned char* scratchMemory, unsigned long scratchLength, int gapless) 
+//Gives the file offset and length of the sample at the read position of mp4 and moves on to the next
+//0 sample is valid; 1 end of the track
+int mp4NextSample(mp4Track* mp4, DWORD* offset, unsigned long* length)
 {
-	FIL FLACfile;
-	UINT bytesLeft, bytesUsed, s1;
-	int i;
+	if(mp4->sample >= mp4->sampleCount || mp4->chunk >= mp4->chunkCount) return 1;
 
-	FLACContext context;
-	int sampleShift;
-	int16_t samplePair[2];
+	*offset = mp4->offset;
+	*length = mp4->sampleSizes ? mp4->sampleSizes[mp4->sample] : mp4->sampleSize;
 
-	//Pointers to memory chuncks in scratchMemory for decode
-	//fileChunk currently can't be in EPI as it needs byte access
-	unsigned char* bytePointer;
-	unsigned char* fileChunk;
-	int32_t* decodedSamplesLeft;
-	int32_t* decodedSamplesRight;
+	mp4->offset += *length;
+	mp4->sample++;
+	mp4->chunkSample++;
 
-	//Setup the pointers, the defines are in decoder.h
-	bytePointer = (unsigned char*) scratchMemory;
-	fileChunk = bytePointer;
-	decodedSamplesLeft = (int32_t*) &bytePointer[MAX_FRAMESIZE];
-	decodedSamplesRight = (int32_t*) &bytePointer[MAX_FRAMESIZE+4*MAX_BLOCKSIZE];
+	if(mp4->chunkSample >= mp4->chunkMap[3*mp4->mapIndex+1])
+	{
+		mp4->chunk++;
+		mp4->chunkSample = 0;
+		if(mp4->mapIndex + 1 < mp4->chunkMapCount && mp4->chunk + 1 >= mp4->chunkMap[3*(mp4->mapIndex+1)]) mp4->mapIndex++;
+		if(mp4->chunk < mp4->chunkCount) mp4->offset = mp4->chunkOffsets[mp4->chunk];
+	}
+
+	return 0;
+}
+
+int playMP4(trackStream* track, unsigned char* scratchMemory, unsigned long scratchLength, int gapless)
+{
+	mp4Track mp4;
+	DWORD offset;
+	unsigned long length;
+	unsigned long freeBytes;
+	unsigned short* freeBuffer;
+	UINT s1 = 0;
+	int frames, wantedFrames;
 
 	g_endPlayBack = 0;
 
-	//Get the metadata we need to play the file
-	if(parceFLACmetadata(filePath, &context) != 0)
-	{
-		xprintf("Failed to get FLAC context\n");
-		return 1;
-	}
+	//The sample tables overwrite the Vorbis tables kept in the decoder tables, detach them so they are rebuilt
+	vorbis_init(&g_vorbisContext, NULL, 0, NULL, 0);
 
-	if(f_open(&FLACfile, filePath ,FA_READ) != FR_OK) 
+	//Frames are read to the start of the decoder tables, the sample tables follow
+	if(parceMP4metadata(track, &mp4, &g_decoderTables[ALAC_MAX_PACKET], decoderTableSize - ALAC_MAX_PACKET) != 0 || mp4SeekSample(&mp4, 0) != 0)
 	{
-		xprintf("Cannot open: %s\n", filePath);
+		xprintf("Failed to get MP4 tables\n");
 		return 1;
 	}
 
-	xprintf("Opening: %s\nPlaying...\n", filePath);
-
-	//Goto start of stream
-	if(f_lseek(&FLACfile, context.metadatalength) != FR_OK)
+	if(alac_init(&g_alacContext, mp4.cookie, ALAC_COOKIE_SIZE, scratchMemory, scratchLength) != 0)
 	{
-		f_close(&FLACfile);
+		xprintf("Unsupported ALAC stream\n");
 		return 1;
 	}
 
-	//The decoder has sample size defined by FLAC_OUTPUT_DEPTH (currently 29 bit)
-	//Shift for lower bitrate to align MSB correctly
-	sampleShift = FLAC_OUTPUT_DEPTH-context.bps;
+	xprintf("Playing...\n");
+
+	setSampleRate(g_alacContext.samplerate);
 
-	//Fill up fileChunk completely (MAX_FRAMSIZE = valid size of memory fileChunk points to)
-	f_read(&FLACfile, fileChunk, MAX_FRAMESIZE, &bytesLeft);
-	
 	//If not gapless or playing first track
 	if(gapless == 0 || g_playFlag == 0)
 	{
@@ -1252,57 +3722,27 @@ int playFLAC(char filePath[], unsigned char* scratchMemory, unsigned long scratc
 		g_bufferFlag = 0;
 	}
 
-	while (bytesLeft) 
+	while(mp4NextSample(&mp4, &offset, &length) == 0)
 	{
-		if(flac_decode_frame(&context, decodedSamplesLeft, decodedSamplesRight, fileChunk, bytesLeft, yield) < 0) 
-		{
-			xprintf("FLAC Decode Failed\n");
-			break;
-		}		
-
-		//Dump the block to the waveOut
-		i = 0;
-		while(i < context.blocksize) 
-		{
-			//Left Channel
-			samplePair[0] = (uint16_t) (decodedSamplesLeft[i]>>sampleShift);
-
-			if (context.channels==2) 
-			{
-				//Right Channel
-				samplePair[1] = (uint16_t) (decodedSamplesRight[i]>>sampleShift);
-			}
-			else
-			{
-				//Repeat Left channel if mono
-				samplePair[1] = (uint16_t) (decodedSamplesLeft[i]>>sampleShift);
-
-			}
+		if(length > ALAC_MAX_PACKET || trackSeek(track, offset) != FR_OK) break;
 
-			//Sample pair is 4 bytes, 16-bit mode
-			waveOut(samplePair, 4, 16);
-
-			i++;
-		}
-
-		//calculate the number of valid bytes left in the fileChunk buffer
-		bytesUsed = context.gb.index/8;
-		bytesLeft -= bytesUsed;
+		trackRead(track, g_decoderTables, length, &s1);
+		if(s1 != length) break;
 
-		//shift the unused stuff to the front of the fileChunk buffer
-		memmove(fileChunk, &fileChunk[bytesUsed], bytesLeft);
+		//Bad frames are dropped, the next one decodes normally
+		if(alac_decode_frame(&g_alacContext, g_decoderTables, length) < 0) continue;
 
-		//Refill the fileChunk buffer
-		f_read(&FLACfile, &fileChunk[bytesLeft], MAX_FRAMESIZE - bytesLeft, &s1);
-		
-		//add however many were read
-		bytesLeft += s1;
+		do
+		{
+			freeBuffer = (unsigned short*) waveOutGetFree(&freeBytes);
+			wantedFrames = freeBytes/4;
+			frames = alac_read_pcm(&g_alacContext, freeBuffer, wantedFrames);
+			waveOutCommit(frames*4);
+		} while(frames == wantedFrames);
 
 		if(g_endPlayBack)break;
 	}
 
-	f_close(&FLACfile);
-
 	if(gapless == 0 || g_endPlayBack)
 	{
 		//Clear the buffers
@@ -1310,11 +3750,11 @@ int playFLAC(char filePath[], unsigned char* scratchMemory, unsigned long scratc
 
 		for(i1=0; i1 < 4096; i1++)
 		{
-			fileChunk[i1] = 0;
+			scratchMemory[i1] = 0;
 		}
 		for(i1=0; i1 <=waveBufferSize*4; i1 += 4096)
 		{
-			waveOut(fileChunk, 4096, 16);
+			waveOut(scratchMemory, 4096, 16);
 		}
 		g_playFlag = 0;
 		g_waveBufferIndex = 0;
@@ -1360,6 +3800,7 @@ void configureHW(void)
 
 	//*********** System tick ***********
 	SysTickPeriodSet(SysCtlClockGet() / SYSTICK_HZ);
+	g_clocksPerMicrosecond = SysCtlClockGet() / 1000000;
 	SysTickEnable();
 	SysTickIntEnable();
 
@@ -1471,6 +3912,48 @@ void configureHW(void)
 	g_libraryDataBase = &g_pusEPISdram[waveBufferSize*2];
 	g_libraryDataCurrent = g_libraryDataBase;
 
+	//Decoder tables take the end of the SDRAM
+	g_decoderTables = (unsigned char *) &g_pusEPISdram[SDRAM_END_ADDRESS + 1 - decoderTableSize/2];
+
+	//Link maps sit below the decoder tables
+	g_indexLinkMap = (DWORD *) (g_decoderTables - linkMapSize);
+	g_trackLinkMap = (DWORD *) (g_decoderTables - 2*linkMapSize);
+
+#if _USE_LFN
+	//f_readdir returns long names in g_lfnName
+	g_fileInfo.lfname = g_lfnName;
+	g_fileInfo.lfsize = sizeof(g_lfnName);
+#endif
+
+	//Sector cache below the link maps, the FatFs windows are pinned and the track is streamed past it
+	//(the track header, the wave buffers for WAV and the read-ahead ring)
+	disk_cache_init((unsigned char *) g_trackLinkMap - diskCacheSize, diskCacheSize);
+	disk_cache_buffer(g_FatFs.win, sizeof(g_FatFs.win), DISK_CACHE_PIN);
+	disk_cache_buffer(g_FatFs.fatwin, sizeof(g_FatFs.fatwin), DISK_CACHE_PIN);
+	disk_cache_buffer(g_track.header, sizeof(g_track.header), DISK_CACHE_NONE);
+	disk_cache_buffer((BYTE *) g_waveBufferA, waveBufferSize*2*sizeof(unsigned short), DISK_CACHE_NONE);
+
+	//Read-ahead ring below the sector cache, fills at any offset into it skip the cache
+	//bench disk also reads into it, so the drive itself is timed
+	g_readAheadBuffer = (unsigned char *) g_trackLinkMap - diskCacheSize - readAheadSize;
+	disk_cache_buffer(g_readAheadBuffer, readAheadSize, DISK_CACHE_NONE);
+
+	//index.txt write buffer below the read-ahead ring
+	g_indexWriteBuffer = g_readAheadBuffer - indexWriteSize;
+
+	//File handles below the write buffer, the track and index.txt keep theirs and the track is streamed
+	g_fileHandles = (FIL *) g_indexWriteBuffer - fileHandles;
+	g_track.file = fileHandleGet();
+	g_indexFile = fileHandleGet();
+	disk_cache_buffer(g_track.file->buf, sizeof(g_track.file->buf), DISK_CACHE_NONE);
+
+	//Directory stack for walkFiles below the file handles
+	g_walkStack = (walkLevel *) g_fileHandles - walkDepth;
+
+	//index.txt string pool and its hash table below the stack
+	g_indexPool = (unsigned char *) g_walkStack - indexPoolSize;
+	g_indexHash = (DWORD *) g_indexPool - indexHashSize;
+
 
 	//*********** I2S ***********
 	unsigned long sampleRate;
@@ -1754,112 +4237,268 @@ void strToUppercase(char * string)
 }
 
 
-//This is basically "ls"
-//This code is from Chan's FatFs examples
-static FRESULT scan_files (
-	char* path		/* Pointer to the working buffer with start path */
-)
+//Walks the files and directories under path (a charLineSize buffer) calling visit for each, the path of
+//the entry is added to path while it is visited and path is left as it was
+//Directories are visited before their entries and only entered when recurse is set, they are opened
+//from the entry f_readdir found them at so the walk does not follow each path from the root again
+FRESULT walkFiles(char* path, int recurse, walkVisitor visit, void* context)
 {
-	DIR dirs;
+	walkLevel* level = g_walkStack;
 	FRESULT res;
-	int i;
-	char *fn;
-
-	res = f_opendir(&dirs, path);
-	//put_rc(res);
-	if (res == FR_OK) {
-		i = strlen(path);
-		while (((res = f_readdir(&dirs, &g_fileInfo)) == FR_OK) && g_fileInfo.fname[0]) {
-			if (_FS_RPATH && g_fileInfo.fname[0] == '.') continue;
-#if _USE_LFN
-			fn = *g_fileInfo.lfname ? g_fileInfo.lfname : g_fileInfo.fname;
-#else
-			fn = g_fileInfo.fname;
-#endif
-			if (g_fileInfo.fattrib & AM_DIR) {
-				g_acc_dirs++;
-				xprintf("%s/%s\n", path, fn);
-				// The next 4 lines does recursive calling (if desired)
-				//*(path+i) = '/'; strcpy(path+i+1, fn);
-				//res = scan_files(path);
-				//*(path+i) = '\0';
-				//if (res != FR_OK) break;
-				
-			} else {
-				xprintf("%s/%s\n", path, fn);
-				g_acc_files++;
-				g_acc_size += g_fileInfo.fsize;
-			}
+	UINT length;
+	char* fn;
+
+	level->pathLength = strlen(path);
+	res = f_opendir(&level->dir, path);
+
+	while(res == FR_OK)
+	{
+		length = level->pathLength;
+		path[length] = '\0';
+		res = f_readdir(&level->dir, &g_fileInfo);
+		if(res != FR_OK) break;
+
+		//End of the directory, carry on with its parent
+		if(g_fileInfo.fname[0] == '\0')
+		{
+			if(level == g_walkStack) break;
+			level--;
+			continue;
+		}
+		if(_FS_RPATH && g_fileInfo.fname[0] == '.') continue;
+
+		fn = fileInfoName(path);
+		path[length] = '/';
+		strcpy(&path[length + 1], fn);
+
+		res = visit(path, context);
+		if(res != FR_OK || !recurse || !(g_fileInfo.fattrib & AM_DIR)) continue;
+
+		if(level == &g_walkStack[walkDepth - 1])
+		{
+			xprintf("Too deep: %s\n", path);
+			continue;
 		}
+		res = f_opensubdir(&level[1].dir, &level->dir);
+		level++;
+		level->pathLength = length + 1 + strlen(fn);
 	}
 
+	path[g_walkStack[0].pathLength] = '\0';
 	return res;
 }
 
+//This is basically "ls", ls -r lists the sub-directories too
+static FRESULT scan_files (
+	char* args		/* Pointer to the working buffer with [-r] start path */
+)
+{
+	int recurse = 0;
+	char* path = args;
+
+	if(args[0] == '-' && args[1] == 'r' && (args[2] == ' ' || args[2] == '\0'))
+	{
+		recurse = 1;
+		path = &args[2];
+		while(*path == ' ') path++;
+
+		//The path has to start the buffer so the walk can add charLineSize of names to it
+		memmove(args, path, strlen(path) + 1);
+	}
+
+	return walkFiles(args, recurse, lsVisit, NULL);
+}
+
+//Prints an entry for ls
+static FRESULT lsVisit(char* path, void* context)
+{
+	xprintf("%s\n", path);
+	if (g_fileInfo.fattrib & AM_DIR) {
+		g_acc_dirs++;
+	} else {
+		g_acc_files++;
+		g_acc_size += g_fileInfo.fsize;
+	}
+
+	return FR_OK;
+}
+
 
 
 //Builds up the file metadata for files to play
-static FRESULT buildFileIndex (char* path, FIL* openFile)
+static FRESULT buildFileIndex (char* path, indexWriter* index)
 {
-	DIR dirs;
-	FRESULT res;
-	int i;
-	char *fn;
-	UINT s1;
-	int length;
+	return walkFiles(path, 1, indexVisit, index);
+}
+
+//Probes a file found by buildFileIndex and adds it to the index in context (an indexWriter)
+//Only directories are printed, the UART waits for each character and with long names printing
+//the path of every file took longer than reading the drive
+static FRESULT indexVisit(char* path, void* context)
+{
+	indexWriter* index = (indexWriter*) context;
+
+	if (g_fileInfo.fattrib & AM_DIR) {
+		xprintf("%s\n", path);
+		g_acc_dirs++;
+		return FR_OK;
+	}
 
-	res = f_opendir(&dirs, path);
-	//put_rc(res);
-	if (res == FR_OK) {
-		i = strlen(path);
-		while (((res = f_readdir(&dirs, &g_fileInfo)) == FR_OK) && g_fileInfo.fname[0]) {
-			if (_FS_RPATH && g_fileInfo.fname[0] == '.') continue;
+	//clear the dataStructure for writing
+	memset(&g_currentTrackInfo, 0, sizeof(g_currentTrackInfo));
+
+	//Add path info
+	strcpy(g_currentTrackInfo.path, path);
+
+	switch(probeFile(&g_track, g_currentTrackInfo.path))
+	{
+		case FORMAT_FLAC:
+		{
+			FLACContext context;
+			parceFLACmetadata(&g_track, &context);
+			indexWriterAddTrack(index);
+		}
+		break;
+
+		case FORMAT_OGG:
+		{
+			OggStream stream;
+			if(parceOGGmetadata(&g_track, &stream, NULL) == 0)
+			{
+				indexWriterAddTrack(index);
+			}
+		}
+		break;
+
+		case FORMAT_MP3:
+		{
+			mpegFormat format;
+			if(parceID3tag(&g_track) == 0 && parceMPEGheader(&g_track, &format) == 0 && format.layer == 3)
+			{
+				if(g_currentTrackInfo.title[0] == '\0') strcpy(g_currentTrackInfo.title, "UNKNOWN");
+				if(g_currentTrackInfo.artist[0] == '\0') strcpy(g_currentTrackInfo.artist, "UNKNOWN");
+				if(g_currentTrackInfo.album[0] == '\0') strcpy(g_currentTrackInfo.album, "UNKNOWN");
+				indexWriterAddTrack(index);
+			}
+		}
+		break;
+
+		case FORMAT_MP4:
+		{
+			mp4Track mp4;
+			if(parceMP4metadata(&g_track, &mp4, NULL, 0) == 0)
+			{
+				indexWriterAddTrack(index);
+			}
+		}
+		break;
+
+		case FORMAT_WAV:
+		strcpy(g_currentTrackInfo.title, "UNKNOWN");
+		strcpy(g_currentTrackInfo.artist, "UNKNOWN");
+		strcpy(g_currentTrackInfo.album, "UNKNOWN");
+		g_currentTrackInfo.general[0] = 0;		
+		indexWriterAddTrack(index);
+		break;
+
+		default:
+		break;
+	}
+
+	if(g_track.format != FORMAT_UNKNOWN) f_close(g_track.file);
+
+	g_acc_files++;
+	g_acc_size += g_fileInfo.fsize;
+
+	return FR_OK;
+}
+
+
+//Name of the entry in g_fileInfo to add to path, its long name unless that would not fit in a
+//charLineSize path (index.txt paths and the command buffer), the 8.3 name opens the same file
+char* fileInfoName(char* path)
+{
 #if _USE_LFN
-			fn = *g_fileInfo.lfname ? g_fileInfo.lfname : g_fileInfo.fname;
-#else
-			fn = g_fileInfo.fname;
+	if(g_fileInfo.lfname[0] && strlen(path) + strlen(g_fileInfo.lfname) + 2 <= charLineSize) return g_fileInfo.lfname;
 #endif
-			if (g_fileInfo.fattrib & AM_DIR) {
-				g_acc_dirs++;
-				*(path+i) = '/'; strcpy(path+i+1, fn);
-				res = buildFileIndex(path, openFile);
-				*(path+i) = '\0';
-				if (res != FR_OK) break;
-			} else {
-				xprintf("%s/%s\n", path, fn);
-
-				//clear the dataStructure for writing
-				memset(&g_currentTrackInfo, 0, sizeof(g_currentTrackInfo));
-
-				//Add path info		
-				strcpy(g_currentTrackInfo.path, path);
-				strcat(g_currentTrackInfo.path, "/");
-				strcat(g_currentTrackInfo.path, fn);			
-				
-				length = strlen(g_currentTrackInfo.path);				
-				if(memcmp(&g_currentTrackInfo.path[length-3], "FLA", 3) == 0)
-				{
-					FLACContext context;
-					parceFLACmetadata(g_currentTrackInfo.path, &context);
-					f_write(openFile, &g_currentTrackInfo, sizeof(g_currentTrackInfo), &s1);
-				}
-				else if(memcmp(&g_currentTrackInfo.path[length-3], "WAV", 3) == 0)
-				{					
-					strcpy(g_currentTrackInfo.title, "UNKNOWN");
-					strcpy(g_currentTrackInfo.artist, "UNKNOWN");
-					strcpy(g_currentTrackInfo.album, "UNKNOWN");
-					g_currentTrackInfo.general[0] = 0;		
-					f_write(openFile, &g_currentTrackInfo, sizeof(g_currentTrackInfo), &s1);
-				}
+	return g_fileInfo.fname;
+}
+
+//Counts the cluster runs of a file found by frag, keeping the worst ones in g_fragWorst
+//context is a handle from the pool that each file is opened in
+static FRESULT fragVisit (char* path, void* context)
+{
+	FIL* file = (FIL*) context;
+	DWORD runs;
+	int j;
 
-							
-				g_acc_files++;
-				g_acc_size += g_fileInfo.fsize;
+	if (g_fileInfo.fattrib & AM_DIR) return FR_OK;
+
+	if (f_open(file, path, FA_OPEN_EXISTING | FA_READ) == FR_OK) {
+		runs = fileClusterRuns(file);
+		f_close(file);
+
+		g_fragFiles++;
+		g_fragRuns += runs;
+		if (runs > 1) {
+			g_fragFragmented++;
+			g_fragExtra += runs - 1;
+
+			//Insert in order, dropping the last one when the list is full
+			for (j = fragWorstCount; j > 0 && g_fragWorst[j-1].runs < runs; j--) {
+				if (j < fragWorstCount) g_fragWorst[j] = g_fragWorst[j-1];
+			}
+			if (j < fragWorstCount) {
+				g_fragWorst[j].runs = runs;
+				g_fragWorst[j].size = g_fileInfo.fsize;
+				strcpy(g_fragWorst[j].path, path);
 			}
 		}
 	}
 
-	return res;
+	return FR_OK;
+}
+
+//Returns the number of cluster runs of an open file (0 when it has no clusters) by walking its FAT chain
+//The one item table is too small for any run, but FatFs still stores the size a full table would need
+DWORD fileClusterRuns(FIL* file)
+{
+	DWORD table[2];
+
+	table[0] = 1;
+	file->cltbl = table;
+	f_lseek(file, CREATE_LINKMAP);
+	file->cltbl = 0;
+
+	if(table[0] < 2) return 0;
+	return (table[0] - 2) / 2;
 }
 
+//frag [path] prints how many cluster runs the files under path have and lists the worst of them
+//Playback reads runs of adjacent clusters with one USB command, so each extra run costs about one
+//more command a playback, files with more runs than a link map holds also fall back to FAT walks
+void fragReport(char* path)
+{
+	FIL* file;
+	int i;
+
+	memset(g_fragWorst, 0, sizeof(g_fragWorst));
+	g_fragFiles = g_fragFragmented = g_fragRuns = g_fragExtra = 0;
+
+	file = fileHandleGet();
+	if(file == 0 || walkFiles(path, 1, fragVisit, file) != FR_OK) xprintf("Scan stopped early\n");
+	fileHandlePut(file);
+
+	xprintf("Files: %lu Fragmented: %lu Cluster runs: %lu\n", g_fragFiles, g_fragFragmented, g_fragRuns);
+	xprintf("Extra USB reads to play every file once: %lu\n", g_fragExtra);
+
+	if(g_fragWorst[0].runs == 0) return;
+
+	xprintf("Most fragmented:\n    Runs    Extra  Size KB  Path\n");
+	for(i = 0; i < fragWorstCount && g_fragWorst[i].runs; i++)
+	{
+		xprintf("%8lu %8lu %8lu  %s%s\n", g_fragWorst[i].runs, g_fragWorst[i].runs - 1, g_fragWorst[i].size / 1024, g_fragWorst[i].path,
+			g_fragWorst[i].runs > linkMapSize / 8 - 1 ? " (too many for the link map)" : "");
+	}
+}
 
@@ -0,0 +1,230 @@
+/*
+Fixed-point inverse MDCT for the openHiFi Vorbis decoder
+
+Copyright (C) 2011 teho Labs/B. A. Bryce
+
+The IMDCT of size n is computed from a DCT-IV of size n/2, which is done with
+a complex FFT of size n/4 between a pre- and a post-twiddle. The spectrum is
+block scaled before the FFT so that quiet blocks keep their precision and loud
+ones cannot overflow.
+
+Please see project readme for more details on licenses
+*/
+
+#include <string.h>
+#include "vorbis.h"
+
+#define PI 3.14159265358979323846
+
+static inline int32_t MULT31(int32_t x, int32_t y)
+{
+    return (int32_t)(((int64_t)x * y) >> 31);
+}
+
+/* Taylor series, good to double precision for x in [-pi/2, pi/2] */
+static double taylor_sin(double x)
+{
+    double term = x;
+    double sum = x;
+    double square = x * x;
+    int i;
+
+    for (i = 2; i < 24; i += 2) {
+        term = -term * square / (i * (i + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+/* The tables are built once per blocksize so libm is not needed */
+static double table_sin(double x)
+{
+    if (x > PI / 2)
+        x = PI - x;
+    else if (x < -PI / 2)
+        x = -PI - x;
+    return taylor_sin(x);
+}
+
+static double table_cos(double x)
+{
+    return table_sin(PI / 2 - x);
+}
+
+static int32_t to_q31(double x)
+{
+    x = x * 2147483648.0 + (x < 0 ? -0.5 : 0.5);
+    if (x >= 2147483647.0)
+        return 0x7fffffff;
+    if (x <= -2147483647.0)
+        return -0x7fffffff;
+    return (int32_t)x;
+}
+
+int vorbis_tables_init(VorbisTables *t, int n, int32_t *memory)
+{
+    int m = n >> 1;
+    int h = n >> 2;
+    int i;
+    double s;
+
+    t->n = n;
+    t->pre = memory;
+    t->fft = t->pre + 2 * h;
+    t->post = t->fft + h;
+    t->window = t->post + 2 * h;
+
+    for (i = 0; i < h; i++) {
+        t->pre[2 * i] = to_q31(table_cos(PI * (i + 0.25) / m));
+        t->pre[2 * i + 1] = to_q31(table_sin(PI * (i + 0.25) / m));
+        t->post[2 * i] = to_q31(table_cos(PI * i / m));
+        t->post[2 * i + 1] = to_q31(table_sin(PI * i / m));
+    }
+    for (i = 0; i < h / 2; i++) {
+        t->fft[2 * i] = to_q31(table_cos(2 * PI * i / h));
+        t->fft[2 * i + 1] = to_q31(table_sin(2 * PI * i / h));
+    }
+
+    /* Vorbis power complementary window: sin(pi/2 * sin^2((i + 0.5) / m * pi/2)) */
+    for (i = 0; i < m; i++) {
+        s = table_sin((i + 0.5) / m * (PI / 2));
+        t->window[i] = to_q31(table_sin(PI / 2 * s * s));
+    }
+
+    return VORBIS_TABLE_SIZE(n);
+}
+
+static inline int32_t block_scale(int32_t x, int shift)
+{
+    if (shift >= 0)
+        return (int32_t)((uint32_t)x << shift);
+    return (x + (1 << (-shift - 1))) >> -shift;
+}
+
+/* In place radix-2 FFT of h complex values, twiddles are exp(-2 pi i j / h) */
+static void ICODE_ATTR_VORBIS fft(int32_t *z, const int32_t *twiddle, int h)
+{
+    int size, half, step;
+    int i, j, k;
+    int32_t re, im, c, s, tr, ti;
+    int32_t *a, *b;
+
+    /* Bit reversed reordering */
+    for (i = 0, j = 0; i < h - 1; i++) {
+        if (i < j) {
+            re = z[2 * i];
+            im = z[2 * i + 1];
+            z[2 * i] = z[2 * j];
+            z[2 * i + 1] = z[2 * j + 1];
+            z[2 * j] = re;
+            z[2 * j + 1] = im;
+        }
+        k = h >> 1;
+        while (k <= j) {
+            j -= k;
+            k >>= 1;
+        }
+        j += k;
+    }
+
+    /* First stage has only the trivial twiddle */
+    for (i = 0; i < h; i += 2) {
+        a = z + 2 * i;
+        re = a[2];
+        im = a[3];
+        a[2] = a[0] - re;
+        a[3] = a[1] - im;
+        a[0] += re;
+        a[1] += im;
+    }
+
+    for (size = 4, step = h >> 2; size <= h; size <<= 1, step >>= 1) {
+        half = size >> 1;
+        for (j = 0; j < half; j++) {
+            c = twiddle[2 * j * step];
+            s = twiddle[2 * j * step + 1];
+            for (k = j; k < h; k += size) {
+                a = z + 2 * k;
+                b = z + 2 * (k + half);
+                tr = MULT31(b[0], c) + MULT31(b[1], s);
+                ti = MULT31(b[1], c) - MULT31(b[0], s);
+                b[0] = a[0] - tr;
+                b[1] = a[1] - ti;
+                a[0] += tr;
+                a[1] += ti;
+            }
+        }
+    }
+}
+
+/* buffer holds n/2 spectral values on entry and n time samples on return */
+void ICODE_ATTR_VORBIS vorbis_imdct(VorbisTables *t, int32_t *buffer)
+{
+    int n = t->n;
+    int m = n >> 1;
+    int h = n >> 2;
+    int32_t *x = buffer;
+    int32_t *z = buffer + m;
+    const int32_t *w;
+    uint32_t peak = 0;
+    int bits, shift, log_h;
+    int32_t re, im, c, s;
+    int i;
+
+    for (i = 0; i < m; i++)
+        peak |= x[i] < 0 ? -x[i] : x[i];
+    if (peak == 0) {
+        memset(buffer, 0, n * sizeof(int32_t));
+        return;
+    }
+
+    /* Sums in the FFT can grow h * sqrt(2) times, keep two spare bits on top of that */
+    for (bits = 0; (peak >> bits) != 0; bits++)
+        ;
+    for (log_h = 0; (1 << log_h) < h; log_h++)
+        ;
+    shift = 29 - log_h - bits;
+
+    /* Pre-twiddle: z[k] = (x[2k] + i x[m-1-2k]) * exp(-i pi (k + 1/4) / m) */
+    w = t->pre;
+    for (i = 0; i < h; i++) {
+        re = block_scale(x[2 * i], shift);
+        im = block_scale(x[m - 1 - 2 * i], shift);
+        c = w[2 * i];
+        s = w[2 * i + 1];
+        z[2 * i] = MULT31(re, c) + MULT31(im, s);
+        z[2 * i + 1] = MULT31(im, c) - MULT31(re, s);
+    }
+
+    fft(z, t->fft, h);
+
+    /* Post-twiddle by exp(-i pi j / m) gives the DCT-IV, even outputs from
+       the real parts and odd ones from the imaginary parts in reverse */
+    w = t->post;
+    for (i = 0; i < h; i++) {
+        re = z[2 * i];
+        im = z[2 * i + 1];
+        c = w[2 * i];
+        s = w[2 * i + 1];
+        x[2 * i] = block_scale(MULT31(re, c) + MULT31(im, s), -shift);
+        x[m - 1 - 2 * i] = block_scale(MULT31(re, s) - MULT31(im, c), -shift);
+    }
+
+    /* Unfold the n/2 DCT-IV outputs u into the n IMDCT outputs y:
+       y[i] = u[i + n/4], y[n/2 - 1 - i] = -u[i + n/4] for i < n/4
+       y[3n/4 - 1 - i] = -u[i], y[3n/4 + i] = -u[i] for i < n/4 */
+    for (i = 0; i < h; i++) {
+        x[n - h + i] = -x[i];
+    }
+    for (i = 0; i < h; i++) {
+        x[n - h - 1 - i] = x[n - h + i];
+    }
+    for (i = 0; i < h / 2; i++) {
+        re = x[h + i];
+        im = x[m - 1 - i];
+        x[i] = re;
+        x[m - 1 - i] = -re;
+        x[h - 1 - i] = im;
+        x[h + i] = -im;
+    }
+}
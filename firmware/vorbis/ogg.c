@@ -0,0 +1,132 @@
+/*
+Ogg page and packet reader for openHiFi
+
+Copyright (C) 2011 teho Labs/B. A. Bryce
+
+Only one logical stream (the first one found) is followed, pages of other
+streams are skipped. Page CRCs are not checked.
+
+Please see project readme for more details on licenses
+*/
+
+#include <string.h>
+#include "vorbis.h"
+
+#define OGG_PAGE_HEADER 27
+
+void ogg_init(OggStream *s, ogg_read_function read, void *handle, uint8_t *packet_buffer)
+{
+    memset(s, 0, sizeof(OggStream));
+    s->read = read;
+    s->handle = handle;
+    s->packet = packet_buffer;
+    s->granule = -1;
+}
+
+static int skip_bytes(OggStream *s, unsigned long length)
+{
+    uint8_t discard[64];
+    unsigned long count;
+
+    while (length > 0) {
+        count = length > sizeof(discard) ? sizeof(discard) : length;
+        if (s->read(s->handle, discard, count) != count)
+            return -1;
+        length -= count;
+    }
+    return 0;
+}
+
+/* Reads the next page header of our logical stream, 0 = ok, 1 = end of file */
+static int next_page(OggStream *s)
+{
+    uint8_t header[OGG_PAGE_HEADER];
+    uint32_t serial;
+    unsigned long body;
+    int i;
+
+    for (;;) {
+        if (s->read(s->handle, header, OGG_PAGE_HEADER) != OGG_PAGE_HEADER)
+            return 1;
+
+        /* Lost sync: hunt for the next capture pattern byte by byte */
+        while (memcmp(header, "OggS", 4) != 0) {
+            memmove(header, header + 1, OGG_PAGE_HEADER - 1);
+            if (s->read(s->handle, header + OGG_PAGE_HEADER - 1, 1) != 1)
+                return 1;
+        }
+        if (header[4] != 0)
+            return -1;
+
+        s->segment_count = header[26];
+        if (s->read(s->handle, s->segments, s->segment_count) != (unsigned long)s->segment_count)
+            return 1;
+
+        serial = header[14] | (header[15] << 8) | (header[16] << 16) | ((uint32_t)header[17] << 24);
+        if (!s->have_serial && (header[5] & 0x02)) {
+            s->serial = serial;
+            s->have_serial = 1;
+        }
+
+        if (s->have_serial && serial == s->serial) {
+            s->page_granule = 0;
+            for (i = 13; i >= 6; i--)
+                s->page_granule = (s->page_granule << 8) | header[i];
+            s->page_eos = header[5] & 0x04;
+            s->segment_index = 0;
+            return 0;
+        }
+
+        body = 0;
+        for (i = 0; i < s->segment_count; i++)
+            body += s->segments[i];
+        if (skip_bytes(s, body))
+            return 1;
+    }
+}
+
+/* Returns 0 and the next packet, 1 at the end of the stream, -1 on error */
+int ogg_read_packet(OggStream *s, uint8_t **packet, unsigned long *length)
+{
+    unsigned long size = 0;
+    int lacing;
+    int result;
+
+    s->granule = -1;
+    s->eos = 0;
+
+    for (;;) {
+        if (s->segment_index >= s->segment_count) {
+            if (s->page_eos && size == 0)
+                return 1;
+            result = next_page(s);
+            if (result)
+                return result;
+            continue;
+        }
+
+        lacing = s->segments[s->segment_index++];
+        if (size + lacing > VORBIS_MAX_PACKET) {
+            /* Too big for the buffer, drop it */
+            if (skip_bytes(s, lacing))
+                return 1;
+            size = VORBIS_MAX_PACKET + 1;
+        } else {
+            if (s->read(s->handle, s->packet + size, lacing) != (unsigned long)lacing)
+                return 1;
+            size += lacing;
+        }
+
+        if (lacing < 255) {
+            if (size > VORBIS_MAX_PACKET)
+                return -1;
+            if (s->segment_index == s->segment_count) {
+                s->granule = s->page_granule;
+                s->eos = s->page_eos;
+            }
+            *packet = s->packet;
+            *length = size;
+            return 0;
+        }
+    }
+}
@@ -0,0 +1,1200 @@
+/*
+Integer Ogg Vorbis decoder for openHiFi
+
+Copyright (C) 2011 teho Labs/B. A. Bryce
+
+Header parsing, codebooks, floor 1, residues 0/1/2, channel coupling and
+overlap-add. Floor 0 streams are rejected, no encoder has used it since 2000.
+
+Please see project readme for more details on licenses
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "vorbis.h"
+
+typedef struct VorbisBits {
+    const uint8_t *buffer;
+    unsigned long length;           /* bytes */
+    unsigned long position;         /* bits */
+} VorbisBits;
+
+/* 1.0649863^(i-255), the floor1 inverse dB table of the specification in Q31 */
+static const int32_t floor1_inverse_db[256] = {
+    229, 244, 259, 276, 294, 313, 334, 355,
+    378, 403, 429, 457, 487, 518, 552, 588,
+    626, 667, 710, 756, 806, 858, 914, 973,
+    1036, 1104, 1175, 1252, 1333, 1420, 1512, 1610,
+    1715, 1826, 1945, 2071, 2206, 2349, 2502, 2665,
+    2838, 3022, 3218, 3428, 3650, 3888, 4140, 4409,
+    4696, 5001, 5326, 5672, 6041, 6433, 6851, 7297,
+    7771, 8276, 8814, 9386, 9996, 10646, 11338, 12075,
+    12859, 13695, 14585, 15533, 16542, 17617, 18762, 19982,
+    21280, 22663, 24136, 25704, 27375, 29154, 31048, 33066,
+    35215, 37503, 39941, 42536, 45300, 48244, 51380, 54719,
+    58274, 62062, 66095, 70390, 74964, 79836, 85024, 90550,
+    96434, 102701, 109375, 116483, 124053, 132115, 140700, 149844,
+    159582, 169952, 180997, 192759, 205286, 218626, 232834, 247965,
+    264080, 281241, 299518, 318983, 339712, 361789, 385300, 410339,
+    437006, 465405, 495650, 527860, 562164, 598697, 637604, 679040,
+    723168, 770164, 820214, 873517, 930283, 990739, 1055124, 1123692,
+    1196717, 1274487, 1357311, 1445518, 1539457, 1639500, 1746045, 1859514,
+    1980357, 2109053, 2246113, 2392079, 2547532, 2713086, 2889400, 3077171,
+    3277145, 3490115, 3716925, 3958474, 4215720, 4489684, 4781452, 5092181,
+    5423103, 5775531, 6150861, 6550583, 6976281, 7429643, 7912468, 8426671,
+    8974289, 9557494, 10178601, 10840070, 11544526, 12294762, 13093754, 13944668,
+    14850880, 15815984, 16843807, 17938423, 19104175, 20345685, 21667875, 23075990,
+    24575614, 26172692, 27873558, 29684958, 31614073, 33668555, 35856550, 38186734,
+    40668349, 43311234, 46125871, 49123421, 52315770, 55715579, 59336328, 63192376,
+    67299015, 71672529, 76330262, 81290683, 86573464, 92199553, 98191260, 104572347,
+    111368117, 118605519, 126313253, 134521884, 143263963, 152574158, 162489388, 173048972,
+    184294785, 196271421, 209026374, 222610225, 237076840, 252483586, 268891560, 286365828,
+    304975684, 324794925, 345902145, 368381046, 392320767, 417816242, 444968574, 473885435,
+    504681496, 537478879, 572407643, 609606297, 649222355, 691412914, 736345281, 784197636,
+    835159739, 889433681, 947234685, 1008791962, 1074349619, 1144167626, 1218522846, 1297710137,
+    1382043518, 1471857412, 1567507980, 1669374524, 1777860997, 1893397605, 2016442510, 2147483647
+};
+
+static const int floor1_range[4] = {256, 128, 86, 64};
+
+/* Bit reader, Vorbis packs LSB first */
+
+static inline uint32_t bits_peek(const VorbisBits *b)
+{
+    unsigned long byte = b->position >> 3;
+    int shift = b->position & 7;
+    const uint8_t *p = b->buffer + byte;
+    uint32_t word;
+    uint64_t wide;
+    int i;
+
+    if (byte + 5 <= b->length) {
+        word = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+        if (shift)
+            word = (word >> shift) | ((uint32_t)p[4] << (32 - shift));
+        return word;
+    }
+
+    /* Near the end of the packet, missing bits read as zero */
+    wide = 0;
+    for (i = 0; i < 5 && byte + i < b->length; i++)
+        wide |= (uint64_t)p[i] << (8 * i);
+    return (uint32_t)(wide >> shift);
+}
+
+static inline uint32_t bits_read(VorbisBits *b, int count)
+{
+    uint32_t value;
+
+    if (count == 0)
+        return 0;
+    value = bits_peek(b);
+    b->position += count;
+    if (count < 32)
+        value &= (1u << count) - 1;
+    return value;
+}
+
+static inline int bits_overrun(const VorbisBits *b)
+{
+    return b->position > b->length * 8;
+}
+
+static int ilog(uint32_t x)
+{
+    int bits = 0;
+
+    while (x) {
+        bits++;
+        x >>= 1;
+    }
+    return bits;
+}
+
+static uint32_t bit_reverse(uint32_t x)
+{
+    x = ((x & 0xaaaaaaaa) >> 1) | ((x & 0x55555555) << 1);
+    x = ((x & 0xcccccccc) >> 2) | ((x & 0x33333333) << 2);
+    x = ((x & 0xf0f0f0f0) >> 4) | ((x & 0x0f0f0f0f) << 4);
+    x = ((x & 0xff00ff00) >> 8) | ((x & 0x00ff00ff) << 8);
+    return (x >> 16) | (x << 16);
+}
+
+static inline int32_t MULT31(int32_t x, int32_t y)
+{
+    return (int32_t)(((int64_t)x * y) >> 31);
+}
+
+/* Memory */
+
+static void *table_alloc(VorbisContext *v, unsigned long size)
+{
+    void *p;
+
+    size = (size + 3) & ~3;
+    if (v->table_used + size > v->table_size)
+        return NULL;
+    p = v->table_memory + v->table_used;
+    v->table_used += size;
+    return p;
+}
+
+/* Working vectors go to the fast memory while it lasts */
+static void *fast_alloc(VorbisContext *v, unsigned long size)
+{
+    void *p;
+
+    size = (size + 3) & ~3;
+    if (v->fast_used + size > v->fast_size)
+        return table_alloc(v, size);
+    p = v->fast_memory + v->fast_used;
+    v->fast_used += size;
+    return p;
+}
+
+/* Codebooks */
+
+static int compare_codes(const void *a, const void *b)
+{
+    uint32_t x = ((const VorbisCode *)a)->code;
+    uint32_t y = ((const VorbisCode *)b)->code;
+
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+/* Assigns the canonical Vorbis codewords (lowest available first) and builds
+   the lookup table and the sorted list of long codewords */
+static int build_codewords(VorbisContext *v, VorbisCodebook *c)
+{
+    uint32_t available[33];
+    uint32_t code;
+    int used = 0;
+    int first = -1;
+    int i, z, y, length;
+
+    for (i = 0; i < c->entries; i++) {
+        if (c->lengths[i]) {
+            if (first < 0)
+                first = i;
+            used++;
+            if (c->lengths[i] > VORBIS_FAST_BITS)
+                c->sorted_count++;
+        }
+    }
+
+    c->fast = table_alloc(v, sizeof(int32_t) << VORBIS_FAST_BITS);
+    if (c->fast == NULL)
+        return -1;
+    for (i = 0; i < (1 << VORBIS_FAST_BITS); i++)
+        c->fast[i] = -1;
+    if (used == 0)
+        return 0;
+
+    if (c->sorted_count) {
+        c->sorted = table_alloc(v, c->sorted_count * sizeof(VorbisCode));
+        if (c->sorted == NULL)
+            return -1;
+    }
+
+    /* A book with a single codeword decodes it whatever the bits are */
+    if (used == 1) {
+        c->sorted_count = 0;
+        for (i = 0; i < (1 << VORBIS_FAST_BITS); i++)
+            c->fast[i] = (first << 8) | c->lengths[first];
+        return 0;
+    }
+
+    memset(available, 0, sizeof(available));
+    c->sorted_count = 0;
+    for (i = first; i < c->entries; i++) {
+        length = c->lengths[i];
+        if (length == 0)
+            continue;
+
+        if (i == first) {
+            code = 0;
+            for (y = 1; y <= length; y++)
+                available[y] = 1u << (32 - y);
+        } else {
+            z = length;
+            while (z > 0 && !available[z])
+                z--;
+            if (z == 0)
+                return -1;      /* Overspecified */
+            code = available[z];
+            available[z] = 0;
+            for (y = length; y > z; y--)
+                available[y] = code + (1u << (32 - y));
+        }
+
+        if (length <= VORBIS_FAST_BITS) {
+            for (y = bit_reverse(code); y < (1 << VORBIS_FAST_BITS); y += 1 << length)
+                c->fast[y] = (i << 8) | length;
+        } else {
+            c->sorted[c->sorted_count].code = code;
+            c->sorted[c->sorted_count].entry = i;
+            c->sorted_count++;
+        }
+    }
+
+    if (c->sorted_count > 1)
+        qsort(c->sorted, c->sorted_count, sizeof(VorbisCode), compare_codes);
+    return 0;
+}
+
+static int decode_slow(VorbisBits *b, const VorbisCodebook *c, uint32_t bits)
+{
+    uint32_t x = bit_reverse(bits);
+    int low = 0;
+    int high = c->sorted_count;
+    int middle, length;
+    const VorbisCode *code;
+
+    if (high == 0)
+        return -1;
+
+    /* Last codeword not above the bits */
+    while (high - low > 1) {
+        middle = (low + high) >> 1;
+        if (c->sorted[middle].code <= x)
+            low = middle;
+        else
+            high = middle;
+    }
+
+    code = &c->sorted[low];
+    length = c->lengths[code->entry];
+    if (length < 32 ? ((x ^ code->code) >> (32 - length)) != 0 : x != code->code)
+        return -1;
+    b->position += length;
+    return code->entry;
+}
+
+static inline int decode_entry(VorbisBits *b, const VorbisCodebook *c)
+{
+    uint32_t bits = bits_peek(b);
+    int32_t fast = c->fast[bits & ((1 << VORBIS_FAST_BITS) - 1)];
+
+    if (fast >= 0) {
+        b->position += fast & 0xff;
+        return fast >> 8;
+    }
+    return decode_slow(b, c, bits);
+}
+
+/* Unpacks a float32 of the specification to value * 2^24 */
+static int64_t float32_unpack(uint32_t x)
+{
+    int64_t mantissa = x & 0x1fffff;
+    int exponent = (int)((x >> 21) & 0x3ff) - 788 + 24;
+
+    if (exponent >= 0)
+        mantissa = exponent > 31 ? ((int64_t)1 << 52) : mantissa << exponent;
+    else
+        mantissa = exponent < -52 ? 0 : mantissa >> -exponent;
+    return (x & 0x80000000) ? -mantissa : mantissa;
+}
+
+static int lookup1_values(int entries, int dimensions)
+{
+    int r = 1;
+    int64_t power;
+    int i;
+
+    for (;;) {
+        power = 1;
+        for (i = 0; i < dimensions && power <= entries; i++)
+            power *= r + 1;
+        if (power > entries)
+            return r;
+        r++;
+    }
+}
+
+static int read_codebook(VorbisContext *v, VorbisBits *b, VorbisCodebook *c)
+{
+    int i, j, current, number, length, sparse;
+    int lookup, value_bits, sequence, lookup_values, index, divisor;
+    int64_t minimum, delta, value, last;
+    uint16_t *multiplicands;
+    unsigned long mark;
+
+    memset(c, 0, sizeof(VorbisCodebook));
+    if (bits_read(b, 24) != 0x564342)
+        return -1;
+    c->dimensions = bits_read(b, 16);
+    c->entries = bits_read(b, 24);
+    if (c->dimensions == 0 && c->entries != 0)
+        return -1;
+
+    c->lengths = table_alloc(v, c->entries);
+    if (c->lengths == NULL)
+        return -1;
+
+    if (bits_read(b, 1)) {
+        /* Ordered */
+        current = 0;
+        length = bits_read(b, 5) + 1;
+        while (current < c->entries) {
+            number = bits_read(b, ilog(c->entries - current));
+            if (current + number > c->entries || length > 32)
+                return -1;
+            memset(c->lengths + current, length, number);
+            current += number;
+            length++;
+        }
+    } else {
+        sparse = bits_read(b, 1);
+        for (i = 0; i < c->entries; i++) {
+            if (sparse && !bits_read(b, 1))
+                c->lengths[i] = 0;
+            else
+                c->lengths[i] = bits_read(b, 5) + 1;
+        }
+    }
+    if (bits_overrun(b))
+        return -1;
+
+    lookup = bits_read(b, 4);
+    if (lookup > 2)
+        return -1;
+    if (lookup) {
+        minimum = float32_unpack(bits_read(b, 32));
+        delta = float32_unpack(bits_read(b, 32));
+        value_bits = bits_read(b, 4) + 1;
+        sequence = bits_read(b, 1);
+        if (lookup == 1)
+            lookup_values = lookup1_values(c->entries, c->dimensions);
+        else
+            lookup_values = c->entries * c->dimensions;
+
+        c->values = table_alloc(v, c->entries * c->dimensions * sizeof(int32_t));
+        if (c->values == NULL)
+            return -1;
+
+        /* The multiplicands are only needed until the values are built */
+        mark = v->table_used;
+        multiplicands = table_alloc(v, lookup_values * sizeof(uint16_t));
+        if (multiplicands == NULL)
+            return -1;
+        for (i = 0; i < lookup_values; i++)
+            multiplicands[i] = bits_read(b, value_bits);
+        if (bits_overrun(b))
+            return -1;
+
+        for (i = 0; i < c->entries; i++) {
+            last = 0;
+            divisor = 1;
+            for (j = 0; j < c->dimensions; j++) {
+                if (lookup == 1) {
+                    index = (i / divisor) % lookup_values;
+                    divisor *= lookup_values;
+                } else {
+                    index = i * c->dimensions + j;
+                }
+                value = multiplicands[index] * delta + minimum + last;
+                if (sequence)
+                    last = value;
+                c->values[i * c->dimensions + j] = (int32_t)((value + (1 << (23 - VORBIS_RESIDUE_SHIFT)))
+                                                             >> (24 - VORBIS_RESIDUE_SHIFT));
+            }
+        }
+        v->table_used = mark;
+    }
+
+    return build_codewords(v, c);
+}
+
+/* Floor 1 */
+
+static int read_floor(VorbisContext *v, VorbisBits *b, VorbisFloor *f)
+{
+    int i, j, k, classes = 0, range_bits, count;
+
+    memset(f, 0, sizeof(VorbisFloor));
+    f->partitions = bits_read(b, 5);
+    for (i = 0; i < f->partitions; i++) {
+        f->partition_class[i] = bits_read(b, 4);
+        if (f->partition_class[i] + 1 > classes)
+            classes = f->partition_class[i] + 1;
+    }
+    for (i = 0; i < classes; i++) {
+        f->class_dimensions[i] = bits_read(b, 3) + 1;
+        f->class_subclasses[i] = bits_read(b, 2);
+        if (f->class_subclasses[i]) {
+            f->class_masterbook[i] = bits_read(b, 8);
+            if (f->class_masterbook[i] >= v->codebook_count)
+                return -1;
+        }
+        for (j = 0; j < (1 << f->class_subclasses[i]); j++) {
+            f->subclass_books[i][j] = (int)bits_read(b, 8) - 1;
+            if (f->subclass_books[i][j] >= v->codebook_count)
+                return -1;
+        }
+    }
+
+    f->multiplier = bits_read(b, 2) + 1;
+    range_bits = bits_read(b, 4);
+    f->x_list[0] = 0;
+    f->x_list[1] = 1 << range_bits;
+    count = 2;
+    for (i = 0; i < f->partitions; i++) {
+        k = f->partition_class[i];
+        for (j = 0; j < f->class_dimensions[k]; j++) {
+            if (count >= 65)
+                return -1;
+            f->x_list[count++] = bits_read(b, range_bits);
+        }
+    }
+    f->values = count;
+
+    /* Order of the points along x */
+    for (i = 0; i < count; i++)
+        f->sorted[i] = i;
+    for (i = 1; i < count; i++) {
+        k = f->sorted[i];
+        for (j = i; j > 0 && f->x_list[f->sorted[j - 1]] > f->x_list[k]; j--)
+            f->sorted[j] = f->sorted[j - 1];
+        f->sorted[j] = k;
+    }
+
+    /* Closest earlier points below and above each x */
+    for (i = 2; i < count; i++) {
+        int low = 0, high = 1;
+        for (j = 0; j < i; j++) {
+            if (f->x_list[j] < f->x_list[i] && f->x_list[j] > f->x_list[low])
+                low = j;
+            if (f->x_list[j] > f->x_list[i] && f->x_list[j] < f->x_list[high])
+                high = j;
+        }
+        f->low_neighbour[i] = low;
+        f->high_neighbour[i] = high;
+    }
+
+    return bits_overrun(b) ? -1 : 0;
+}
+
+/* Reads the floor Y values of a channel, returns 0 for an unused floor */
+static int ICODE_ATTR_VORBIS decode_floor(VorbisContext *v, VorbisBits *b, const VorbisFloor *f, int16_t *y)
+{
+    int range = floor1_range[f->multiplier - 1];
+    int i, j, offset, cls, cdim, cbits, csub, cval, book;
+
+    if (!bits_read(b, 1))
+        return 0;
+
+    y[0] = bits_read(b, ilog(range - 1));
+    y[1] = bits_read(b, ilog(range - 1));
+    offset = 2;
+    for (i = 0; i < f->partitions; i++) {
+        cls = f->partition_class[i];
+        cdim = f->class_dimensions[cls];
+        cbits = f->class_subclasses[cls];
+        csub = (1 << cbits) - 1;
+        cval = 0;
+        if (cbits) {
+            cval = decode_entry(b, &v->codebooks[f->class_masterbook[cls]]);
+            if (cval < 0)
+                return 0;
+        }
+        for (j = 0; j < cdim; j++) {
+            book = f->subclass_books[cls][cval & csub];
+            cval >>= cbits;
+            if (book >= 0) {
+                y[offset + j] = decode_entry(b, &v->codebooks[book]);
+                if (y[offset + j] < 0)
+                    return 0;
+            } else {
+                y[offset + j] = 0;
+            }
+        }
+        offset += cdim;
+    }
+
+    return bits_overrun(b) ? 0 : 1;
+}
+
+static inline int render_point(int x0, int y0, int x1, int y1, int x)
+{
+    int dy = y1 - y0;
+    int adx = x1 - x0;
+    int offset = (dy < 0 ? -dy : dy) * (x - x0) / adx;
+
+    return dy < 0 ? y0 - offset : y0 + offset;
+}
+
+/* Residue (VORBIS_RESIDUE_SHIFT) times floor (Q31) to spectrum (VORBIS_SPECTRUM_SHIFT) */
+static inline int32_t floor_multiply(int32_t residue, int32_t floor)
+{
+    return (int32_t)(((int64_t)residue * floor) >> (31 + VORBIS_RESIDUE_SHIFT - VORBIS_SPECTRUM_SHIFT));
+}
+
+/* Multiplies the spectrum by the floor line from x0 up to (not including) x1 */
+static inline void render_line(int x0, int y0, int x1, int y1, int32_t *spectrum, int n)
+{
+    int dy = y1 - y0;
+    int adx = x1 - x0;
+    int ady = dy < 0 ? -dy : dy;
+    int base = dy / adx;
+    int sy = dy < 0 ? base - 1 : base + 1;
+    int x = x0;
+    int y = y0;
+    int error = 0;
+
+    if (x1 > n)
+        x1 = n;
+    if (x >= x1)
+        return;
+
+    ady -= (base < 0 ? -base : base) * adx;
+    spectrum[x] = floor_multiply(spectrum[x], floor1_inverse_db[y & 0xff]);
+    for (x++; x < x1; x++) {
+        error += ady;
+        if (error >= adx) {
+            error -= adx;
+            y += sy;
+        } else {
+            y += base;
+        }
+        spectrum[x] = floor_multiply(spectrum[x], floor1_inverse_db[y & 0xff]);
+    }
+}
+
+/* Builds the floor curve from the Y values and applies it to the residue */
+static void ICODE_ATTR_VORBIS apply_floor(const VorbisFloor *f, const int16_t *y, int32_t *spectrum, int n)
+{
+    int range = floor1_range[f->multiplier - 1];
+    int16_t final_y[65];
+    uint8_t step2[65];
+    int i, low, high, predicted, value, high_room, low_room, room;
+    int lx, ly, hx, hy;
+
+    step2[0] = step2[1] = 1;
+    final_y[0] = y[0];
+    final_y[1] = y[1];
+    for (i = 2; i < f->values; i++) {
+        low = f->low_neighbour[i];
+        high = f->high_neighbour[i];
+        predicted = render_point(f->x_list[low], final_y[low], f->x_list[high], final_y[high], f->x_list[i]);
+        value = y[i];
+        high_room = range - predicted;
+        low_room = predicted;
+        room = (high_room < low_room ? high_room : low_room) * 2;
+        if (value) {
+            step2[low] = step2[high] = step2[i] = 1;
+            if (value >= room) {
+                if (high_room > low_room)
+                    final_y[i] = value - low_room + predicted;
+                else
+                    final_y[i] = predicted - value + high_room - 1;
+            } else if (value & 1) {
+                final_y[i] = predicted - ((value + 1) >> 1);
+            } else {
+                final_y[i] = predicted + (value >> 1);
+            }
+        } else {
+            step2[i] = 0;
+            final_y[i] = predicted;
+        }
+    }
+
+    lx = 0;
+    ly = final_y[0] * f->multiplier;
+    hx = 0;
+    hy = ly;
+    for (i = 1; i < f->values; i++) {
+        low = f->sorted[i];
+        if (step2[low]) {
+            hx = f->x_list[low];
+            hy = final_y[low] * f->multiplier;
+            if (hx > lx)
+                render_line(lx, ly, hx, hy, spectrum, n);
+            lx = hx;
+            ly = hy;
+        }
+    }
+    if (hx < n)
+        render_line(hx, hy, n, hy, spectrum, n);
+}
+
+/* Residues */
+
+static int read_residue(VorbisContext *v, VorbisBits *b, VorbisResidue *r)
+{
+    uint8_t cascade[64];
+    int i, j;
+
+    memset(r, 0, sizeof(VorbisResidue));
+    r->type = bits_read(b, 16);
+    if (r->type > 2)
+        return -1;
+    r->begin = bits_read(b, 24);
+    r->end = bits_read(b, 24);
+    r->partition_size = bits_read(b, 24) + 1;
+    r->classifications = bits_read(b, 6) + 1;
+    r->classbook = bits_read(b, 8);
+    if (r->classbook >= v->codebook_count || v->codebooks[r->classbook].dimensions == 0)
+        return -1;
+
+    for (i = 0; i < r->classifications; i++) {
+        cascade[i] = bits_read(b, 3);
+        if (bits_read(b, 1))
+            cascade[i] |= bits_read(b, 5) << 3;
+    }
+    for (i = 0; i < r->classifications; i++) {
+        for (j = 0; j < 8; j++) {
+            r->books[i][j] = -1;
+            if (cascade[i] & (1 << j)) {
+                r->books[i][j] = bits_read(b, 8);
+                if (r->books[i][j] >= v->codebook_count || v->codebooks[r->books[i][j]].values == NULL)
+                    return -1;
+            }
+        }
+    }
+
+    return bits_overrun(b) ? -1 : 0;
+}
+
+/* Decodes one partition of a residue vector, returns -1 at the end of the packet */
+static int ICODE_ATTR_VORBIS decode_partition(VorbisBits *b, const VorbisCodebook *c, int type,
+                                              int32_t **vectors, int channels,
+                                              unsigned long offset, unsigned long size)
+{
+    int dimensions = c->dimensions;
+    unsigned long step, i, t;
+    const int32_t *values;
+    int32_t *vector = vectors[0];
+    int entry, j;
+
+    if (type == 0) {
+        step = size / dimensions;
+        for (i = 0; i < step; i++) {
+            entry = decode_entry(b, c);
+            if (entry < 0 || bits_overrun(b))
+                return -1;
+            values = c->values + entry * dimensions;
+            for (j = 0; j < dimensions; j++)
+                vector[offset + i + j * step] += values[j];
+        }
+    } else if (type == 1 || channels == 1) {
+        for (i = 0; i < size; ) {
+            entry = decode_entry(b, c);
+            if (entry < 0 || bits_overrun(b))
+                return -1;
+            values = c->values + entry * dimensions;
+            for (j = 0; j < dimensions && i < size; j++)
+                vector[offset + i++] += values[j];
+        }
+    } else {
+        /* Type 2: the channels are interleaved in one vector */
+        for (i = 0; i < size; ) {
+            entry = decode_entry(b, c);
+            if (entry < 0 || bits_overrun(b))
+                return -1;
+            values = c->values + entry * dimensions;
+            for (j = 0; j < dimensions && i < size; j++, i++) {
+                t = offset + i;
+                vectors[t % channels][t / channels] += values[j];
+            }
+        }
+    }
+    return 0;
+}
+
+static void ICODE_ATTR_VORBIS decode_residue(VorbisContext *v, VorbisBits *b, const VorbisResidue *r,
+                                             int32_t **vectors, const uint8_t *skip, int channels, int n)
+{
+    const VorbisCodebook *classbook = &v->codebooks[r->classbook];
+    int classwords = classbook->dimensions;
+    unsigned long size = n;
+    unsigned long begin, end, partitions, partition;
+    int vector_count = channels;
+    int pass, i, j, temp, book;
+
+    if (r->type == 2) {
+        for (j = 0; j < channels && skip[j]; j++)
+            ;
+        if (j == channels)
+            return;
+        size *= channels;
+        vector_count = 1;
+    }
+
+    begin = r->begin < size ? r->begin : size;
+    end = r->end < size ? r->end : size;
+    if (end <= begin)
+        return;
+    partitions = (end - begin) / r->partition_size;
+
+    for (pass = 0; pass < 8; pass++) {
+        partition = 0;
+        while (partition < partitions) {
+            if (pass == 0) {
+                for (j = 0; j < vector_count; j++) {
+                    if (r->type != 2 && skip[j])
+                        continue;
+                    temp = decode_entry(b, classbook);
+                    if (temp < 0 || bits_overrun(b))
+                        return;
+                    for (i = classwords - 1; i >= 0; i--) {
+                        v->classifications[j][partition + i] = temp % r->classifications;
+                        temp /= r->classifications;
+                    }
+                }
+            }
+            for (i = 0; i < classwords && partition < partitions; i++, partition++) {
+                for (j = 0; j < vector_count; j++) {
+                    if (r->type != 2 && skip[j])
+                        continue;
+                    book = r->books[v->classifications[j][partition]][pass];
+                    if (book < 0)
+                        continue;
+                    if (r->type == 2) {
+                        if (decode_partition(b, &v->codebooks[book], 2, vectors, channels,
+                                             begin + partition * r->partition_size, r->partition_size))
+                            return;
+                    } else {
+                        if (decode_partition(b, &v->codebooks[book], r->type, &vectors[j], 1,
+                                             begin + partition * r->partition_size, r->partition_size))
+                            return;
+                    }
+                }
+            }
+        }
+    }
+}
+
+/* Mappings */
+
+static int read_mapping(VorbisContext *v, VorbisBits *b, VorbisMapping *m)
+{
+    int i, bits = ilog(v->channels - 1);
+
+    memset(m, 0, sizeof(VorbisMapping));
+    if (bits_read(b, 16) != 0)
+        return -1;
+
+    m->submaps = bits_read(b, 1) ? bits_read(b, 4) + 1 : 1;
+    if (bits_read(b, 1)) {
+        m->coupling_steps = bits_read(b, 8) + 1;
+        for (i = 0; i < m->coupling_steps; i++) {
+            m->magnitude[i] = bits_read(b, bits);
+            m->angle[i] = bits_read(b, bits);
+            if (m->magnitude[i] == m->angle[i] || m->magnitude[i] >= v->channels || m->angle[i] >= v->channels)
+                return -1;
+        }
+    }
+    if (bits_read(b, 2) != 0)
+        return -1;
+
+    if (m->submaps > 1) {
+        for (i = 0; i < v->channels; i++) {
+            m->mux[i] = bits_read(b, 4);
+            if (m->mux[i] >= m->submaps)
+                return -1;
+        }
+    }
+    for (i = 0; i < m->submaps; i++) {
+        bits_read(b, 8);
+        m->submap_floor[i] = bits_read(b, 8);
+        m->submap_residue[i] = bits_read(b, 8);
+        if (m->submap_floor[i] >= v->floor_count || m->submap_residue[i] >= v->residue_count)
+            return -1;
+    }
+
+    return bits_overrun(b) ? -1 : 0;
+}
+
+/* Headers */
+
+static int read_setup(VorbisContext *v, VorbisBits *b)
+{
+    int i, count, classwords;
+    unsigned long size, partitions;
+
+    v->codebook_count = bits_read(b, 8) + 1;
+    v->codebooks = table_alloc(v, v->codebook_count * sizeof(VorbisCodebook));
+    if (v->codebooks == NULL)
+        return -1;
+    for (i = 0; i < v->codebook_count; i++) {
+        if (read_codebook(v, b, &v->codebooks[i]))
+            return -1;
+    }
+
+    /* Time domain transforms are placeholders */
+    count = bits_read(b, 6) + 1;
+    for (i = 0; i < count; i++) {
+        if (bits_read(b, 16) != 0)
+            return -1;
+    }
+
+    v->floor_count = bits_read(b, 6) + 1;
+    v->floors = table_alloc(v, v->floor_count * sizeof(VorbisFloor));
+    if (v->floors == NULL)
+        return -1;
+    for (i = 0; i < v->floor_count; i++) {
+        if (bits_read(b, 16) != 1)
+            return -1;      /* Floor 0 is not supported */
+        if (read_floor(v, b, &v->floors[i]))
+            return -1;
+    }
+
+    v->residue_count = bits_read(b, 6) + 1;
+    v->residues = table_alloc(v, v->residue_count * sizeof(VorbisResidue));
+    if (v->residues == NULL)
+        return -1;
+    v->classification_size = 0;
+    for (i = 0; i < v->residue_count; i++) {
+        if (read_residue(v, b, &v->residues[i]))
+            return -1;
+
+        /* Room for the classifications of the longest block */
+        size = v->blocksize[1] / 2;
+        if (v->residues[i].type == 2)
+            size *= v->channels;
+        if (v->residues[i].end < size)
+            size = v->residues[i].end;
+        classwords = v->codebooks[v->residues[i].classbook].dimensions;
+        partitions = size / v->residues[i].partition_size + classwords;
+        if (partitions > (unsigned long)v->classification_size)
+            v->classification_size = partitions;
+    }
+
+    v->mapping_count = bits_read(b, 6) + 1;
+    v->mappings = table_alloc(v, v->mapping_count * sizeof(VorbisMapping));
+    if (v->mappings == NULL)
+        return -1;
+    for (i = 0; i < v->mapping_count; i++) {
+        if (read_mapping(v, b, &v->mappings[i]))
+            return -1;
+    }
+
+    v->mode_count = bits_read(b, 6) + 1;
+    for (i = 0; i < v->mode_count; i++) {
+        v->modes[i].blockflag = bits_read(b, 1);
+        if (bits_read(b, 16) != 0 || bits_read(b, 16) != 0)
+            return -1;
+        v->modes[i].mapping = bits_read(b, 8);
+        if (v->modes[i].mapping >= v->mapping_count)
+            return -1;
+    }
+    v->mode_bits = ilog(v->mode_count - 1);
+
+    if (!bits_read(b, 1) || bits_overrun(b))
+        return -1;
+
+    /* Working vectors */
+    for (i = 0; i < v->channels; i++) {
+        v->pcm[i] = fast_alloc(v, v->blocksize[1] * sizeof(int32_t));
+        v->overlap[i] = fast_alloc(v, v->blocksize[1] / 2 * sizeof(int32_t));
+        v->classifications[i] = fast_alloc(v, v->classification_size);
+        if (v->pcm[i] == NULL || v->overlap[i] == NULL || v->classifications[i] == NULL)
+            return -1;
+    }
+
+    return 0;
+}
+
+static int read_identification(VorbisContext *v, VorbisBits *b)
+{
+    int blocksizes, i;
+    int32_t *memory;
+
+    if (bits_read(b, 32) != 0)
+        return -1;
+    v->channels = bits_read(b, 8);
+    v->samplerate = bits_read(b, 32);
+    bits_read(b, 32);
+    bits_read(b, 32);
+    bits_read(b, 32);
+    blocksizes = bits_read(b, 8);
+    v->blocksize[0] = 1 << (blocksizes & 0x0f);
+    v->blocksize[1] = 1 << (blocksizes >> 4);
+
+    if (v->channels == 0 || v->channels > VORBIS_MAX_CHANNELS || v->samplerate == 0)
+        return -1;
+    if (v->blocksize[0] < 64 || v->blocksize[1] > VORBIS_MAX_BLOCKSIZE || v->blocksize[0] > v->blocksize[1])
+        return -1;
+    if (!bits_read(b, 1) || bits_overrun(b))
+        return -1;
+
+    /* Building the tables takes a while, keep them if the blocksizes did not change */
+    if (v->tables[0].n != v->blocksize[0] || v->tables[1].n != v->blocksize[1]) {
+        v->table_used = 0;
+        v->tables[0].n = v->tables[1].n = 0;
+        for (i = 0; i < 2; i++) {
+            memory = table_alloc(v, VORBIS_TABLE_SIZE(v->blocksize[i]) * sizeof(int32_t));
+            if (memory == NULL)
+                return -1;
+            vorbis_tables_init(&v->tables[i], v->blocksize[i], memory);
+        }
+        v->table_mark = v->table_used;
+    }
+    v->table_used = v->table_mark;
+    v->fast_used = 0;
+
+    return 0;
+}
+
+int vorbis_init(VorbisContext *v, void *fast_memory, unsigned long fast_size,
+                void *table_memory, unsigned long table_size)
+{
+    if (v->table_memory != table_memory || v->table_size != table_size) {
+        v->tables[0].n = v->tables[1].n = 0;
+        v->table_mark = 0;
+    }
+
+    v->fast_memory = fast_memory;
+    v->fast_size = fast_size;
+    v->fast_used = 0;
+    v->table_memory = table_memory;
+    v->table_size = table_size;
+    v->table_used = v->table_mark;
+
+    v->headers = 0;
+    v->previous_n = 0;
+    v->current_n = 0;
+    v->output_frames = 0;
+    v->output_index = 0;
+    v->save_overlap = 0;
+    return 0;
+}
+
+/* Returns the header type (1, 3 or 5) or -1 */
+int vorbis_decode_header(VorbisContext *v, const uint8_t *packet, unsigned long length)
+{
+    VorbisBits b;
+    int type;
+
+    if (length < 7 || memcmp(packet + 1, "vorbis", 6) != 0)
+        return -1;
+
+    b.buffer = packet + 7;
+    b.length = length - 7;
+    b.position = 0;
+
+    type = packet[0];
+    switch (type) {
+        case 1:
+            if (read_identification(v, &b))
+                return -1;
+            v->headers = 1;
+            break;
+        case 3:
+            if (!(v->headers & 1))
+                return -1;
+            v->headers |= 2;
+            break;
+        case 5:
+            /* The comment header is not needed for decoding */
+            if (!(v->headers & 1) || read_setup(v, &b))
+                return -1;
+            v->headers |= 4;
+            break;
+        default:
+            return -1;
+    }
+    return type;
+}
+
+/* Audio packets */
+
+static void ICODE_ATTR_VORBIS apply_window(VorbisContext *v, int32_t *pcm, int n, int blockflag,
+                                           int previous_flag, int next_flag)
+{
+    int short_n = v->blocksize[0];
+    int left_start, left_n, right_start, right_n;
+    const int32_t *left_slope, *right_slope;
+    int i;
+
+    if (blockflag && !previous_flag) {
+        left_start = n / 4 - short_n / 4;
+        left_n = short_n / 2;
+        left_slope = v->tables[0].window;
+    } else {
+        left_start = 0;
+        left_n = n / 2;
+        left_slope = v->tables[blockflag].window;
+    }
+    if (blockflag && !next_flag) {
+        right_start = n * 3 / 4 - short_n / 4;
+        right_n = short_n / 2;
+        right_slope = v->tables[0].window;
+    } else {
+        right_start = n / 2;
+        right_n = n / 2;
+        right_slope = v->tables[blockflag].window;
+    }
+
+    for (i = 0; i < left_start; i++)
+        pcm[i] = 0;
+    for (i = 0; i < left_n; i++)
+        pcm[left_start + i] = MULT31(pcm[left_start + i], left_slope[i]);
+    for (i = 0; i < right_n; i++)
+        pcm[right_start + i] = MULT31(pcm[right_start + i], right_slope[right_n - 1 - i]);
+    for (i = right_start + right_n; i < n; i++)
+        pcm[i] = 0;
+}
+
+int ICODE_ATTR_VORBIS vorbis_decode_packet(VorbisContext *v, const uint8_t *packet, unsigned long length)
+{
+    VorbisBits b;
+    const VorbisMode *mode;
+    const VorbisMapping *mapping;
+    int16_t floor_y[VORBIS_MAX_CHANNELS][65];
+    uint8_t no_residue[VORBIS_MAX_CHANNELS];
+    uint8_t skip[VORBIS_MAX_CHANNELS];
+    int32_t *vectors[VORBIS_MAX_CHANNELS];
+    int32_t *magnitude, *angle;
+    int32_t m, a;
+    int n, half, blockflag, previous_flag = 0, next_flag = 0;
+    int i, j, ch, count;
+
+    if (!(v->headers & 4))
+        return -1;
+
+    /* The right half of the last block is needed for the next overlap */
+    if (v->save_overlap) {
+        half = v->current_n / 2;
+        for (ch = 0; ch < v->channels; ch++)
+            memcpy(v->overlap[ch], v->pcm[ch] + half, half * sizeof(int32_t));
+        v->previous_n = v->current_n;
+        v->save_overlap = 0;
+    }
+    v->output_frames = 0;
+    v->output_index = 0;
+
+    b.buffer = packet;
+    b.length = length;
+    b.position = 0;
+
+    if (bits_read(&b, 1) != 0)
+        return -1;
+    i = bits_read(&b, v->mode_bits);
+    if (i >= v->mode_count || bits_overrun(&b))
+        return -1;
+    mode = &v->modes[i];
+    mapping = &v->mappings[mode->mapping];
+    blockflag = mode->blockflag;
+    n = v->blocksize[blockflag];
+    half = n / 2;
+    if (blockflag) {
+        previous_flag = bits_read(&b, 1);
+        next_flag = bits_read(&b, 1);
+    }
+
+    for (ch = 0; ch < v->channels; ch++) {
+        no_residue[ch] = !decode_floor(v, &b, &v->floors[mapping->submap_floor[mapping->mux[ch]]], floor_y[ch]);
+        memset(v->pcm[ch], 0, half * sizeof(int32_t));
+    }
+
+    /* Coupled channels are decoded if either of them is used */
+    for (ch = 0; ch < v->channels; ch++)
+        skip[ch] = no_residue[ch];
+    for (i = 0; i < mapping->coupling_steps; i++) {
+        if (!no_residue[mapping->magnitude[i]] || !no_residue[mapping->angle[i]])
+            skip[mapping->magnitude[i]] = skip[mapping->angle[i]] = 0;
+    }
+
+    for (i = 0; i < mapping->submaps; i++) {
+        uint8_t submap_skip[VORBIS_MAX_CHANNELS];
+        count = 0;
+        for (ch = 0; ch < v->channels; ch++) {
+            if (mapping->mux[ch] == i) {
+                submap_skip[count] = skip[ch];
+                vectors[count++] = v->pcm[ch];
+            }
+        }
+        decode_residue(v, &b, &v->residues[mapping->submap_residue[i]], vectors, submap_skip, count, half);
+    }
+
+    for (i = mapping->coupling_steps - 1; i >= 0; i--) {
+        magnitude = v->pcm[mapping->magnitude[i]];
+        angle = v->pcm[mapping->angle[i]];
+        for (j = 0; j < half; j++) {
+            m = magnitude[j];
+            a = angle[j];
+            if (m > 0) {
+                if (a > 0) {
+                    angle[j] = m - a;
+                } else {
+                    angle[j] = m;
+                    magnitude[j] = m + a;
+                }
+            } else {
+                if (a > 0) {
+                    angle[j] = m + a;
+                } else {
+                    angle[j] = m;
+                    magnitude[j] = m - a;
+                }
+            }
+        }
+    }
+
+    for (ch = 0; ch < v->channels; ch++) {
+        if (no_residue[ch])
+            memset(v->pcm[ch], 0, n * sizeof(int32_t));
+        else {
+            apply_floor(&v->floors[mapping->submap_floor[mapping->mux[ch]]], floor_y[ch], v->pcm[ch], half);
+            vorbis_imdct(&v->tables[blockflag], v->pcm[ch]);
+            apply_window(v, v->pcm[ch], n, blockflag, previous_flag, next_flag);
+        }
+    }
+
+    /* Samples between the centres of the previous and this block are ready */
+    v->current_n = n;
+    v->save_overlap = 1;
+    v->output_frames = v->previous_n ? v->previous_n / 4 + n / 4 : 0;
+    return v->output_frames;
+}
+
+/* Limits the frames of the last packet, for the end of the stream */
+void vorbis_limit_pcm(VorbisContext *v, int frames)
+{
+    if (frames < 0)
+        frames = 0;
+    if (frames < v->output_frames)
+        v->output_frames = frames;
+}
+
+static inline uint16_t to_sample(int32_t x)
+{
+    x = (x + (1 << (VORBIS_SPECTRUM_SHIFT - 16))) >> (VORBIS_SPECTRUM_SHIFT - 15);
+    if (x > 32767)
+        x = 32767;
+    else if (x < -32768)
+        x = -32768;
+    return (uint16_t)x;
+}
+
+/* Overlap-adds up to frames of the last packet into 16-bit stereo pairs,
+   returns the number written, 0 when the packet is used up */
+int ICODE_ATTR_VORBIS vorbis_read_pcm(VorbisContext *v, uint16_t *destination, int frames)
+{
+    int half = v->previous_n / 2;
+    int offset = v->previous_n / 4 - v->current_n / 4;
+    int count = v->output_frames - v->output_index;
+    int i, p, ch;
+    int32_t sample;
+
+    if (frames > count)
+        frames = count;
+
+    for (i = 0; i < frames; i++) {
+        p = v->output_index + i;
+        for (ch = 0; ch < v->channels; ch++) {
+            sample = 0;
+            if (p < half)
+                sample = v->overlap[ch][p];
+            if (p >= offset)
+                sample += v->pcm[ch][p - offset];
+            destination[2 * i + ch] = to_sample(sample);
+        }
+        if (v->channels == 1)
+            destination[2 * i + 1] = destination[2 * i];
+    }
+
+    v->output_index += frames;
+    return frames;
+}
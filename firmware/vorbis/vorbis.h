@@ -0,0 +1,178 @@
+/*
+Integer Ogg Vorbis decoder for openHiFi
+
+Copyright (C) 2011 teho Labs/B. A. Bryce
+
+Written from the Vorbis I specification (http://xiph.org/vorbis/doc/Vorbis_I_spec.html)
+in the style of the Tremor fixed-point decoder. Floor type 0 is not supported.
+
+Please see project readme for more details on licenses
+*/
+
+#ifndef _VORBIS_DECODER_H
+#define _VORBIS_DECODER_H
+
+#include <inttypes.h>
+
+#define VORBIS_MAX_CHANNELS 2		/* Maximum supported channels */
+#define VORBIS_MAX_BLOCKSIZE 8192	/* Largest blocksize allowed by the specification */
+#define VORBIS_MAX_PACKET 65536		/* Maxsize in bytes of one packet (headers included) */
+
+#define VORBIS_FAST_BITS 10		/* Codewords up to this length are decoded with one table lookup */
+#define VORBIS_RESIDUE_SHIFT 12		/* Fraction bits of decoded residue values */
+#define VORBIS_SPECTRUM_SHIFT 20	/* Fraction bits of spectrum and PCM values (1.0 = full scale) */
+
+/* The hot loops (residue decode, floor synthesis, IMDCT) can be placed in SRAM */
+/* by building with -DVORBIS_ICODE_SRAM, they are then copied there with .data (see link.ld) */
+#ifdef VORBIS_ICODE_SRAM
+#define ICODE_ATTR_VORBIS __attribute__((section(".icode"), long_call, noinline))
+#else
+#define ICODE_ATTR_VORBIS
+#endif
+
+/* Reads length bytes of the stream into buffer, returns the number read (0 at the end) */
+typedef unsigned long (*ogg_read_function)(void *handle, void *buffer, unsigned long length);
+
+typedef struct OggStream {
+    ogg_read_function read;
+    void *handle;
+
+    uint8_t *packet;                /* Packet buffer (VORBIS_MAX_PACKET bytes) */
+
+    uint8_t segments[255];          /* Lacing values of the current page */
+    int segment_count;
+    int segment_index;
+
+    uint32_t serial;
+    int have_serial;
+    int64_t page_granule;
+    int page_eos;
+
+    int64_t granule;                /* Granule position if the last packet ended its page, else -1 */
+    int eos;                        /* The last packet ended the logical stream */
+} OggStream;
+
+typedef struct VorbisCode {
+    uint32_t code;                  /* Codeword MSB first and left aligned */
+    uint32_t entry;
+} VorbisCode;
+
+typedef struct VorbisCodebook {
+    int dimensions;
+    int entries;
+    uint8_t *lengths;               /* Codeword length of each entry, 0 = unused */
+    int32_t *fast;                  /* Entry << 8 | length for the next VORBIS_FAST_BITS bits, -1 = longer */
+    VorbisCode *sorted;             /* Codewords longer than VORBIS_FAST_BITS, ascending */
+    int sorted_count;
+    int32_t *values;                /* entries * dimensions VQ values (VORBIS_RESIDUE_SHIFT), NULL = scalar book */
+} VorbisCodebook;
+
+typedef struct VorbisFloor {
+    int partitions;
+    uint8_t partition_class[31];
+    uint8_t class_dimensions[16];
+    uint8_t class_subclasses[16];
+    uint8_t class_masterbook[16];
+    int16_t subclass_books[16][8];
+    int multiplier;
+    int values;
+    uint16_t x_list[65];
+    uint8_t sorted[65];             /* x_list indexes in ascending x order */
+    uint8_t low_neighbour[65];
+    uint8_t high_neighbour[65];
+} VorbisFloor;
+
+typedef struct VorbisResidue {
+    int type;
+    unsigned long begin, end;
+    unsigned long partition_size;
+    int classifications;
+    int classbook;
+    int16_t books[64][8];
+} VorbisResidue;
+
+typedef struct VorbisMapping {
+    int submaps;
+    int coupling_steps;
+    uint8_t magnitude[256];
+    uint8_t angle[256];
+    uint8_t mux[VORBIS_MAX_CHANNELS];
+    uint8_t submap_floor[16];
+    uint8_t submap_residue[16];
+} VorbisMapping;
+
+typedef struct VorbisMode {
+    int blockflag;
+    int mapping;
+} VorbisMode;
+
+/* IMDCT and window tables for one blocksize (Q31), VORBIS_TABLE_SIZE ints */
+#define VORBIS_TABLE_SIZE(n) ((n) / 2 + (n) / 4 + (n) / 2 + (n) / 2)
+
+typedef struct VorbisTables {
+    int n;
+    int32_t *pre;                   /* n/4 pre-twiddles (cos, sin) */
+    int32_t *fft;                   /* n/8 FFT twiddles (cos, sin) */
+    int32_t *post;                  /* n/4 post-twiddles (cos, sin) */
+    int32_t *window;                /* n/2 rising window slope */
+} VorbisTables;
+
+typedef struct VorbisContext {
+    /* Identification header */
+    int channels;
+    unsigned long samplerate;
+    int blocksize[2];
+
+    /* Setup header */
+    int codebook_count;
+    VorbisCodebook *codebooks;
+    int floor_count;
+    VorbisFloor *floors;
+    int residue_count;
+    VorbisResidue *residues;
+    int mapping_count;
+    VorbisMapping *mappings;
+    int mode_count;
+    int mode_bits;
+    VorbisMode modes[64];
+    int headers;                    /* Bit 0, 1, 2 set when header 1, 3, 5 was read */
+
+    /* Tables, kept between streams with the same blocksizes */
+    VorbisTables tables[2];
+
+    /* Decode state */
+    int32_t *pcm[VORBIS_MAX_CHANNELS];      /* blocksize[1] spectrum, then windowed IMDCT output */
+    int32_t *overlap[VORBIS_MAX_CHANNELS];  /* Windowed right half of the previous block */
+    uint8_t *classifications[VORBIS_MAX_CHANNELS];
+    int classification_size;
+    int previous_n;
+    int current_n;
+    int output_frames;              /* Frames from the previous centre to the current centre */
+    int output_index;
+    int save_overlap;               /* Right half of pcm has to be moved to overlap */
+
+    /* Memory: fast (SRAM) for the working vectors, table (SDRAM) for everything else */
+    uint8_t *fast_memory;
+    unsigned long fast_size, fast_used;
+    uint8_t *table_memory;
+    unsigned long table_size, table_used;
+    unsigned long table_mark;       /* End of the cached tables in table_memory */
+} VorbisContext;
+
+/* Ogg framing */
+void ogg_init(OggStream *s, ogg_read_function read, void *handle, uint8_t *packet_buffer);
+int ogg_read_packet(OggStream *s, uint8_t **packet, unsigned long *length);
+
+/* The context has to be zeroed before the first vorbis_init (static storage is) */
+int vorbis_init(VorbisContext *v, void *fast_memory, unsigned long fast_size,
+                void *table_memory, unsigned long table_size);
+int vorbis_decode_header(VorbisContext *v, const uint8_t *packet, unsigned long length);
+int vorbis_decode_packet(VorbisContext *v, const uint8_t *packet, unsigned long length) ICODE_ATTR_VORBIS;
+int vorbis_read_pcm(VorbisContext *v, uint16_t *destination, int frames) ICODE_ATTR_VORBIS;
+void vorbis_limit_pcm(VorbisContext *v, int frames);
+
+/* mdct.c */
+int vorbis_tables_init(VorbisTables *t, int n, int32_t *memory);
+void vorbis_imdct(VorbisTables *t, int32_t *buffer) ICODE_ATTR_VORBIS;
+
+#endif